@@ -0,0 +1,221 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "project/core/board.hpp"
+#include "project/core/boardPrinter.hpp"
+#include "project/core/boat.hpp"
+#include "project/core/fleetGenerator.hpp"
+#include "project/gameplay.hpp"
+
+namespace battleship::benchmarks
+{
+  namespace
+  {
+    constexpr std::uint32_t SEED = 42;
+
+    // The same legal standard fleet for every run, so timings are comparable across builds.
+    std::vector<FleetPlacement> fixedFleet()
+    {
+      std::mt19937 rng{ SEED };
+      const Board empty;
+      return generateRandomFleet(empty, rng);
+    }
+
+    std::vector<Coordinate> allCells()
+    {
+      std::vector<Coordinate> cells;
+      cells.reserve(static_cast<std::size_t>(BOARD_SIZE) * BOARD_SIZE);
+      for (int r = 0; r < BOARD_SIZE; ++r)
+      {
+        for (int c = 0; c < BOARD_SIZE; ++c)
+        {
+          cells.push_back(Coordinate{ r, c });
+        }
+      }
+      return cells;
+    }
+
+    std::vector<Coordinate> shuffledCells(std::mt19937& rng)
+    {
+      auto cells = allCells();
+      std::shuffle(cells.begin(), cells.end(), rng);
+      return cells;
+    }
+
+    void advance(Coordinate& c, Orientation o) noexcept
+    {
+      switch (o)
+      {
+        case Orientation::NORTH: --c.row; break;
+        case Orientation::SOUTH: ++c.row; break;
+        case Orientation::WEST: --c.col; break;
+        case Orientation::EAST: ++c.col; break;
+      }
+    }
+
+    void placeAll(Board& board, const std::vector<FleetPlacement>& fleet)
+    {
+      for (const auto& ship : fleet)
+      {
+        board.placeStructure(Boat{ ship.type }, ship.placement);
+      }
+    }
+  }  // namespace
+
+  // Board::reset() keeps the boats for a rematch, so every iteration places onto a fresh board.
+  void BM_Board_PlaceStructure(benchmark::State& state)
+  {
+    const auto fleet = fixedFleet();
+    std::optional<Board> board;
+    for (auto _ : state)
+    {
+      state.PauseTiming();
+      board.emplace();
+      state.ResumeTiming();
+      placeAll(*board, fleet);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(fleet.size()));
+  }
+  BENCHMARK(BM_Board_PlaceStructure);
+
+  // One iteration fires at every cell of a board holding the standard fleet.
+  void BM_Board_HandleShot(benchmark::State& state)
+  {
+    const auto fleet = fixedFleet();
+    const auto cells = allCells();
+    Board board;
+    placeAll(board, fleet);
+    for (auto _ : state)
+    {
+      for (const auto& cell : cells)
+      {
+        board.handle_shot(cell);
+      }
+      state.PauseTiming();
+      board.reset();
+      state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(cells.size()));
+  }
+  BENCHMARK(BM_Board_HandleShot);
+
+  // Worst case for the check: every boat is hit except for its last cell, so nothing short-circuits early.
+  void BM_Board_AllBoatsDestroyed(benchmark::State& state)
+  {
+    const auto fleet = fixedFleet();
+    Board board;
+    placeAll(board, fleet);
+    for (const auto& ship : fleet)
+    {
+      const Boat boat{ ship.type };
+      Coordinate c = ship.placement.coordinate;
+      for (std::size_t i = 0; i + 1 < boat.size(); ++i)
+      {
+        board.handle_shot(c);
+        advance(c, ship.placement.orientation);
+      }
+    }
+
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(board.allBoatsDestroyed());
+    }
+  }
+  BENCHMARK(BM_Board_AllBoatsDestroyed);
+
+  // Clears the shots of a third of the board and puts the fleet back, as between two rounds.
+  void BM_Board_Reset(benchmark::State& state)
+  {
+    const auto cells = allCells();
+    Board board;
+    placeAll(board, fixedFleet());
+    for (auto _ : state)
+    {
+      state.PauseTiming();
+      for (std::size_t i = 0; i < cells.size(); i += 3)
+      {
+        board.handle_shot(cells[i]);
+      }
+      state.ResumeTiming();
+      board.reset();
+    }
+  }
+  BENCHMARK(BM_Board_Reset);
+
+  // A whole game between two random fleets, each side firing in its own random order.
+  void BM_GamePlay_FullGame(benchmark::State& state)
+  {
+    std::mt19937 rng{ SEED };
+    std::optional<GamePlay> game;
+    std::int64_t shots = 0;
+    for (auto _ : state)
+    {
+      state.PauseTiming();
+      game.emplace();
+      game->placeRandomFleet(1, rng);
+      game->placeRandomFleet(2, rng);
+      const std::array<std::vector<Coordinate>, 2> orders{ shuffledCells(rng), shuffledCells(rng) };
+      state.ResumeTiming();
+
+      std::array<std::size_t, 2> next{};
+      while (!game->isGameOver())
+      {
+        const auto attacker = static_cast<std::size_t>(game->currentPlayerId() - 1);
+        benchmark::DoNotOptimize(game->shoot(orders[attacker][next[attacker]++]));
+        ++shots;
+      }
+    }
+    state.SetItemsProcessed(shots);
+    state.counters["shots_per_game"] =
+        benchmark::Counter(static_cast<double>(shots) / static_cast<double>(state.iterations()));
+  }
+  BENCHMARK(BM_GamePlay_FullGame);
+
+  void BM_Coordinate_ParseFromString(benchmark::State& state)
+  {
+    std::vector<std::string> inputs;
+    for (const auto& cell : allCells())
+    {
+      inputs.push_back(cell.toString());
+    }
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(Coordinate::parseFromString(inputs[i]));
+      i = i + 1 == inputs.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_Coordinate_ParseFromString);
+
+  void BM_PrintBoard(benchmark::State& state)
+  {
+    Board board;
+    placeAll(board, fixedFleet());
+    const auto cells = allCells();
+    for (std::size_t i = 0; i < cells.size(); i += 2)
+    {
+      board.handle_shot(cells[i]);
+    }
+
+    std::ostringstream out;
+    const BoardPrintOptions options{ .revealShips = state.range(0) != 0, .showLegend = true };
+    for (auto _ : state)
+    {
+      out.str(std::string{});
+      printBoard(out, board, options);
+      benchmark::DoNotOptimize(out.tellp());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(out.str().size()));
+  }
+  BENCHMARK(BM_PrintBoard)->ArgName("reveal")->Arg(0)->Arg(1);
+
+}  // namespace battleship::benchmarks
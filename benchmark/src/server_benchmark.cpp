@@ -0,0 +1,558 @@
+#include <benchmark/benchmark.h>
+
+#include <boost/beast/http.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "project/core/board.hpp"
+#include "project/core/coordinate.hpp"
+#include "server/game_store.hpp"
+#include "server/http_router.hpp"
+#include "server/matchmaker.hpp"
+#include "server/spectator_hub.hpp"
+
+// Counts the heap allocations of each thread, so every benchmark can report allocations per operation next to
+// its time. The counter is thread-local: a shared atomic would itself bounce between the cores of a
+// multi-threaded run and flatten the scaling curves being measured.
+namespace
+{
+  thread_local std::size_t t_allocations = 0;
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+  ++t_allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size))
+  {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace server::benchmarks
+{
+  namespace http = boost::beast::http;
+
+  using Request = http::request<http::string_body>;
+  using Response = http::response<http::string_body>;
+
+  namespace
+  {
+    constexpr int MAX_THREADS = 16;
+    constexpr std::size_t GAMES_PER_THREAD = 16;
+    constexpr std::size_t SHOTS_PER_GAME = 2 * static_cast<std::size_t>(battleship::BOARD_SIZE) * battleship::BOARD_SIZE;
+
+    constexpr const char* SHIP_BODY = R"({"type":"CARRIER","start":"A1","orientation":"E"})";
+    constexpr const char* FLEET_BODY = R"({"ships":[)"
+                                       R"({"type":"CARRIER","start":"A1","orientation":"E"},)"
+                                       R"({"type":"BATTLESHIP","start":"C1","orientation":"E"},)"
+                                       R"({"type":"CRUISER","start":"E1","orientation":"E"},)"
+                                       R"({"type":"SUBMARINE","start":"G1","orientation":"E"},)"
+                                       R"({"type":"DESTROYER","start":"I1","orientation":"E"}]})";
+
+    struct Game
+    {
+      std::string id;
+      std::array<std::string, 2> tokens;
+    };
+
+    // A game brought as far as `status`: InProgress means both random fleets placed and both players ready.
+    Game makeGame(GameStore& store, GameStatus status)
+    {
+      const auto created = store.createGame();
+      Game game{ created.gameId, { created.playerToken, "" } };
+      if (status == GameStatus::WaitingForPlayers)
+      {
+        return game;
+      }
+      game.tokens[1] = store.joinGame(game.id).playerToken;
+      if (status == GameStatus::Placing)
+      {
+        return game;
+      }
+      for (int p = 0; p < 2; ++p)
+      {
+        (void)store.placeRandomFleet(game.id, p);
+        (void)store.readyUp(game.id, p);
+      }
+      return game;
+    }
+
+    Request buildRequest(http::verb method,
+                         const std::string& target,
+                         const std::string& token = "",
+                         const std::string& body = "")
+    {
+      Request req{ method, target, 11 };
+      req.set(http::field::host, "localhost");
+      if (!token.empty())
+      {
+        req.set(http::field::authorization, "Bearer " + token);
+      }
+      req.keep_alive(true);
+      req.body() = body;
+      req.prepare_payload();
+      return req;
+    }
+
+    std::string shotBody(std::size_t cell)
+    {
+      const auto row = static_cast<int>(cell) / battleship::BOARD_SIZE;
+      const auto col = static_cast<int>(cell) % battleship::BOARD_SIZE;
+      return R"({"target":")" + battleship::Coordinate{ row, col }.toString() + R"("})";
+    }
+
+    // Both players' shots in turn order, each player sweeping the board row by row.
+    std::vector<Request> shotRequests(const Game& game)
+    {
+      std::vector<Request> shots;
+      shots.reserve(SHOTS_PER_GAME);
+      for (std::size_t i = 0; i < SHOTS_PER_GAME; ++i)
+      {
+        shots.push_back(buildRequest(http::verb::post, "/games/" + game.id + "/shoot", game.tokens[i % 2], shotBody(i / 2)));
+      }
+      return shots;
+    }
+
+    battleship::Coordinate shotTarget(std::size_t shot) noexcept
+    {
+      const auto cell = static_cast<int>(shot / 2);
+      return battleship::Coordinate{ cell / battleship::BOARD_SIZE, cell % battleship::BOARD_SIZE };
+    }
+
+    // Allocations made while the benchmark's timer runs, reported per iteration. Untimed setup inside the loop
+    // goes between pause() and resume() so that neither its time nor its allocations are counted.
+    class AllocationMeter
+    {
+    public:
+      void pause(benchmark::State& state)
+      {
+        m_counted += t_allocations - m_since;
+        state.PauseTiming();
+      }
+
+      void resume(benchmark::State& state)
+      {
+        state.ResumeTiming();
+        m_since = t_allocations;
+      }
+
+      void report(benchmark::State& state)
+      {
+        m_counted += t_allocations - m_since;
+        state.counters["allocs_per_op"] =
+            benchmark::Counter(static_cast<double>(m_counted), benchmark::Counter::kAvgIterations);
+      }
+
+    private:
+      std::size_t m_since{ t_allocations };
+      std::size_t m_counted{ 0 };
+    };
+
+    // One store for the multi-threaded runs, so their threads contend on the same lock. It only grows, which
+    // is what a long-running server's store does too.
+    GameStore& sharedStore()
+    {
+      static GameStore store;
+      return store;
+    }
+
+    // The same with the games spread over shards, as --game-shards does.
+    constexpr std::size_t BENCH_SHARDS = 64;
+
+    GameStore& shardedStore()
+    {
+      static GameStore store{ BENCH_SHARDS };
+      return store;
+    }
+
+    // Arg 1 runs on the single-lock store, anything else on the sharded one.
+    GameStore& storeFor(const benchmark::State& state)
+    {
+      return state.range(0) == 1 ? sharedStore() : shardedStore();
+    }
+
+    // Runs `req` through the router on one reused response, as a keep-alive connection does.
+    void runRoute(benchmark::State& state, GameStore& store, const Request& req, http::status expected)
+    {
+      Response res;
+      handle_request(store, req, res);  // sizes the body and creates the header fields
+
+      AllocationMeter meter;
+      for (auto _ : state)
+      {
+        handle_request(store, req, res);
+        benchmark::DoNotOptimize(res.body().data());
+      }
+      meter.report(state);
+
+      if (res.result() != expected)
+      {
+        state.SkipWithError("unexpected response status");
+      }
+    }
+
+    // For routes that use up the game they act on: `prepare` builds a fresh game and its request untimed.
+    template<typename Prepare>
+    void runRouteOnFreshGames(benchmark::State& state, http::status expected, Prepare&& prepare)
+    {
+      GameStore store;
+      Response res;
+      AllocationMeter meter;
+      for (auto _ : state)
+      {
+        meter.pause(state);
+        const Request req = prepare(store);
+        meter.resume(state);
+
+        handle_request(store, req, res);
+        if (res.result() != expected)
+        {
+          state.SkipWithError("unexpected response status");
+          break;
+        }
+      }
+      meter.report(state);
+    }
+  }  // namespace
+
+  // Single-threaded cost of each route through server::handle_request, without sockets.
+
+  void BM_Router_CreateGame(benchmark::State& state)
+  {
+    GameStore store;
+    runRoute(state, store, buildRequest(http::verb::post, "/games"), http::status::ok);
+  }
+  BENCHMARK(BM_Router_CreateGame);
+
+  void BM_Router_JoinGame(benchmark::State& state)
+  {
+    runRouteOnFreshGames(state,
+                         http::status::ok,
+                         [](GameStore& store)
+                         {
+                           const auto game = makeGame(store, GameStatus::WaitingForPlayers);
+                           return buildRequest(http::verb::post, "/games/" + game.id + "/join");
+                         });
+  }
+  BENCHMARK(BM_Router_JoinGame);
+
+  void BM_Router_GetGame(benchmark::State& state)
+  {
+    GameStore store;
+    const auto game = makeGame(store, GameStatus::InProgress);
+    runRoute(state, store, buildRequest(http::verb::get, "/games/" + game.id, game.tokens[0]), http::status::ok);
+  }
+  BENCHMARK(BM_Router_GetGame);
+
+  void BM_Router_PlaceShip(benchmark::State& state)
+  {
+    runRouteOnFreshGames(state,
+                         http::status::ok,
+                         [](GameStore& store)
+                         {
+                           const auto game = makeGame(store, GameStatus::Placing);
+                           return buildRequest(http::verb::post, "/games/" + game.id + "/place", game.tokens[0], SHIP_BODY);
+                         });
+  }
+  BENCHMARK(BM_Router_PlaceShip);
+
+  void BM_Router_PlaceFleet(benchmark::State& state)
+  {
+    runRouteOnFreshGames(state,
+                         http::status::ok,
+                         [](GameStore& store)
+                         {
+                           const auto game = makeGame(store, GameStatus::Placing);
+                           return buildRequest(http::verb::post, "/games/" + game.id + "/fleet", game.tokens[0], FLEET_BODY);
+                         });
+  }
+  BENCHMARK(BM_Router_PlaceFleet);
+
+  void BM_Router_PlaceRandomFleet(benchmark::State& state)
+  {
+    runRouteOnFreshGames(state,
+                         http::status::ok,
+                         [](GameStore& store)
+                         {
+                           const auto game = makeGame(store, GameStatus::Placing);
+                           return buildRequest(http::verb::post, "/games/" + game.id + "/fleet/random", game.tokens[0]);
+                         });
+  }
+  BENCHMARK(BM_Router_PlaceRandomFleet);
+
+  // Readying up again once the game is under way is accepted and changes nothing, so one game serves throughout.
+  void BM_Router_ReadyUp(benchmark::State& state)
+  {
+    GameStore store;
+    const auto game = makeGame(store, GameStatus::InProgress);
+    runRoute(state, store, buildRequest(http::verb::post, "/games/" + game.id + "/ready", game.tokens[0]), http::status::ok);
+  }
+  BENCHMARK(BM_Router_ReadyUp);
+
+  // Plays games to the end with prebuilt requests, starting the next game untimed whenever one finishes.
+  void BM_Router_Shoot(benchmark::State& state)
+  {
+    GameStore store;
+    Response res;
+    std::vector<Request> shots;
+    std::size_t next = SHOTS_PER_GAME;
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      if (next == SHOTS_PER_GAME)
+      {
+        meter.pause(state);
+        shots = shotRequests(makeGame(store, GameStatus::InProgress));
+        next = 0;
+        meter.resume(state);
+      }
+
+      handle_request(store, shots[next++], res);
+      if (res.result() != http::status::ok)
+      {
+        state.SkipWithError("unexpected response status");
+        break;
+      }
+      if (res.body().find("\"finished\"") != std::string::npos)
+      {
+        next = SHOTS_PER_GAME;
+      }
+    }
+    meter.report(state);
+  }
+  BENCHMARK(BM_Router_Shoot);
+
+  // The history of a game `range(0)` shots in, replayed up to its latest move.
+  void BM_Router_GetHistory(benchmark::State& state)
+  {
+    GameStore store;
+    const auto game = makeGame(store, GameStatus::InProgress);
+    const auto played = static_cast<std::size_t>(state.range(0));
+    for (std::size_t i = 0; i < played; ++i)
+    {
+      (void)store.tryShoot(game.id, static_cast<int>(i % 2), shotTarget(i));
+    }
+    runRoute(state, store, buildRequest(http::verb::get, "/games/" + game.id + "/history", game.tokens[0]), http::status::ok);
+  }
+  BENCHMARK(BM_Router_GetHistory)->Arg(0)->Arg(20)->Arg(80);
+
+  void BM_Router_Metrics(benchmark::State& state)
+  {
+    GameStore store;
+    (void)makeGame(store, GameStatus::InProgress);
+    runRoute(state, store, buildRequest(http::verb::get, "/metrics"), http::status::ok);
+  }
+  BENCHMARK(BM_Router_Metrics);
+
+  void BM_Router_Unauthorized(benchmark::State& state)
+  {
+    GameStore store;
+    const auto game = makeGame(store, GameStatus::InProgress);
+    runRoute(state, store, buildRequest(http::verb::get, "/games/" + game.id, "not-a-token"), http::status::unauthorized);
+  }
+  BENCHMARK(BM_Router_Unauthorized);
+
+  void BM_Router_NotFound(benchmark::State& state)
+  {
+    GameStore store;
+    runRoute(state, store, buildRequest(http::verb::get, "/nowhere"), http::status::not_found);
+  }
+  BENCHMARK(BM_Router_NotFound);
+
+  // Scaling of the store under 1..MAX_THREADS threads, each working its own GAMES_PER_THREAD games of one shared
+  // store. Items per second is the aggregate throughput; a flat or falling curve means the store lock dominates.
+  // Finished games are replaced untimed.
+
+  // Round-robin shots over the thread's games.
+  void BM_Store_Shoot(benchmark::State& state)
+  {
+    auto& store = storeFor(state);
+    std::vector<Game> games;
+    std::vector<std::size_t> next(GAMES_PER_THREAD, 0);
+    for (std::size_t g = 0; g < GAMES_PER_THREAD; ++g)
+    {
+      games.push_back(makeGame(store, GameStatus::InProgress));
+    }
+
+    std::size_t g = 0;
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      auto& shot = next[g];
+      const auto outcome = store.tryShoot(games[g].id, static_cast<int>(shot % 2), shotTarget(shot));
+      if (!outcome || outcome->status == GameStatus::Finished || ++shot == SHOTS_PER_GAME)
+      {
+        meter.pause(state);
+        games[g] = makeGame(store, GameStatus::InProgress);
+        shot = 0;
+        meter.resume(state);
+      }
+      g = (g + 1) % GAMES_PER_THREAD;
+    }
+    meter.report(state);
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_Store_Shoot)->ArgName("shards")->Arg(1)->Arg(BENCH_SHARDS)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+  // Reads only, yet every call still takes its shard's lock: the one store lock with a single shard.
+  void BM_Store_GetGameView(benchmark::State& state)
+  {
+    auto& store = storeFor(state);
+    std::vector<Game> games;
+    for (std::size_t g = 0; g < GAMES_PER_THREAD; ++g)
+    {
+      games.push_back(makeGame(store, GameStatus::InProgress));
+    }
+
+    std::size_t g = 0;
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(store.getGameView(games[g].id));
+      g = (g + 1) % GAMES_PER_THREAD;
+    }
+    meter.report(state);
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_Store_GetGameView)->ArgName("shards")->Arg(1)->Arg(BENCH_SHARDS)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+  // Client-shaped traffic through the router: three polls of the game per shot, on one reused response per thread.
+  void BM_Router_PollAndShoot(benchmark::State& state)
+  {
+    auto& store = storeFor(state);
+    Game game = makeGame(store, GameStatus::InProgress);
+    std::vector<Request> shots = shotRequests(game);
+    Request poll = buildRequest(http::verb::get, "/games/" + game.id, game.tokens[0]);
+    std::size_t next = 0;
+    std::size_t round = 0;
+    Response res;
+
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      if (++round % 4 != 0)
+      {
+        handle_request(store, poll, res);
+        continue;
+      }
+      handle_request(store, shots[next++], res);
+      if (res.body().find("\"finished\"") != std::string::npos || next == SHOTS_PER_GAME)
+      {
+        meter.pause(state);
+        game = makeGame(store, GameStatus::InProgress);
+        shots = shotRequests(game);
+        poll = buildRequest(http::verb::get, "/games/" + game.id, game.tokens[0]);
+        next = 0;
+        meter.resume(state);
+      }
+    }
+    meter.report(state);
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_Router_PollAndShoot)->ArgName("shards")->Arg(1)->Arg(BENCH_SHARDS)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+  // One lobby page out of state.range(0) waiting games and as many in play: the cost follows the page size,
+  // not the number of games.
+  void BM_Store_ListGames(benchmark::State& state)
+  {
+    GameStore store;
+    const auto games = static_cast<std::size_t>(state.range(0));
+    for (std::size_t i = 0; i < games; ++i)
+    {
+      (void)store.createGame();
+      (void)store.joinGame(store.createGame().gameId);
+    }
+
+    std::uint64_t cursor = 0;
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      const auto page = store.listGames(GameStatus::WaitingForPlayers, 20, cursor);
+      cursor = page.nextCursor;
+      benchmark::DoNotOptimize(page);
+    }
+    meter.report(state);
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_Store_ListGames)->ArgName("games")->Arg(1000)->Arg(100000);
+
+  // Two players queued, paired into a new game and their seats collected, per iteration. Each thread queues in
+  // its own bucket, so its two players always meet each other; the threads share the queues' ends and the one
+  // pairing thread.
+  void BM_Matchmaker_Pair(benchmark::State& state)
+  {
+    static Matchmaker matchmaker{ shardedStore() };
+    const auto bucket = static_cast<std::size_t>(state.thread_index()) % Matchmaker::BUCKETS;
+
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      for (const auto& ticket : { matchmaker.enqueue(bucket), matchmaker.enqueue(bucket) })
+      {
+        while (ticket.has_value())
+        {
+          const auto status = matchmaker.poll(*ticket);
+          if (!status.has_value() || status->matched)
+          {
+            break;
+          }
+          std::this_thread::yield();
+        }
+      }
+    }
+    meter.report(state);
+    state.SetItemsProcessed(2 * state.iterations());
+  }
+  BENCHMARK(BM_Matchmaker_Pair)->ThreadRange(1, static_cast<int>(Matchmaker::BUCKETS))->UseRealTime();
+
+  // One game update serialized and handed to state.range(0) spectators. The frame is built once per update
+  // whatever the audience, so the per-viewer cost is a pointer copy.
+  void BM_Spectator_Publish(benchmark::State& state)
+  {
+    struct Viewer : SpectatorViewer
+    {
+      SpectatorFrame last;
+      void deliver(const SpectatorFrame& frame, std::uint64_t) override { last = frame; }
+    };
+
+    GameStore store;
+    const auto gameId = store.createGame().gameId;
+    SpectatorHub hub{ SpectatorPolicy::Revealed };
+    std::vector<std::shared_ptr<Viewer>> viewers;
+    for (std::int64_t i = 0; i < state.range(0); ++i)
+    {
+      viewers.push_back(std::make_shared<Viewer>());
+      (void)hub.subscribe(gameId, viewers.back());
+    }
+    (void)publish_spectator_frame(store, hub, gameId);
+    const std::string serialized = *viewers.front()->last;
+
+    std::uint64_t revision = 1;
+    AllocationMeter meter;
+    for (auto _ : state)
+    {
+      hub.publish(gameId, ++revision, std::make_shared<const std::string>(serialized));
+    }
+    meter.report(state);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_Spectator_Publish)->ArgName("viewers")->Arg(1)->Arg(100)->Arg(10000);
+
+}  // namespace server::benchmarks
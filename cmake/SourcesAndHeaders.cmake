@@ -1,11 +1,34 @@
 set(sources
         src/core/boat.cpp
         src/core/board.cpp
+        src/core/fleetGenerator.cpp
+        src/core/replay.cpp
         src/gameplay.cpp
         src/player/player.cpp
+        src/server/admission.cpp
+        src/server/binary_codec.cpp
+        src/server/buffer_pool.cpp
+        src/server/cluster.cpp
+        src/server/cluster_proxy.cpp
+        src/server/event_log.cpp
+        src/server/game_record.cpp
+        src/server/game_recorder.cpp
         src/server/game_store.cpp
         src/server/http_router.cpp
         src/server/http_server.cpp
+        src/server/json_writer.cpp
+        src/server/mapped_file.cpp
+        src/server/matchmaker.cpp
+        src/server/metrics.cpp
+        src/server/profiled_mutex.cpp
+        src/server/rate_limiter.cpp
+        src/server/request_trace.cpp
+        src/server/replay_db.cpp
+        src/server/route_table.cpp
+        src/server/server_config.cpp
+        src/server/snapshot.cpp
+        src/server/spectator_hub.cpp
+        src/server/uring_server.cpp
 )
 
 set(exe_sources
@@ -16,6 +39,7 @@ set(exe_sources
 set(headers
         include/project/core/boat.hpp
         include/project/core/board.hpp
+        include/project/core/fleetGenerator.hpp
         include/project/core/coordinate.hpp
         include/project/core/placement.hpp
         include/project/core/structure.hpp
@@ -24,14 +48,56 @@ set(headers
         include/project/player/player.hpp
         include/project/exceptions/exceptions.hpp
         include/project/core/cell.hpp
+        include/project/core/replay.hpp
+        include/project/core/result.hpp
+        include/server/admission.hpp
+        include/server/binary_codec.hpp
+        include/server/buffer_pool.hpp
+        include/server/cluster.hpp
+        include/server/cluster_proxy.hpp
+        include/server/event_log.hpp
+        include/server/game_record.hpp
+        include/server/game_recorder.hpp
         include/server/game_store.hpp
         include/server/game_types.hpp
         include/server/http_router.hpp
         include/server/http_server.hpp
+        include/server/json_writer.hpp
+        include/server/mapped_file.hpp
+        include/server/matchmaker.hpp
+        include/server/metrics.hpp
+        include/server/mpmc_queue.hpp
+        include/server/profiled_mutex.hpp
+        include/server/rate_limiter.hpp
+        include/server/request_trace.hpp
+        include/server/replay_db.hpp
+        include/server/route_table.hpp
+        include/server/server_config.hpp
+        include/server/snapshot.hpp
+        include/server/spectator_hub.hpp
+        include/server/uring_server.hpp
 )
 
 set(test_sources
         src/board_test.cpp
         src/gameplay_test.cpp
         server/test_server.cpp
+        server/test_allocations.cpp
+)
+
+set(benchmark_sources
+        src/engine_benchmark.cpp
+        src/server_benchmark.cpp
+)
+
+set(loadgen_sources
+        src/loadgen.cpp
+)
+
+set(router_sources
+        src/router.cpp
+)
+
+set(server_sources
+        src/server.cpp
 )
@@ -12,6 +12,18 @@ option(${PROJECT_NAME}_USE_ALT_NAMES "Use alternative names for the project, suc
 
 option(${PROJECT_NAME}_WARNINGS_AS_ERRORS "Treat compiler warnings as errors." OFF)
 
+#
+# Instrumentation
+#
+
+option(${PROJECT_NAME}_ENABLE_LOCK_PROFILING "Record wait and hold times of the GameStore lock per operation." OFF)
+
+#
+# Server backends
+#
+
+option(${PROJECT_NAME}_ENABLE_IO_URING "Compile in the io_uring server backend (Linux 5.6 or newer; selected at runtime with --io-uring)." OFF)
+
 #
 # Package managers
 #
@@ -32,6 +44,19 @@ option(${PROJECT_NAME}_USE_GOOGLE_MOCK "Use the GoogleMock project for extending
 
 option(${PROJECT_NAME}_USE_CATCH2 "Use the Catch2 project for creating unit tests." OFF)
 
+#
+# Benchmarks
+#
+# Currently supporting: Google Benchmark.
+
+option(${PROJECT_NAME}_ENABLE_BENCHMARKS "Build the Google Benchmark suite (from the `benchmark` subfolder)." OFF)
+
+#
+# Tools
+#
+
+option(${PROJECT_NAME}_BUILD_TOOLS "Build the command-line tools (from the `tools` subfolder), such as battleship_server and battleship_loadgen." ON)
+
 #
 # Static analyzers
 #
@@ -19,6 +19,7 @@
 #include "coordinate.hpp"
 #include "placement.hpp"
 #include "cell.hpp"
+#include "result.hpp"
 
 namespace battleship
 {
@@ -38,6 +39,15 @@ namespace battleship
     return cells;
   }
 
+  /**
+   * @brief A boat type together with where it should be placed.
+   */
+  struct FleetPlacement
+  {
+    BoatType type;
+    Placement placement;
+  };
+
   class Board
   {
   public:
@@ -55,8 +65,34 @@ namespace battleship
     void setCellView(const Coordinate& coord, Cell cell_view);
 
     void placeStructure(const Structure& structure, const Placement& placement);
+
+    /**
+     * @brief Places all boats of a fleet, or none of them.
+     *
+     * Every boat is validated with the same rules as placeStructure(). If any
+     * boat is out of bounds or collides, the board is restored to the state it
+     * had before the call and the original exception is rethrown.
+     */
+    void placeFleet(const std::vector<FleetPlacement>& fleet);
     void handle_shot(const Coordinate& coord);
+
+    /**
+     * @name Non-throwing variants
+     * Report ordinary rejections (out of bounds, collision, already shot) as a
+     * BoardError instead of an exception. A rejected call leaves the board
+     * unchanged. Anything else still throws: placing allocates, and a shot
+     * runs the hit structure's hit().
+     */
+    ///@{
+    [[nodiscard]] BoardError tryPlaceStructure(const Structure& structure, const Placement& placement);
+    [[nodiscard]] BoardError tryPlaceFleet(const std::vector<FleetPlacement>& fleet);
+    /// @return the new state of the target cell (HIT or MISS).
+    [[nodiscard]] Expected<CellState, BoardError> tryHandleShot(const Coordinate& coord);
+    ///@}
     [[nodiscard]] bool allBoatsDestroyed() const;
+    [[nodiscard]] std::size_t structureCount() const noexcept;
+    /// Boats on the board with the placement they were given, in placement order.
+    [[nodiscard]] std::vector<FleetPlacement> placedBoats() const;
 
     void reset();
 
@@ -67,9 +103,9 @@ namespace battleship
 
     void markStructureOnBoard(const Structure& structure, const Placement& placement) noexcept;
     void addStructureStartPosition(const Structure& structure, const Placement& placement);
-    bool checkCollision(const Structure& structure, const Placement& placement);
-    Structure& findStructureAt(const Coordinate& coord);
-    Cell& cellAt(int row, int col);
+    bool checkCollision(const Structure& structure, const Placement& placement) noexcept;
+    Structure* findStructureAt(const Coordinate& coord) noexcept;
+    Cell* cellAt(int row, int col) noexcept;
   };
 
 }
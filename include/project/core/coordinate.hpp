@@ -9,9 +9,13 @@
  * positions on the Battleship board.
  */
 
+#include <cctype>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+
+#include "result.hpp"
 
 namespace battleship
 {
@@ -39,7 +43,11 @@ namespace battleship
     {
     }
 
-    static Coordinate parseFromString(std::string_view s)
+    /**
+     * @brief Parses "A1".."J10" without throwing.
+     * @return the coordinate, or a static description of what is wrong with the input.
+     */
+    static Expected<Coordinate, const char*> tryParse(std::string_view s) noexcept
     {
       // trim spaces (optional but nice for user input)
       while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front())))
@@ -53,7 +61,7 @@ namespace battleship
 
       if (s.size() < 2 || s.size() > 3)
       {
-        throw std::invalid_argument("Invalid coordinate string");
+        return unexpected("Invalid coordinate string");
       }
 
       char rch = s[0];
@@ -61,7 +69,7 @@ namespace battleship
 
       if (rch < 'A' || rch > 'J')
       {
-        throw std::invalid_argument("Invalid row character");
+        return unexpected("Invalid row character");
       }
 
       const int row = rch - 'A';
@@ -72,7 +80,7 @@ namespace battleship
         const char c1 = s[1];
         if (c1 < '1' || c1 > '9')
         {
-          throw std::invalid_argument("Invalid column character");
+          return unexpected("Invalid column character");
         }
 
         col = (c1 - '0') - 1;  // '1'->0 ... '9'->8
@@ -81,7 +89,7 @@ namespace battleship
       {
         if (!(s[1] == '1' && s[2] == '0'))
         {
-          throw std::invalid_argument("Invalid column character");
+          return unexpected("Invalid column character");
         }
 
         col = 9;
@@ -89,6 +97,27 @@ namespace battleship
 
       return Coordinate{ row, col };
     }
+
+    static Coordinate parseFromString(std::string_view s)
+    {
+      auto parsed = tryParse(s);
+      if (!parsed)
+      {
+        throw std::invalid_argument(parsed.error());
+      }
+      return *parsed;
+    }
+
+    /**
+     * @brief Formats the coordinate the way parseFromString() reads it (e.g. "B7").
+     */
+    [[nodiscard]] std::string toString() const
+    {
+      std::string out;
+      out.push_back(static_cast<char>('A' + row));
+      out += std::to_string(col + 1);
+      return out;
+    }
   };
 }  // namespace battleship
 
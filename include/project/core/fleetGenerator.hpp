@@ -0,0 +1,48 @@
+#ifndef PROJECT_CORE_FLEET_GENERATOR_HPP
+#define PROJECT_CORE_FLEET_GENERATOR_HPP
+
+/**
+ * @file fleetGenerator.hpp
+ * @brief Random legal fleet placement.
+ *
+ * Placements are drawn from a mask of cells that are still free (not occupied
+ * and not adjacent to an occupied cell), so no candidate ever has to be tried
+ * against Board::placeStructure and rejected through an exception.
+ */
+
+#include <array>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "board.hpp"
+#include "boat.hpp"
+
+namespace battleship
+{
+  /**
+   * @brief The classic five-boat fleet.
+   */
+  constexpr std::array<BoatType, 5> STANDARD_FLEET{
+    BoatType::CARRIER, BoatType::BATTLESHIP, BoatType::CRUISER, BoatType::SUBMARINE, BoatType::DESTROYER,
+  };
+
+  /**
+   * @brief Generates a random legal placement for @p fleet on top of @p board.
+   *
+   * Structures already on the board are respected. The board itself is not
+   * modified; pass the result to Board::placeFleet() to apply it.
+   *
+   * @throws std::runtime_error if the fleet does not fit on the board.
+   */
+  [[nodiscard]] std::vector<FleetPlacement> generateRandomFleet(const Board& board,
+                                                                std::span<const BoatType> fleet,
+                                                                std::mt19937& rng);
+
+  [[nodiscard]] inline std::vector<FleetPlacement> generateRandomFleet(const Board& board, std::mt19937& rng)
+  {
+    return generateRandomFleet(board, STANDARD_FLEET, rng);
+  }
+}  // namespace battleship
+
+#endif  // PROJECT_CORE_FLEET_GENERATOR_HPP
@@ -0,0 +1,87 @@
+#ifndef PROJECT_CORE_REPLAY_HPP
+#define PROJECT_CORE_REPLAY_HPP
+
+/**
+ * @file replay.hpp
+ * @brief Step-through reconstruction of a game from its move log.
+ *
+ * A position is just the two cell grids: a shot at an occupied cell becomes a
+ * hit, anything else a miss, and a board is cleared once no occupied cell is
+ * left. Seeking starts from the nearest checkpoint at or before the target
+ * move instead of from the initial placement; checkpoints are recorded every
+ * checkpoint interval while moves are simulated, so they are only paid for
+ * up to the furthest position requested.
+ */
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "board.hpp"
+
+namespace battleship
+{
+  using BoardCells = std::array<std::array<CellState, BOARD_SIZE>, BOARD_SIZE>;
+
+  /**
+   * @brief One shot of the log: @p player (0 or 1) fires at the opponent's board.
+   */
+  struct ReplayMove
+  {
+    int player;
+    Coordinate target;
+  };
+
+  /**
+   * @brief State of both boards after the first @p move moves.
+   */
+  struct ReplayPosition
+  {
+    std::size_t move{ 0 };
+    std::array<BoardCells, 2> boards{};
+    /// 0 or 1 once that player's opponent has no ship left, -1 otherwise.
+    int winner{ -1 };
+  };
+
+  class Replay
+  {
+  public:
+    static constexpr std::size_t DEFAULT_CHECKPOINT_INTERVAL = 16;
+
+    /**
+     * @throws Collision, OutOfBounds or std::invalid_argument if a fleet is not a legal placement.
+     */
+    Replay(const std::array<std::vector<FleetPlacement>, 2>& fleets,
+           std::vector<ReplayMove> moves,
+           std::size_t checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL);
+
+    [[nodiscard]] std::size_t moveCount() const noexcept;
+
+    /**
+     * @brief Position after the first @p move moves (0 is the initial placement).
+     * @throws std::out_of_range if @p move is past the end of the log.
+     */
+    [[nodiscard]] ReplayPosition positionAt(std::size_t move);
+
+    /**
+     * @brief HIT or MISS for move @p index (0-based); MISS also covers shots the engine would reject.
+     * @throws std::out_of_range if @p index is not a move of the log.
+     */
+    [[nodiscard]] CellState resultOf(std::size_t index);
+
+    [[nodiscard]] std::size_t checkpointCount() const noexcept;
+
+  private:
+    static CellState apply(ReplayPosition& position, const ReplayMove& move) noexcept;
+    void extendCheckpoints(std::size_t move);
+
+    std::vector<ReplayMove> m_moves;
+    std::size_t m_interval;
+    /// m_checkpoints[k] is the position after k * m_interval moves.
+    std::vector<ReplayPosition> m_checkpoints;
+    /// Filled as moves are simulated, alongside the checkpoints.
+    std::vector<CellState> m_results;
+  };
+}  // namespace battleship
+
+#endif  // PROJECT_CORE_REPLAY_HPP
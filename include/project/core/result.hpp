@@ -0,0 +1,142 @@
+#ifndef PROJECT_CORE_RESULT_HPP
+#define PROJECT_CORE_RESULT_HPP
+
+/**
+ * @file result.hpp
+ * @brief Exception-free result types for the board hot path.
+ *
+ * Ordinary outcomes such as shooting the same cell twice are reported as a
+ * compact error code instead of an exception. The throwing Board API is a thin
+ * wrapper over these calls.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace battleship
+{
+  /**
+   * @brief Reasons a board operation can be rejected.
+   */
+  enum class BoardError : std::uint8_t
+  {
+    None,
+    OutOfBounds,
+    CoordinateOutOfBounds,
+    Collision,
+    AlreadyShot,
+    UndefinedShot,
+    InvalidOrientation
+  };
+
+  /**
+   * @brief Same wording as the matching exception messages.
+   */
+  constexpr const char* to_cstr(BoardError e) noexcept
+  {
+    switch (e)
+    {
+      case BoardError::None: return "OK";
+      case BoardError::OutOfBounds: return "Structure placement is out of board bounds.";
+      case BoardError::CoordinateOutOfBounds: return "Coordinate is out of board bounds.";
+      case BoardError::Collision: return "Structure placement collides with existing structures.";
+      case BoardError::AlreadyShot: return "Cell has already been shot.";
+      case BoardError::UndefinedShot: return "Shot in occupied cell does not correspond to any structure.";
+      case BoardError::InvalidOrientation: return "Invalid orientation.";
+    }
+    return "Unknown error.";
+  }
+
+  template<typename E>
+  struct Unexpected
+  {
+    E error;
+  };
+
+  template<typename E>
+  constexpr Unexpected<E> unexpected(E error) noexcept
+  {
+    return Unexpected<E>{ error };
+  }
+
+  /**
+   * @brief Minimal std::expected stand-in: either a value or an error code.
+   */
+  template<typename T, typename E>
+  class Expected
+  {
+  public:
+    constexpr Expected(T value) noexcept(std::is_nothrow_move_constructible_v<T>)  // NOLINT(google-explicit-constructor)
+        : m_storage(std::in_place_index<0>, std::move(value))
+    {
+    }
+
+    constexpr Expected(Unexpected<E> error) noexcept  // NOLINT(google-explicit-constructor)
+        : m_storage(std::in_place_index<1>, error.error)
+    {
+    }
+
+    [[nodiscard]] constexpr bool has_value() const noexcept
+    {
+      return m_storage.index() == 0;
+    }
+
+    constexpr explicit operator bool() const noexcept
+    {
+      return has_value();
+    }
+
+    [[nodiscard]] constexpr T& value() & noexcept
+    {
+      assert(has_value());
+      return *std::get_if<0>(&m_storage);
+    }
+
+    [[nodiscard]] constexpr const T& value() const& noexcept
+    {
+      assert(has_value());
+      return *std::get_if<0>(&m_storage);
+    }
+
+    [[nodiscard]] constexpr T&& value() && noexcept
+    {
+      assert(has_value());
+      return std::move(*std::get_if<0>(&m_storage));
+    }
+
+    [[nodiscard]] constexpr E error() const noexcept
+    {
+      assert(!has_value());
+      return *std::get_if<1>(&m_storage);
+    }
+
+    constexpr T* operator->() noexcept
+    {
+      return &value();
+    }
+
+    constexpr const T* operator->() const noexcept
+    {
+      return &value();
+    }
+
+    constexpr T& operator*() & noexcept
+    {
+      return value();
+    }
+
+    constexpr const T& operator*() const& noexcept
+    {
+      return value();
+    }
+
+  private:
+    std::variant<T, E> m_storage;
+  };
+
+}  // namespace battleship
+
+#endif  // PROJECT_CORE_RESULT_HPP
@@ -3,6 +3,8 @@
 
 #include <array>
 #include <cstddef>
+#include <random>
+#include <vector>
 
 #include "project/player/player.hpp"
 
@@ -43,6 +45,7 @@ namespace battleship
 
     void placeBoat(int player_id, BoatType type, const Placement& placement);
     void placeBoatForCurrentPlayer(BoatType type, const Placement& placement);
+    std::vector<FleetPlacement> placeRandomFleet(int player_id, std::mt19937& rng);
 
     [[nodiscard]] CellState shoot(const Coordinate& target);
     [[nodiscard]] CellState shoot(int attacker_id, const Coordinate& target);
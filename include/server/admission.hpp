@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "server/rate_limiter.hpp"
+#include "server/route_table.hpp"
+
+namespace server
+{
+  // Shedding order under overload: polls go first, then game setup, and moves last, so the requests that
+  // advance a game keep their latency when everything else is being turned away.
+  enum class RequestPriority : std::uint8_t
+  {
+    Poll,   // GET /games, GET /games/{id}, GET /games/{id}/history, GET /matchmaking/{ticket}
+    Setup,  // create, join, placement, ready, and everything else
+    Move    // POST /games/{id}/shoot
+  };
+
+  RequestPriority priorityOf(RouteId route) noexcept;
+
+  enum class Admission : std::uint8_t
+  {
+    Admitted,
+    Overloaded,      // the process is over the limit for this priority: 503
+    TooManyForToken,  // the client's token already has its share of requests in flight: 429
+    RateLimited       // the client's address or token is over its request rate: 429
+  };
+
+  class AdmissionControl;
+
+  // One request's place in the in-flight counts, held from its first bytes until its response is written.
+  // Releasing it (reset() or destruction) gives the place back.
+  class AdmissionTicket
+  {
+  public:
+    AdmissionTicket() = default;
+    ~AdmissionTicket() { reset(); }
+
+    AdmissionTicket(AdmissionTicket&& other) noexcept;
+    AdmissionTicket& operator=(AdmissionTicket&& other) noexcept;
+
+    AdmissionTicket(const AdmissionTicket&) = delete;
+    AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+
+    // Checks the request against the rate limits of its client address and token, then the process and
+    // per-token in-flight limits, once its route is known. `token` is the Authorization header, empty when
+    // there is none. Rejected tickets still count until reset().
+    Admission admit(RequestPriority priority, std::string_view token) noexcept;
+
+    void reset() noexcept;
+
+    explicit operator bool() const noexcept { return m_control != nullptr; }
+
+  private:
+    friend class AdmissionControl;
+
+    AdmissionTicket(AdmissionControl& control, std::uint64_t client) noexcept
+        : m_control(&control),
+          m_client(client)
+    {
+    }
+
+  private:
+    AdmissionControl* m_control{ nullptr };
+    std::uint64_t m_client{ 0 };
+    std::atomic<std::uint32_t>* m_tokenSlot{ nullptr };
+  };
+
+  // Bounds the requests a server has in flight, counted from the first bytes of a request until its response
+  // has been written, so requests queued behind a busy event loop count too. A request over the limit for its
+  // priority is answered straight away, before its body is parsed or the store is touched.
+  //
+  // Rate limits are checked first, so a client over its rate costs a hash and a compare-and-swap.
+  //
+  // Per-token counts live in a fixed table of atomic counters indexed by a hash of the Authorization header:
+  // no lock and no allocation per client. Tokens that share a slot share its limit, which only ever makes the
+  // check stricter.
+  class AdmissionControl
+  {
+  public:
+    static constexpr std::size_t TOKEN_SLOTS = 4096;
+
+    // 0 disables the respective limit.
+    explicit AdmissionControl(std::size_t maxInFlight = 0,
+                              std::size_t maxInFlightPerToken = 0,
+                              RateLimit perToken = {},
+                              RateLimit perClient = {});
+
+    // `client` is RateLimiter::keyFor() of the peer address, or 0 when it is unknown.
+    AdmissionTicket enter(std::uint64_t client = 0) noexcept;
+
+    // Requests at this priority are admitted while at most this many are in flight, themselves included.
+    std::size_t limitFor(RequestPriority priority) const noexcept;
+
+    std::size_t inFlight() const noexcept { return m_inFlight.load(std::memory_order_relaxed); }
+
+  private:
+    friend class AdmissionTicket;
+
+    void leave() noexcept { m_inFlight.fetch_sub(1, std::memory_order_relaxed); }
+    std::atomic<std::uint32_t>& tokenSlot(std::string_view token) noexcept;
+
+  private:
+    const std::size_t m_maxInFlight;
+    const std::size_t m_maxInFlightPerToken;
+    std::atomic<std::size_t> m_inFlight{ 0 };
+    std::array<std::atomic<std::uint32_t>, TOKEN_SLOTS> m_tokens{};
+    RateLimiter m_tokenRate;
+    RateLimiter m_clientRate;
+  };
+
+}  // namespace server
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace server::codec
+{
+  // Little-endian helpers shared by the on-disk formats (event log, snapshots).
+
+  std::uint32_t crc32(const char* data, std::size_t n) noexcept;
+
+  constexpr std::uint64_t fnv1a64(std::string_view bytes) noexcept
+  {
+    std::uint64_t h = 14695981039346656037ULL;
+    for (const char c : bytes)
+    {
+      h ^= static_cast<std::uint8_t>(c);
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  inline void putU8(std::string& out, std::uint8_t v)
+  {
+    out.push_back(static_cast<char>(v));
+  }
+
+  inline void putU32(std::string& out, std::uint32_t v)
+  {
+    for (int i = 0; i < 4; ++i)
+    {
+      out.push_back(static_cast<char>((v >> (8 * i)) & 0xFFU));
+    }
+  }
+
+  inline void putU64(std::string& out, std::uint64_t v)
+  {
+    for (int i = 0; i < 8; ++i)
+    {
+      out.push_back(static_cast<char>((v >> (8 * i)) & 0xFFU));
+    }
+  }
+
+  // Short strings (ids, tokens) with a one-byte length; longer input is cut at 255 bytes.
+  inline void putString(std::string& out, std::string_view s)
+  {
+    const std::size_t n = s.size() < 255 ? s.size() : 255;
+    putU8(out, static_cast<std::uint8_t>(n));
+    out.append(s.data(), n);
+  }
+
+  // Bounds-checked reader; every getter returns false instead of reading past the end.
+  class Reader
+  {
+  public:
+    Reader(const char* data, std::size_t size) noexcept : m_data(data), m_size(size) {}
+
+    bool u8(std::uint8_t& v) noexcept
+    {
+      if (remaining() < 1)
+      {
+        return false;
+      }
+      v = static_cast<std::uint8_t>(m_data[m_pos++]);
+      return true;
+    }
+
+    bool u32(std::uint32_t& v) noexcept
+    {
+      if (remaining() < 4)
+      {
+        return false;
+      }
+      v = 0;
+      for (int i = 0; i < 4; ++i)
+      {
+        v |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(m_data[m_pos++])) << (8 * i);
+      }
+      return true;
+    }
+
+    bool u64(std::uint64_t& v) noexcept
+    {
+      if (remaining() < 8)
+      {
+        return false;
+      }
+      v = 0;
+      for (int i = 0; i < 8; ++i)
+      {
+        v |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(m_data[m_pos++])) << (8 * i);
+      }
+      return true;
+    }
+
+    bool string(std::string& s)
+    {
+      std::uint8_t n = 0;
+      if (!u8(n) || remaining() < n)
+      {
+        return false;
+      }
+      s.assign(m_data + m_pos, n);
+      m_pos += n;
+      return true;
+    }
+
+    bool bytes(char* out, std::size_t n) noexcept
+    {
+      if (remaining() < n)
+      {
+        return false;
+      }
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        out[i] = m_data[m_pos++];
+      }
+      return true;
+    }
+
+    bool skip(std::size_t n) noexcept
+    {
+      if (remaining() < n)
+      {
+        return false;
+      }
+      m_pos += n;
+      return true;
+    }
+
+    std::size_t position() const noexcept { return m_pos; }
+    std::size_t remaining() const noexcept { return m_size - m_pos; }
+    bool done() const noexcept { return m_pos == m_size; }
+
+  private:
+    const char* m_data;
+    std::size_t m_size;
+    std::size_t m_pos{ 0 };
+  };
+
+}  // namespace server::codec
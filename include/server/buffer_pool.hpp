@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace server
+{
+  // Keeps warmed-up body strings between connections so a new session starts with buffers that already have
+  // capacity instead of growing fresh ones on its first few requests.
+  class BufferPool
+  {
+  public:
+    static constexpr std::size_t DEFAULT_MAX_BUFFERS = 256;
+    static constexpr std::size_t DEFAULT_MAX_CAPACITY = 64 * 1024;
+    static constexpr std::size_t INITIAL_CAPACITY = 4 * 1024;
+
+    explicit BufferPool(std::size_t maxBuffers = DEFAULT_MAX_BUFFERS,
+                        std::size_t maxCapacity = DEFAULT_MAX_CAPACITY);
+
+    // Returns an empty string, recycled when one is available.
+    std::string acquire();
+
+    // Hands a buffer back. Oversized buffers and buffers beyond the pool limit are simply freed.
+    void release(std::string&& buffer);
+
+    std::size_t size() const;
+
+  private:
+    mutable std::mutex m_mu;
+    std::vector<std::string> m_free;
+    std::size_t m_maxBuffers;
+    std::size_t m_maxCapacity;
+  };
+
+}  // namespace server
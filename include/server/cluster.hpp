@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "project/core/result.hpp"
+
+namespace server
+{
+  // One process of a multi-process deployment, as the front router reaches it.
+  struct ClusterNode
+  {
+    std::string host;
+    std::uint16_t port{ 0 };
+  };
+
+  // "host:port,host:port,..." in node order. The error names the entry that does not parse.
+  battleship::Expected<std::vector<ClusterNode>, std::string> parseClusterNodes(std::string_view list);
+
+  // Game ids of a cluster carry their owning node: node i of n > 1 creates "<i>-<random>". A single process
+  // keeps unprefixed ids.
+  std::string gameIdPrefix(unsigned node, std::size_t nodeCount);
+
+  // The node owning `gameId` out of `nodeCount`. Ids without a valid node prefix belong to node 0, so games
+  // created before the deployment was split stay reachable there.
+  std::size_t gameOwner(std::string_view gameId, std::size_t nodeCount) noexcept;
+
+  // GET /games through the router pages through node 0's lobby, then node 1's, and so on, so its cursors name
+  // the node they continue on: router cursor c resumes node c % n after that node's own cursor c / n.
+  struct LobbyCursor
+  {
+    std::size_t node{ 0 };
+    std::uint64_t cursor{ 0 };  // the node's own listGames() cursor
+  };
+
+  LobbyCursor splitLobbyCursor(std::uint64_t cursor, std::size_t nodeCount) noexcept;
+  std::uint64_t joinLobbyCursor(const LobbyCursor& cursor, std::size_t nodeCount) noexcept;
+
+}  // namespace server
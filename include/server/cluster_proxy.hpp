@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "server/server_config.hpp"
+
+namespace server
+{
+  class ProxyRuntime;
+
+  // Front router of a multi-process deployment. Every request is forwarded to one of ServerConfig::clusterNodes:
+  // requests on a game or matchmaking ticket go to the node its id names (see gameOwner()), joining the
+  // matchmaking queue to node 0 so that every player waits in the same one, and everything else, game creation
+  // included, to the nodes in turn. The lobby listing pages through each node's games in node order; its
+  // cursors name the node to continue on (see splitLobbyCursor()), and a page can come back short where one
+  // node's lobby runs out. Each client connection keeps one keep-alive connection per node it has talked to, on
+  // the same strand, so forwarding takes no lock.
+  //
+  // A request on a reused node connection is sent once more on a fresh one when it could not be written or the
+  // node closed the connection before answering, since the node may have closed the idle connection. After a
+  // reset only GET and HEAD are, since the node may have applied the request before it failed; other failures
+  // answer 502, timeouts 504.
+  class ClusterProxy
+  {
+  public:
+    explicit ClusterProxy(ServerConfig config);
+    ~ClusterProxy();
+
+    ClusterProxy(const ClusterProxy&) = delete;
+    ClusterProxy& operator=(const ClusterProxy&) = delete;
+
+    // Resolves the nodes, binds the listening socket and starts the I/O threads. Throws
+    // boost::system::system_error when a node cannot be resolved or the address cannot be bound.
+    void start();
+
+    // Blocks until the proxy has drained, as HttpServer::wait() does.
+    void wait();
+
+    // start(), report the address, wait().
+    void run();
+
+    // Stops accepting and closes client connections once their request in flight has been answered. Safe to
+    // call from any thread.
+    void stop();
+
+    // The bound port once start() has returned.
+    std::uint16_t port() const noexcept { return m_port.load(std::memory_order_acquire); }
+
+  private:
+    ServerConfig m_config;
+    std::atomic<std::uint16_t> m_port{ 0 };
+    std::unique_ptr<ProxyRuntime> m_runtime;
+  };
+
+}  // namespace server
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "project/core/boat.hpp"
+#include "project/core/coordinate.hpp"
+
+namespace server
+{
+  enum class GameEventType : std::uint8_t
+  {
+    CreateGame = 1,
+    JoinGame,
+    PlaceShip,
+    ReadyUp,
+    Shoot
+  };
+
+  // One successful GameStore mutation. Only the fields relevant to the event type are meaningful.
+  struct GameEvent
+  {
+    GameEventType type{ GameEventType::CreateGame };
+    std::uint64_t seq{};
+    std::string gameId;
+    std::array<std::string, 2> tokens;                                    // CreateGame
+    int player{};                                                         // PlaceShip, ReadyUp, Shoot
+    battleship::BoatType boat{ battleship::BoatType::CARRIER };           // PlaceShip
+    battleship::Orientation orientation{ battleship::Orientation::EAST }; // PlaceShip
+    battleship::Coordinate coordinate{};                                  // PlaceShip, Shoot
+  };
+
+  struct EventLogOptions
+  {
+    std::string path;
+    // How long appended events may wait before the background thread writes and syncs them.
+    std::chrono::milliseconds commitInterval{ 5 };
+  };
+
+  // Append-only write-ahead log of game events.
+  //
+  // append() only encodes the event into an in-memory batch; a background thread writes the batch and calls
+  // fdatasync once per commit interval, so a request never waits on the disk. Each record is framed as
+  // [u32 payload length][u32 crc32][payload]; reading stops at the first short or corrupt record, which is
+  // what a crash in the middle of a write leaves behind.
+  //
+  // A batch that fails to write or sync is cut off the file again and kept for the next commit, and the log
+  // reports the failure through error() until a commit succeeds; nothing in the batch counts as committed.
+  class EventLog
+  {
+  public:
+    // Opens (or creates) the log, loads its valid records and truncates any torn tail.
+    explicit EventLog(EventLogOptions options);
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // Assigns the next sequence number and queues the event for the next group commit. A failed log still
+    // queues it behind the batch being retried; callers check error() before making a change they log.
+    std::uint64_t append(GameEvent event);
+
+    // Blocks until every event appended before the call is on disk. Throws std::system_error when a commit
+    // fails first.
+    void flush();
+
+    // Why the last commit failed; empty once a commit has succeeded again.
+    std::error_code error() const noexcept;
+
+    // Events found in the file when it was opened, in log order.
+    const std::vector<GameEvent>& recovered() const noexcept { return m_recovered; }
+    void releaseRecovered();
+
+    std::uint64_t lastSeq() const;
+
+    // Numbers later events above `seq`. A snapshot can cover events that a crash kept out of the log; without
+    // this, new events would reuse their numbers and replay would skip them as already in the snapshot.
+    void advanceTo(std::uint64_t seq);
+
+    // Starts a new log file. The current one becomes "<path>.prev" (replacing the previous one) and is still
+    // read on open, so rotate only once a snapshot covers everything older than the current file.
+    void rotate();
+    std::string previousPath() const;
+    const std::string& path() const noexcept { return m_options.path; }
+
+    static std::vector<GameEvent> readAll(const std::string& path);
+
+    static void encode(const GameEvent& event, std::string& out);
+
+  private:
+    void run();
+    void commit(std::unique_lock<std::mutex>& lk);
+
+  private:
+    EventLogOptions m_options;
+    int m_fd{ -1 };
+    std::vector<GameEvent> m_recovered;
+
+    mutable std::mutex m_mu;
+    std::mutex m_fileMu;  // guards m_fd against rotate() while a batch is written
+    std::condition_variable m_wake;
+    std::condition_variable m_committedCv;
+    std::string m_pending;
+    std::string m_writing;
+    std::uint64_t m_nextSeq{ 1 };
+    std::uint64_t m_pendingSeq{ 0 };
+    std::uint64_t m_committedSeq{ 0 };
+    std::uint64_t m_attempts{ 0 };  // batches written or failed so far
+    std::atomic<int> m_errno{ 0 };  // of the last commit, 0 when it succeeded
+    bool m_flushRequested{ false };
+    bool m_stop{ false };
+    std::thread m_thread;
+  };
+
+  // Fsyncs the directory holding `path`, so a file renamed or created there survives a crash. Throws
+  // std::system_error.
+  void syncParentDirectory(const std::string& path);
+
+}  // namespace server
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "project/core/board.hpp"
+
+namespace server
+{
+  // Move history of one game in the compact form it is stored in.
+  //
+  // Placements are packed into 16 bits: cell index (row * BOARD_SIZE + col) in bits 0-6, orientation in bits 7-8
+  // and boat type in bits 9-11. A shot is one byte: target cell in bits 0-6 and bit 7 set on a hit. Players
+  // alternate turns starting with player 1, so the shooter of shot i is i % 2.
+  struct GameRecord
+  {
+    static constexpr std::uint8_t HIT_BIT = 0x80;
+    static constexpr std::uint8_t CELL_MASK = 0x7F;
+
+    std::string gameId;
+    std::array<std::uint64_t, 2> playerHash{};  // codec::fnv1a64 of each player's token
+    std::int64_t startedAtMs{ 0 };
+    std::int64_t finishedAtMs{ 0 };
+    std::uint8_t winner{ 0 };  // 1 or 2, 0 while the game is running
+    std::array<std::vector<std::uint16_t>, 2> fleets;
+    std::vector<std::uint8_t> shots;
+
+    void addPlacement(int player, const battleship::FleetPlacement& ship)
+    {
+      fleets[static_cast<std::size_t>(player)].push_back(packPlacement(ship));
+    }
+
+    void addShot(const battleship::Coordinate& target, bool hit)
+    {
+      shots.push_back(static_cast<std::uint8_t>(packCell(target) | (hit ? HIT_BIT : 0U)));
+    }
+
+    static constexpr std::uint8_t packCell(const battleship::Coordinate& c) noexcept
+    {
+      return static_cast<std::uint8_t>(c.row * battleship::BOARD_SIZE + c.col);
+    }
+
+    static constexpr battleship::Coordinate unpackCell(std::uint8_t cell) noexcept
+    {
+      return battleship::Coordinate{ (cell & CELL_MASK) / battleship::BOARD_SIZE,
+                                     (cell & CELL_MASK) % battleship::BOARD_SIZE };
+    }
+
+    static constexpr std::uint16_t packPlacement(const battleship::FleetPlacement& ship) noexcept
+    {
+      return static_cast<std::uint16_t>(packCell(ship.placement.coordinate) |
+                                        (static_cast<unsigned>(ship.placement.orientation) << 7) |
+                                        (static_cast<unsigned>(ship.type) << 9));
+    }
+
+    static constexpr battleship::FleetPlacement unpackPlacement(std::uint16_t packed) noexcept
+    {
+      return battleship::FleetPlacement{
+        static_cast<battleship::BoatType>((packed >> 9) & 0x7U),
+        battleship::Placement{ unpackCell(static_cast<std::uint8_t>(packed & CELL_MASK)),
+                               static_cast<battleship::Orientation>((packed >> 7) & 0x3U) } };
+    }
+  };
+
+  // Zero-copy view of an encoded record; spans point into the buffer it was parsed from.
+  struct GameRecordView
+  {
+    std::string_view gameId;
+    std::array<std::uint64_t, 2> playerHash{};
+    std::int64_t startedAtMs{ 0 };
+    std::int64_t finishedAtMs{ 0 };
+    std::uint8_t winner{ 0 };
+    std::array<std::span<const std::uint8_t>, 2> fleets;  // little-endian packed placements, 2 bytes each
+    std::span<const std::uint8_t> shots;
+
+    std::uint16_t placement(int player, std::size_t i) const noexcept
+    {
+      const auto& fleet = fleets[static_cast<std::size_t>(player)];
+      return static_cast<std::uint16_t>(fleet[2 * i] | (fleet[2 * i + 1] << 8));
+    }
+    std::size_t fleetSize(int player) const noexcept { return fleets[static_cast<std::size_t>(player)].size() / 2; }
+  };
+
+  // Appends one framed record ([u32 payload length][u32 crc32][payload]) to `out`.
+  void encodeGameRecord(const GameRecord& record, std::string& out);
+
+  // Decodes the framed record at the start of [data, data + size). On success `consumed` is set to its framed
+  // length; a short, corrupt or unknown record yields nullopt.
+  std::optional<GameRecord> decodeGameRecord(const char* data, std::size_t size, std::size_t& consumed);
+
+  // Same framing rules as decodeGameRecord() without copying anything. Skipping the checksum is for scans over
+  // segments that were already verified.
+  bool parseGameRecord(const char* data,
+                       std::size_t size,
+                       GameRecordView& view,
+                       std::size_t& consumed,
+                       bool verifyChecksum = true) noexcept;
+
+}  // namespace server
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/game_record.hpp"
+
+namespace server
+{
+  struct RecorderOptions
+  {
+    std::string directory;
+    std::size_t segmentBytes{ 64 * 1024 * 1024 };
+    std::chrono::milliseconds flushInterval{ 50 };
+  };
+
+  // Writes finished games to append-only segment files ("<directory>/segment-NNNNNN.bsr").
+  //
+  // submit() is the only call on the request path: it pushes the record onto a lock-free stack and returns.
+  // A writer thread drains the stack once per flush interval, encodes the batch in submission order and
+  // appends it to the current segment, starting a new one past segmentBytes. Each run opens a fresh segment,
+  // so a segment torn by a crash is never appended to. A batch that fails to write is dropped and counted in
+  // recordsFailed(); its partial bytes are cut off the segment again, or the writer moves on to a new segment
+  // when they cannot be, so every segment stays a run of whole records.
+  class GameRecorder
+  {
+  public:
+    explicit GameRecorder(RecorderOptions options);
+    ~GameRecorder();
+
+    GameRecorder(const GameRecorder&) = delete;
+    GameRecorder& operator=(const GameRecorder&) = delete;
+
+    void submit(std::unique_ptr<GameRecord> record) noexcept;
+
+    // Blocks until every record submitted before the call has been written or dropped.
+    void flush();
+
+    std::uint64_t recordsWritten() const noexcept { return m_written.load(std::memory_order_acquire); }
+    std::uint64_t recordsFailed() const noexcept { return m_failed.load(std::memory_order_acquire); }
+
+    // Segment files in `directory`, oldest first.
+    static std::vector<std::string> listSegments(const std::string& directory);
+
+  private:
+    struct Node
+    {
+      std::unique_ptr<GameRecord> record;
+      Node* next{ nullptr };
+    };
+
+    void run();
+    void drain();
+    bool openSegment();
+    void rollSegment();
+
+  private:
+    RecorderOptions m_options;
+    std::atomic<Node*> m_head{ nullptr };
+    std::atomic<std::uint64_t> m_submitted{ 0 };
+    std::atomic<std::uint64_t> m_written{ 0 };
+    std::atomic<std::uint64_t> m_failed{ 0 };
+
+    int m_fd{ -1 };
+    std::uint32_t m_segmentIndex{ 0 };
+    std::size_t m_segmentSize{ 0 };
+    std::string m_buffer;
+
+    std::mutex m_mu;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    bool m_flushRequested{ false };
+    bool m_stop{ false };
+    std::thread m_thread;
+  };
+
+}  // namespace server
@@ -1,46 +1,192 @@
 #pragma once
 
-#include <mutex>
+#include <array>
+#include <atomic>
+#include <map>
 #include <optional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "server/game_types.hpp"
+#include "server/profiled_mutex.hpp"
 
+#include "project/core/board.hpp"
 #include "project/core/boat.hpp"
 #include "project/core/coordinate.hpp"
 #include "project/core/placement.hpp"
 
 namespace server
 {
+  class EventLog;
+  class GameRecorder;
+  class Matchmaker;
+  class SpectatorHub;
+  struct GameEvent;
+
+  // Games live in one or more shards, each a map under its own lock, chosen by hashing the game id. With the
+  // default single shard every call takes the same lock; more shards let calls on different games proceed in
+  // parallel, and a caller that only ever touches a shard from one thread (see ServerConfig::gameActors) never
+  // finds its lock taken.
+  //
+  // Ids of created games start with `idPrefix`; a node of a multi-process deployment uses it to mark the
+  // games it owns (see gameIdPrefix()).
   class GameStore
   {
   public:
+    explicit GameStore(std::size_t shards = 1, std::string idPrefix = {});
+
+    std::size_t shardCount() const noexcept { return m_shardCount; }
+    std::size_t shardOf(std::string_view gameId) const noexcept;
+    const std::string& idPrefix() const noexcept { return m_idPrefix; }
+
     CreateGameResult createGame();
     JoinGameResult joinGame(const std::string& gameId);
 
     AuthContext authenticate(const std::string& gameId, const std::string& authHeader) const;
 
+    // Same check as authenticate() without copying the token: 0/1 for the matching player, -1 otherwise.
+    int authorizedPlayer(const std::string& gameId, std::string_view authHeader) const;
+
     void placeShip(const std::string& gameId,
                    int playerIndex,
                    battleship::BoatType type,
                    const battleship::Coordinate& start,
                    battleship::Orientation orientation);
 
+    // Places the whole fleet under a single lock; on any invalid boat nothing is placed.
+    void placeFleet(const std::string& gameId, int playerIndex, const std::vector<battleship::FleetPlacement>& fleet);
+
+    // Places the standard fleet at random legal positions; the player's board must still be empty.
+    std::vector<battleship::FleetPlacement> placeRandomFleet(const std::string& gameId, int playerIndex);
+
     GameStatus readyUp(const std::string& gameId, int playerIndex);
 
     ShotOutcome shoot(const std::string& gameId, int playerIndex, const battleship::Coordinate& target);
 
     std::optional<GameView> getGameView(const std::string& gameId) const;
 
+    std::optional<GameHistory> getHistory(const std::string& gameId) const;
+
+    // Up to `limit` games currently in `status`, in the order they entered it, starting after `cursor` (0 for
+    // the first page). Reads only the page from a per-status index; each shard's lock is held for its part of
+    // the page alone, so a page is not a snapshot across shards.
+    GameListing listGames(GameStatus status, std::size_t limit, std::uint64_t cursor = 0) const;
+
+    // Non-throwing variants used by the HTTP layer. Rejections are reported as a StoreError;
+    // the throwing API above wraps these and raises the matching exception.
+    // While an attached event log is failing to commit, every change is refused with LogUnavailable.
+    StoreResult<CreateGameResult> tryCreateGame();
+
+    StoreResult<JoinGameResult> tryJoinGame(const std::string& gameId);
+
+    std::optional<StoreError> tryPlaceShip(const std::string& gameId,
+                                           int playerIndex,
+                                           battleship::BoatType type,
+                                           const battleship::Coordinate& start,
+                                           battleship::Orientation orientation);
+
+    std::optional<StoreError> tryPlaceFleet(const std::string& gameId,
+                                            int playerIndex,
+                                            const std::vector<battleship::FleetPlacement>& fleet);
+
+    StoreResult<std::vector<battleship::FleetPlacement>> tryPlaceRandomFleet(const std::string& gameId, int playerIndex);
+
+    StoreResult<GameStatus> tryReadyUp(const std::string& gameId, int playerIndex);
+
+    StoreResult<ShotOutcome> tryShoot(const std::string& gameId, int playerIndex, const battleship::Coordinate& target);
+
+    // Rebuilds the games recorded in the log's recovered events, then records every later mutation to it, numbered
+    // after everything the log or a loaded snapshot holds. Call once at startup, before serving; returns the
+    // number of events replayed.
+    std::size_t attachEventLog(std::shared_ptr<EventLog> log);
+
+    // Writes a point-in-time image of every game to `path`. The lock is taken once to list the games and then
+    // per chunk while they are encoded, so requests keep being served during the pass. Returns the game count.
+    std::size_t writeSnapshot(const std::string& path) const;
+
+    // Restores the games of a snapshot written by writeSnapshot(); call before attachEventLog(), whose replay
+    // then skips events each game already contains. Returns false when there is no usable snapshot.
+    bool loadSnapshot(const std::string& path);
+
+    // Hands a copy of each game's move history to the recorder when the game ends.
+    void attachRecorder(std::shared_ptr<GameRecorder> recorder);
+
+    // Serves POST /matchmaking with `matchmaker`, which creates its games in this store. Call before serving.
+    void attachMatchmaker(std::shared_ptr<Matchmaker> matchmaker);
+    Matchmaker* matchmaker() const noexcept { return m_matchmaker.get(); }
+
+    // Serves GET /games/{id}/spectate from `hub`, which the request handlers publish game updates to. Call
+    // before serving.
+    void attachSpectators(std::shared_ptr<SpectatorHub> hub);
+    SpectatorHub* spectators() const noexcept { return m_spectators.get(); }
+
+    // Live games per status and how contended the store locks have been, summed over the shards.
+    StoreStats stats() const;
+
+    // Lock acquisitions, wait and hold times per operation over all shards; all zero unless lock profiling is
+    // compiled in.
+    LockProfile lockProfile() const;
+
   private:
+    struct alignas(64) Shard
+    {
+      mutable ProfiledMutex mu;
+      std::unordered_map<std::string, std::shared_ptr<GameState>> games;
+      // Per status, the ids of its games by GameState::listingKey; also the live game counts.
+      std::array<std::map<std::uint64_t, std::string>, GAME_STATUS_COUNT> byStatus;
+    };
+
     static std::string randomId(std::size_t n);
     static std::string randomToken();
 
+    Shard& shardFor(std::string_view gameId) const noexcept { return m_shards[shardOf(gameId)]; }
+
+    // Every shard's lock, taken in shard order, for the calls that change or read the store as a whole.
+    std::vector<ProfiledMutex::Guard> lockAll(StoreOp op) const;
+
+    // Shared precondition of every placement call; expects the shard's lock to be held.
+    StoreResult<GameState*> placingGame(Shard& shard, const std::string& gameId, int playerIndex);
+
+    // Mutations shared by the public calls and log replay; all expect the shard's lock to be held and record
+    // nothing.
+    StoreResult<JoinGameResult> joinLocked(Shard& shard, const std::string& gameId);
+    StoreResult<GameState*> placeShipLocked(Shard& shard,
+                                            const std::string& gameId,
+                                            int playerIndex,
+                                            battleship::BoatType type,
+                                            const battleship::Coordinate& start,
+                                            battleship::Orientation orientation);
+    StoreResult<GameStatus> readyUpLocked(Shard& shard, const std::string& gameId, int playerIndex);
+    StoreResult<ShotOutcome> shootLocked(Shard& shard,
+                                         const std::string& gameId,
+                                         int playerIndex,
+                                         const battleship::Coordinate& target);
+    bool applyLocked(const GameEvent& ev);
+
+    bool logFailed() const noexcept;
+    void record(Shard& shard, GameEvent&& ev);
+    void recordPlacement(Shard& shard, const std::string& gameId, int playerIndex, const battleship::FleetPlacement& ship);
+    void finishHistory(GameState& game, int winnerIndex);
+    void setStatus(Shard& shard, GameState& game, GameStatus status);
+
+    // Adds a game just put into `shard.games` to the index of its status, or takes it out before it is replaced.
+    void indexGame(Shard& shard, const std::string& gameId, GameState& game);
+    static void unindexGame(Shard& shard, const GameState& game);
+
   private:
-    mutable std::mutex m_mu;
-    std::unordered_map<std::string, std::shared_ptr<GameState>> m_games;
+    const std::size_t m_shardCount;
+    std::unique_ptr<Shard[]> m_shards;
+    const std::string m_idPrefix;
+    std::atomic<std::uint64_t> m_nextListingKey{ 1 };  // store-wide, so one cursor orders every shard
+    std::shared_ptr<EventLog> m_log;
+    std::shared_ptr<GameRecorder> m_recorder;
+    bool m_replaying{ false };
+    std::uint64_t m_restoredSeq{ 0 };  // the newest event the loaded snapshot contains
+    std::shared_ptr<SpectatorHub> m_spectators;
+    std::shared_ptr<Matchmaker> m_matchmaker;  // last: its pairing thread still creates games while it stops
   };
 
 }  // namespace server
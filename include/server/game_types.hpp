@@ -1,10 +1,16 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "project/core/board.hpp"
+#include "project/core/result.hpp"
+#include "server/game_record.hpp"
 
 namespace server
 {
@@ -16,6 +22,8 @@ namespace server
     Finished
   };
 
+  inline constexpr std::size_t GAME_STATUS_COUNT = static_cast<std::size_t>(GameStatus::Finished) + 1;
+
   inline const char* to_cstr(GameStatus s) noexcept
   {
     switch (s)
@@ -28,6 +36,79 @@ namespace server
     return "unknown";
   }
 
+  inline std::optional<GameStatus> parseGameStatus(std::string_view s) noexcept
+  {
+    for (std::size_t i = 0; i < GAME_STATUS_COUNT; ++i)
+    {
+      if (s == to_cstr(static_cast<GameStatus>(i)))
+      {
+        return static_cast<GameStatus>(i);
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Ordinary reasons a store operation is rejected. Board-level rejections keep their BoardError wording.
+  enum class StoreError : std::uint8_t
+  {
+    GameNotFound,
+    GameFull,
+    InvalidPlayer,
+    PlayerNotJoined,
+    GameFinished,
+    NotInProgress,
+    NotYourTurn,
+    FleetAlreadyPlaced,
+    OutOfBounds,
+    CoordinateOutOfBounds,
+    Collision,
+    AlreadyShot,
+    UndefinedShot,
+    InvalidOrientation,
+    LogUnavailable  // the event log cannot persist changes right now
+  };
+
+  inline const char* to_cstr(StoreError e) noexcept
+  {
+    switch (e)
+    {
+      case StoreError::GameNotFound: return "Game not found.";
+      case StoreError::GameFull: return "Game already has 2 players.";
+      case StoreError::InvalidPlayer: return "Invalid player.";
+      case StoreError::PlayerNotJoined: return "Player not joined.";
+      case StoreError::GameFinished: return "Game finished.";
+      case StoreError::NotInProgress: return "Game not in progress.";
+      case StoreError::NotYourTurn: return "Not your turn.";
+      case StoreError::FleetAlreadyPlaced: return "Fleet already placed.";
+      case StoreError::OutOfBounds: return battleship::to_cstr(battleship::BoardError::OutOfBounds);
+      case StoreError::CoordinateOutOfBounds: return battleship::to_cstr(battleship::BoardError::CoordinateOutOfBounds);
+      case StoreError::Collision: return battleship::to_cstr(battleship::BoardError::Collision);
+      case StoreError::AlreadyShot: return battleship::to_cstr(battleship::BoardError::AlreadyShot);
+      case StoreError::UndefinedShot: return battleship::to_cstr(battleship::BoardError::UndefinedShot);
+      case StoreError::InvalidOrientation: return battleship::to_cstr(battleship::BoardError::InvalidOrientation);
+      case StoreError::LogUnavailable: return "Game changes cannot be saved right now.";
+    }
+    return "unknown";
+  }
+
+  inline StoreError to_store_error(battleship::BoardError e) noexcept
+  {
+    switch (e)
+    {
+      case battleship::BoardError::OutOfBounds: return StoreError::OutOfBounds;
+      case battleship::BoardError::CoordinateOutOfBounds: return StoreError::CoordinateOutOfBounds;
+      case battleship::BoardError::Collision: return StoreError::Collision;
+      case battleship::BoardError::AlreadyShot: return StoreError::AlreadyShot;
+      case battleship::BoardError::UndefinedShot: return StoreError::UndefinedShot;
+      case battleship::BoardError::InvalidOrientation: return StoreError::InvalidOrientation;
+      case battleship::BoardError::None: break;
+    }
+    return StoreError::UndefinedShot;
+  }
+
+  template<typename T>
+  using StoreResult = battleship::Expected<T, StoreError>;
+
   struct CreateGameResult
   {
     std::string gameId;
@@ -59,6 +140,9 @@ namespace server
     int turn{ 0 };  // 0 => player1, 1 => player2
     std::array<std::string, 2> token;
     GameStatus status{ GameStatus::WaitingForPlayers };
+    std::uint64_t lastSeq{ 0 };  // sequence number of the last logged event applied to this game
+    std::uint64_t listingKey{ 0 };  // position in the store's index of games with this status
+    GameRecord history;  // every placement and shot, in order
   };
 
   struct BoardView
@@ -72,6 +156,28 @@ namespace server
     int turn{ 0 };
     bool ready[2]{ false, false };
     BoardView boards[2];
+    std::uint64_t revision{ 0 };  // grows with every join, placement, ready-up and shot; orders views of a game
+  };
+
+  struct GameHistory
+  {
+    GameStatus status{ GameStatus::WaitingForPlayers };
+    GameRecord record;
+  };
+
+  // One page of GameStore::listGames(), oldest entry into the status first.
+  struct GameListing
+  {
+    std::vector<std::string> gameIds;
+    std::uint64_t nextCursor{ 0 };  // pass back for the next page; 0 when this was the last
+  };
+
+  struct StoreStats
+  {
+    std::array<std::size_t, GAME_STATUS_COUNT> gamesByStatus{};
+    std::uint64_t lockAcquisitions{ 0 };
+    std::uint64_t lockContended{ 0 };  // acquisitions that had to wait
+    std::uint64_t lockWaitNs{ 0 };     // total time spent waiting in those
   };
 
   struct AuthContext
@@ -2,7 +2,11 @@
 
 #include <boost/beast/http.hpp>
 
+#include "server/admission.hpp"
 #include "server/game_store.hpp"
+#include "server/request_trace.hpp"
+#include "server/route_table.hpp"
+#include "server/spectator_hub.hpp"
 
 namespace server
 {
@@ -10,4 +14,31 @@ namespace server
 
   http::response<http::string_body> handle_request(GameStore& store, http::request<http::string_body> req);
 
+  // Serves `req` into `res`, reusing whatever headers and body capacity `res` already holds. Connections keep
+  // one response object alive across requests so steady-state polling does not allocate. A non-null `trace`
+  // must have been begun; the route, auth, parse, store and serialize stages are marked on it. With an
+  // `admission` ticket, a request over its limits is answered 503 or 429 right after the route lookup.
+  void handle_request(GameStore& store,
+                      const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      RequestTrace* trace = nullptr,
+                      AdmissionTicket* admission = nullptr);
+
+  // As above for a request whose route the connection has matched already. A connection that streams
+  // spectators passes `streamsSpectators`: an answered GET /games/{id}/spectate then gets its status and
+  // headers but no frame, since the stream sends the hub's frames instead.
+  void handle_request(GameStore& store,
+                      const RouteMatch& route,
+                      const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      RequestTrace* trace = nullptr,
+                      AdmissionTicket* admission = nullptr,
+                      bool streamsSpectators = false);
+
+  // Serializes the current state of `gameId` once, as an event-stream frame ("data: {json}\n\n") showing the
+  // boards as the hub's policy allows, and publishes it to the game's spectators. Request handling calls this
+  // after each successful move of a watched game; a new viewer's connection calls it when the hub has no frame
+  // of the game yet. Returns false when the game does not exist.
+  bool publish_spectator_frame(const GameStore& store, SpectatorHub& hub, const std::string& gameId);
+
 }  // namespace server
@@ -1,19 +1,53 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 
+#include "server/buffer_pool.hpp"
 #include "server/game_store.hpp"
+#include "server/server_config.hpp"
 
 namespace server
 {
+  class ServerRuntime;
+
+  // Asynchronous HTTP/1.1 server: ServerConfig::ioThreads threads share one event loop and every connection runs
+  // its read/handle/write chain on its own strand.
   class HttpServer
   {
   public:
-    explicit HttpServer(GameStore& store);
+    explicit HttpServer(GameStore& store, ServerConfig config = {});
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Binds the listening socket and starts the I/O threads. Throws boost::system::system_error when the address
+    // cannot be bound.
+    void start();
+
+    // Blocks until the server has drained: after stop(), SIGTERM or SIGINT, once open requests have been answered
+    // or the drain timeout has passed.
+    void wait();
+
+    // start(), report the address, wait().
+    void run();
     void run(std::uint16_t port);
 
+    // Stops accepting, closes idle connections and lets in-flight requests finish, answering them with
+    // `Connection: close`. Safe to call from any thread.
+    void stop();
+
+    // The bound port once start() has returned; differs from the configured one when that was 0.
+    std::uint16_t port() const noexcept { return m_port.load(std::memory_order_acquire); }
+
   private:
     GameStore& m_store;
+    ServerConfig m_config;
+    BufferPool m_buffers;
+    std::atomic<std::uint16_t> m_port{ 0 };
+    std::unique_ptr<ServerRuntime> m_runtime;  // declared last: its sessions hand buffers back on destruction
   };
 
 }  // namespace server
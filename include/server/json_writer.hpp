@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace server
+{
+  // Streams compact JSON straight into a caller-owned string, so a reused buffer needs no allocation once warm.
+  //
+  // The output is byte-for-byte what boost::property_tree::write_json(..., false) produces for the same tree:
+  // every scalar is written as a JSON string, '/' and non-printable characters are escaped the same way, and
+  // finish() appends the trailing newline. Clients written against the ptree responses keep working.
+  class JsonWriter
+  {
+  public:
+    explicit JsonWriter(std::string& out) noexcept;
+
+    void beginObject();
+    void beginObject(std::string_view key);
+    void endObject();
+
+    void beginArray(std::string_view key);
+    void endArray();
+
+    void field(std::string_view key, std::string_view value);
+    void field(std::string_view key, const char* value);
+    void field(std::string_view key, bool value);
+    void field(std::string_view key, std::int64_t value);
+    void field(std::string_view key, int value);
+    void field(std::string_view key, std::size_t value);
+
+    // Appends a string element to the innermost array.
+    void element(std::string_view value);
+
+    void finish();
+
+  private:
+    void separator();
+    void key(std::string_view name);
+    void string(std::string_view value);
+    void push();
+
+    static constexpr std::size_t MAX_DEPTH = 16;
+
+    std::string& m_out;
+    std::array<bool, MAX_DEPTH> m_hasMembers{};
+    std::size_t m_depth{ 0 };
+  };
+
+}  // namespace server
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace server
+{
+  // Read-only mapping of a whole file. A missing or empty file maps to an empty view.
+  class MappedFile
+  {
+  public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    std::string_view view() const noexcept { return { m_data, m_size }; }
+
+  private:
+    void reset() noexcept;
+
+  private:
+    const char* m_data{ nullptr };
+    std::size_t m_size{ 0 };
+  };
+
+}  // namespace server
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <semaphore>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "server/game_types.hpp"
+#include "server/mpmc_queue.hpp"
+
+namespace server
+{
+  class GameStore;
+
+  struct MatchStatus
+  {
+    bool matched{ false };
+    JoinGameResult seat;  // the player's game, id and token once matched
+  };
+
+  // Pairs players who ask for a game into new games of the store, two at a time per bucket (a variant or
+  // rating band the client picks).
+  //
+  // Tickets live in a fixed table. Free entries and the waiting players of each bucket are indices in lock-free
+  // queues, so enqueuing takes no lock; a single pairing thread drains the queues, creates a game per pair and
+  // publishes each player's seat on its ticket, where the next poll picks it up. A seat is handed out once and
+  // the ticket is gone after that.
+  //
+  // A waiting player who has not polled for the timeout is dropped instead of being matched, and a seat not
+  // collected within the timeout is given up, so abandoned tickets free their entries.
+  class Matchmaker
+  {
+  public:
+    static constexpr std::size_t BUCKETS = 8;
+    static constexpr std::size_t DEFAULT_CAPACITY = 16384;
+    static constexpr std::chrono::seconds DEFAULT_TIMEOUT{ 30 };
+
+    explicit Matchmaker(GameStore& store,
+                        std::size_t capacity = DEFAULT_CAPACITY,
+                        std::chrono::seconds timeout = DEFAULT_TIMEOUT);
+    ~Matchmaker();
+
+    Matchmaker(const Matchmaker&) = delete;
+    Matchmaker& operator=(const Matchmaker&) = delete;
+
+    // Queues a player of `bucket` (< BUCKETS) and returns the ticket to poll; nullopt when every ticket is in use.
+    std::optional<std::string> enqueue(std::size_t bucket = 0);
+
+    // Still waiting, or the player's seat. nullopt for a ticket that is unknown, expired or already collected.
+    std::optional<MatchStatus> poll(std::string_view ticket);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    enum State : std::uint32_t
+    {
+      Free,
+      Waiting,
+      Matched,
+      Claimed  // a poll is copying the seat out
+    };
+
+    struct alignas(64) Ticket
+    {
+      std::atomic<std::uint32_t> state{ Free };
+      std::atomic<std::uint64_t> secret{ 0 };
+      std::atomic<std::int64_t> touchedNs{ 0 };  // last poll while waiting; when the seat was published once matched
+      JoinGameResult seat;                       // written before the ticket turns Matched
+    };
+
+    static std::int64_t nowNs() noexcept;
+
+    void wake() noexcept;
+    void run();
+    void pair(std::uint32_t first, std::uint32_t second);
+    void release(std::uint32_t index);
+    bool stale(const Ticket& ticket, std::int64_t now) const noexcept;
+    void sweep(std::int64_t now);
+
+  private:
+    GameStore& m_store;
+    const std::int64_t m_timeoutNs;
+    const std::size_t m_capacity;
+    std::unique_ptr<Ticket[]> m_tickets;
+    MpmcQueue<std::uint32_t> m_free;
+    std::vector<std::unique_ptr<MpmcQueue<std::uint32_t>>> m_waiting;  // per bucket
+
+    // Set by the first enqueue after the pairing thread last woke, so a burst of enqueues wakes it once.
+    std::atomic<bool> m_signalled{ false };
+    std::binary_semaphore m_wake{ 0 };
+    std::atomic<bool> m_stopping{ false };
+    std::thread m_worker;  // last: started once everything it reads exists
+  };
+
+}  // namespace server
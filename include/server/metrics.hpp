@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "server/game_types.hpp"
+#include "server/request_trace.hpp"
+#include "server/route_table.hpp"
+
+namespace server
+{
+  class GameStore;
+
+  // Log-linear latency buckets over whole microseconds: one bucket per value below 2, then two per power of two
+  // (upper bounds 1, 2, 3, 4, 6, 8, 12, 16, ...). The last bucket takes everything from about 50 s up.
+  struct LatencyBuckets
+  {
+    static constexpr std::size_t COUNT = 52;
+
+    static constexpr std::size_t bucketFor(std::uint64_t micros) noexcept
+    {
+      if (micros < 2)
+      {
+        return micros;
+      }
+      std::size_t exponent = 0;
+      for (std::uint64_t v = micros; v > 1; v >>= 1)
+      {
+        ++exponent;
+      }
+      const std::size_t sub = (micros >> (exponent - 1)) & 1U;
+      const std::size_t bucket = 2 + (exponent - 1) * 2 + sub;
+      return bucket < COUNT ? bucket : COUNT - 1;
+    }
+
+    // Exclusive upper bound of `bucket` in microseconds; the last bucket is unbounded.
+    static constexpr std::uint64_t upperBoundMicros(std::size_t bucket) noexcept
+    {
+      if (bucket < 2)
+      {
+        return bucket + 1;
+      }
+      const std::size_t exponent = (bucket - 2) / 2 + 1;
+      const std::size_t sub = (bucket - 2) % 2;
+      return (3 + sub) << (exponent - 1);
+    }
+  };
+
+  // Process-wide request metrics.
+  //
+  // Every counter lives in one of SHARDS cache-line-aligned shards and each thread updates only the shard it was
+  // assigned on first use, with relaxed increments. Shards are summed when the metrics are read, so recording a
+  // request never contends with other threads doing the same.
+  class Metrics
+  {
+  public:
+    static constexpr std::size_t SHARDS = 16;
+    static constexpr unsigned MAX_STATUS = 600;
+
+    void recordRequest(RouteId route, unsigned status, std::chrono::nanoseconds latency) noexcept;
+    void recordStages(const RequestTrace& trace) noexcept;
+
+    void connectionOpened() noexcept;
+    void connectionClosed() noexcept;
+
+    std::uint64_t requestCount(RouteId route) const noexcept;
+    std::uint64_t statusCount(unsigned status) const noexcept;
+    std::int64_t openConnections() const noexcept;
+    std::array<std::uint64_t, LatencyBuckets::COUNT> latencyBuckets(RouteId route) const noexcept;
+    std::array<std::uint64_t, LatencyBuckets::COUNT> stageBuckets(TraceStage stage) const noexcept;
+
+    // Appends the Prometheus text exposition of these metrics plus the store's gauges to `out`.
+    void writePrometheus(std::string& out, const GameStore& store) const;
+
+  private:
+    using Counter = std::atomic<std::uint64_t>;
+    using Histogram = std::array<Counter, LatencyBuckets::COUNT>;
+
+    struct alignas(64) Shard
+    {
+      std::array<Counter, ROUTE_COUNT> requests{};
+      std::array<Counter, ROUTE_COUNT> latencySumNs{};
+      std::array<Histogram, ROUTE_COUNT> latency{};
+      std::array<Counter, MAX_STATUS> statuses{};
+      std::array<Counter, TRACE_STAGE_COUNT> stageSumNs{};
+      std::array<Histogram, TRACE_STAGE_COUNT> stages{};
+      std::atomic<std::int64_t> connections{ 0 };
+    };
+
+    Shard& local() noexcept;
+
+    // Sum over the shards of the histogram `pick` selects from each.
+    template<typename Pick>
+    std::array<std::uint64_t, LatencyBuckets::COUNT> merge(Pick&& pick) const noexcept
+    {
+      std::array<std::uint64_t, LatencyBuckets::COUNT> buckets{};
+      for (const auto& shard : m_shards)
+      {
+        const Histogram& histogram = pick(shard);
+        for (std::size_t b = 0; b < buckets.size(); ++b)
+        {
+          buckets[b] += histogram[b].load(std::memory_order_relaxed);
+        }
+      }
+      return buckets;
+    }
+
+    template<typename Fn>
+    std::uint64_t sum(Fn&& counter) const noexcept
+    {
+      std::uint64_t total = 0;
+      for (const auto& shard : m_shards)
+      {
+        total += counter(shard).load(std::memory_order_relaxed);
+      }
+      return total;
+    }
+
+  private:
+    std::array<Shard, SHARDS> m_shards{};
+  };
+
+  Metrics& metrics();
+
+}  // namespace server
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace server
+{
+  // Bounded multi-producer multi-consumer queue without a lock (Vyukov's array queue). Every cell carries a
+  // sequence number that says whether it is ready to be written or read at a given position, so producers and
+  // consumers only contend on their own end's counter and never wait on each other; a full or empty queue is
+  // reported rather than waited out.
+  template<typename T>
+  class MpmcQueue
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "cells are copied in and out without synchronising T itself");
+
+  public:
+    // `capacity` is rounded up to a power of two.
+    explicit MpmcQueue(std::size_t capacity)
+        : m_mask(std::bit_ceil(capacity < 2 ? std::size_t{ 2 } : capacity) - 1),
+          m_cells(std::make_unique<Cell[]>(m_mask + 1))
+    {
+      for (std::size_t i = 0; i <= m_mask; ++i)
+      {
+        m_cells[i].seq.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    std::size_t capacity() const noexcept { return m_mask + 1; }
+
+    // False when the queue is full.
+    bool tryPush(const T& value) noexcept
+    {
+      std::size_t pos = m_tail.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        Cell& cell = m_cells[pos & m_mask];
+        const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+        if (diff == 0)
+        {
+          if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            cell.value = value;
+            cell.seq.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if (diff < 0)
+        {
+          return false;
+        }
+        else
+        {
+          pos = m_tail.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    // False when the queue is empty.
+    bool tryPop(T& out) noexcept
+    {
+      std::size_t pos = m_head.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        Cell& cell = m_cells[pos & m_mask];
+        const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+        if (diff == 0)
+        {
+          if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            out = cell.value;
+            cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if (diff < 0)
+        {
+          return false;
+        }
+        else
+        {
+          pos = m_head.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+  private:
+    struct Cell
+    {
+      std::atomic<std::size_t> seq{ 0 };
+      T value{};
+    };
+
+  private:
+    const std::size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<std::size_t> m_tail{ 0 };  // next position to push
+    alignas(64) std::atomic<std::size_t> m_head{ 0 };  // next position to pop
+  };
+
+}  // namespace server
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+namespace server
+{
+#ifdef BATTLESHIP_LOCK_PROFILING
+  inline constexpr bool LOCK_PROFILING_ENABLED = true;
+#else
+  inline constexpr bool LOCK_PROFILING_ENABLED = false;
+#endif
+
+  // The GameStore operation a lock acquisition belongs to.
+  enum class StoreOp : std::uint8_t
+  {
+    CreateGame,
+    JoinGame,
+    Authenticate,
+    PlaceShip,
+    PlaceFleet,
+    PlaceRandomFleet,
+    ReadyUp,
+    Shoot,
+    GetGameView,
+    GetHistory,
+    ListGames,
+    WriteSnapshot,
+    LoadSnapshot,
+    AttachLog,
+    AttachRecorder,
+    Stats
+  };
+
+  inline constexpr std::size_t STORE_OP_COUNT = static_cast<std::size_t>(StoreOp::Stats) + 1;
+
+  const char* to_cstr(StoreOp op) noexcept;
+
+  struct LockOpStats
+  {
+    std::uint64_t acquisitions{ 0 };
+    std::uint64_t contended{ 0 };
+    std::uint64_t waitNs{ 0 };
+    std::uint64_t holdNs{ 0 };
+    std::uint64_t maxWaitNs{ 0 };
+    std::uint64_t maxHoldNs{ 0 };
+  };
+
+  // Per-operation lock statistics; every field stays zero unless built with BattleShip_ENABLE_LOCK_PROFILING.
+  struct LockProfile
+  {
+    std::array<LockOpStats, STORE_OP_COUNT> ops{};
+  };
+
+  // One line per operation that took the lock at least once.
+  void writeLockProfile(std::ostream& out, const LockProfile& profile);
+
+  // A std::mutex that counts its acquisitions and times those that had to wait.
+  //
+  // The totals are always kept. With lock profiling compiled in, each acquisition is also attributed to a
+  // StoreOp together with how long the lock was then held. Every counter is a plain integer written while the
+  // mutex is held, so reading them also requires holding it.
+  class ProfiledMutex
+  {
+  public:
+    class Guard
+    {
+    public:
+      Guard(Guard&& other) noexcept
+          : m_mutex(std::exchange(other.m_mutex, nullptr)),
+            m_op(other.m_op),
+            m_acquiredAt(other.m_acquiredAt)
+      {
+      }
+      Guard(const Guard&) = delete;
+      Guard& operator=(const Guard&) = delete;
+      Guard& operator=(Guard&&) = delete;
+
+      ~Guard()
+      {
+        if (m_mutex == nullptr)
+        {
+          return;
+        }
+        if constexpr (LOCK_PROFILING_ENABLED)
+        {
+          const auto held = static_cast<std::uint64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_acquiredAt)
+                  .count());
+          auto& stats = m_mutex->m_profile.ops[static_cast<std::size_t>(m_op)];
+          stats.holdNs += held;
+          stats.maxHoldNs = std::max(stats.maxHoldNs, held);
+        }
+        m_mutex->m_mu.unlock();
+      }
+
+    private:
+      friend class ProfiledMutex;
+
+      Guard(ProfiledMutex& mutex, StoreOp op) noexcept : m_mutex(&mutex), m_op(op)
+      {
+        if constexpr (LOCK_PROFILING_ENABLED)
+        {
+          m_acquiredAt = std::chrono::steady_clock::now();
+        }
+      }
+
+      ProfiledMutex* m_mutex;
+      StoreOp m_op;
+      std::chrono::steady_clock::time_point m_acquiredAt{};  // only set with lock profiling
+    };
+
+    // Blocks until the mutex is held; the guard releases it.
+    [[nodiscard]] Guard acquire(StoreOp op)
+    {
+      const bool contended = !m_mu.try_lock();
+      std::uint64_t waited = 0;
+      if (contended)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        m_mu.lock();
+        waited = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        ++m_contended;
+        m_waitNs += waited;
+      }
+      ++m_acquisitions;
+      if constexpr (LOCK_PROFILING_ENABLED)
+      {
+        auto& stats = m_profile.ops[static_cast<std::size_t>(op)];
+        ++stats.acquisitions;
+        if (contended)
+        {
+          ++stats.contended;
+          stats.waitNs += waited;
+          stats.maxWaitNs = std::max(stats.maxWaitNs, waited);
+        }
+      }
+      return Guard{ *this, op };
+    }
+
+    // The accessors below expect the mutex to be held by the caller.
+    std::uint64_t acquisitions() const noexcept { return m_acquisitions; }
+    std::uint64_t contended() const noexcept { return m_contended; }
+    std::uint64_t waitNs() const noexcept { return m_waitNs; }
+    const LockProfile& profile() const noexcept { return m_profile; }
+
+  private:
+    std::mutex m_mu;
+    std::uint64_t m_acquisitions{ 0 };
+    std::uint64_t m_contended{ 0 };
+    std::uint64_t m_waitNs{ 0 };
+    LockProfile m_profile;
+  };
+
+}  // namespace server
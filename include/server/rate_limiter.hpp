@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace server
+{
+  struct RateLimit
+  {
+    double perSecond{ 0 };  // sustained requests per second; 0 disables the limit
+    unsigned burst{ 0 };    // requests allowed back to back; 0 means one second's worth
+  };
+
+  // Token buckets per client key in a fixed-size open-addressing table, checked without a lock.
+  //
+  // Each bucket is a single atomic word: the time at which it will be full again (the GCRA form of a token
+  // bucket). Taking a token is one compare-and-swap that refills and spends in the same step. A bucket whose
+  // refill time has passed is full and so indistinguishable from a fresh one, which lets a new key take over
+  // its slot; the table never needs sweeping. When every slot a key probes is busy, the request is let through.
+  class RateLimiter
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t DEFAULT_CAPACITY = 16384;
+    static constexpr std::size_t PROBES = 8;
+
+    explicit RateLimiter(RateLimit limit = {}, std::size_t capacity = DEFAULT_CAPACITY);
+
+    bool enabled() const noexcept { return m_slots != nullptr; }
+
+    // Spends one token of `key`'s bucket; false when it is empty. Always true when disabled.
+    bool tryAcquire(std::uint64_t key, Clock::time_point now = Clock::now()) noexcept;
+
+    // Non-zero table key for a token or an address.
+    static std::uint64_t keyFor(std::string_view bytes) noexcept;
+
+  private:
+    struct Slot
+    {
+      std::atomic<std::uint64_t> key{ 0 };
+      std::atomic<std::uint64_t> fullAtNs{ 0 };
+    };
+
+  private:
+    std::uint64_t m_intervalNs{ 0 };  // time one token takes to refill
+    std::uint64_t m_burstNs{ 0 };     // how far ahead of now a bucket's refill time may run
+    std::size_t m_mask{ 0 };
+    std::unique_ptr<Slot[]> m_slots;
+  };
+
+}  // namespace server
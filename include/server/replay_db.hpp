@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "server/game_record.hpp"
+#include "server/mapped_file.hpp"
+
+namespace server
+{
+  // Filter over the side index. Unset fields match everything; ranges are inclusive.
+  struct ReplayQuery
+  {
+    std::optional<std::uint64_t> playerHash;  // either player, codec::fnv1a64 of the token
+    std::int64_t finishedFromMs{ std::numeric_limits<std::int64_t>::min() };
+    std::int64_t finishedToMs{ std::numeric_limits<std::int64_t>::max() };
+    std::optional<std::uint8_t> winner;  // 1 or 2
+    std::uint16_t minShots{ 0 };
+    std::uint16_t maxShots{ std::numeric_limits<std::uint16_t>::max() };
+  };
+
+  struct ShotHeatmap
+  {
+    std::uint64_t games{ 0 };
+    std::array<std::uint64_t, battleship::BOARD_SIZE * battleship::BOARD_SIZE> shots{};
+    std::array<std::uint64_t, battleship::BOARD_SIZE * battleship::BOARD_SIZE> hits{};
+  };
+
+  // Read-only analytics over the segment files written by GameRecorder.
+  //
+  // Every segment is mmapped and scanned once on open (in parallel, checksums verified) to build a columnar side
+  // index: player hashes, finish time, winner, game length and the record's location. Queries filter the
+  // columns and hand matching records to workers as zero-copy GameRecordViews, so scans never materialise a
+  // GameRecord or a Board. A segment's torn tail is ignored.
+  class ReplayDb
+  {
+  public:
+    explicit ReplayDb(const std::string& directory, unsigned threads = 0);
+
+    std::size_t size() const noexcept { return m_location.size(); }
+    std::size_t segmentCount() const noexcept { return m_segments.size(); }
+    unsigned workerCount() const noexcept { return m_threads; }
+
+    GameRecordView view(std::size_t index) const;
+
+    // Indices of the matching records, in index order.
+    std::vector<std::size_t> select(const ReplayQuery& query) const;
+
+    // Calls fn(worker, view) for every matching record across workerCount() threads. fn must only touch
+    // state owned by its worker index; results are typically reduced after the call returns.
+    void scan(const ReplayQuery& query, const std::function<void(unsigned, const GameRecordView&)>& fn) const;
+
+    ShotHeatmap shotHeatmap(const ReplayQuery& query) const;
+
+  private:
+    bool matches(std::size_t i, const ReplayQuery& query) const noexcept;
+
+  private:
+    struct Location
+    {
+      std::uint32_t segment;
+      std::uint32_t size;
+      std::uint64_t offset;
+    };
+
+    unsigned m_threads;
+    std::vector<MappedFile> m_segments;
+
+    std::vector<Location> m_location;
+    std::vector<std::array<std::uint64_t, 2>> m_players;
+    std::vector<std::int64_t> m_finishedAt;
+    std::vector<std::uint8_t> m_winner;
+    std::vector<std::uint16_t> m_shotCount;
+  };
+
+}  // namespace server
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "server/route_table.hpp"
+
+namespace server
+{
+  // Pipeline stages of one request, in the order they run.
+  enum class TraceStage : std::uint8_t
+  {
+    Read,       // request bytes off the socket, from the first byte being available
+    Route,      // split_path + match_route
+    Auth,       // bearer token lookup
+    Parse,      // JSON body
+    Store,      // validation and the GameStore call
+    Serialize,  // response body and headers
+    Write       // response bytes onto the socket
+  };
+
+  inline constexpr std::size_t TRACE_STAGE_COUNT = static_cast<std::size_t>(TraceStage::Write) + 1;
+
+  const char* to_cstr(TraceStage stage) noexcept;
+
+  // Timestamps of one request. Each mark() charges the time since the previous mark to the stage that just
+  // ended, so a request costs one clock read per stage and no allocation.
+  struct RequestTrace
+  {
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t id{ 0 };
+    RouteId route{ RouteId::NotFound };
+    unsigned status{ 0 };
+    Clock::time_point start{};
+    Clock::time_point last{};
+    std::array<std::uint64_t, TRACE_STAGE_COUNT> stageNs{};
+
+    void begin() noexcept
+    {
+      start = last = Clock::now();
+      stageNs = {};
+      route = RouteId::NotFound;
+      status = 0;
+    }
+
+    void mark(TraceStage stage) noexcept
+    {
+      const auto now = Clock::now();
+      stageNs[static_cast<std::size_t>(stage)] +=
+          static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+      last = now;
+    }
+
+    std::uint64_t totalNs() const noexcept
+    {
+      return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(last - start).count());
+    }
+  };
+
+  // Collects finished traces: every one feeds the per-stage histograms in metrics(), and those slower than the
+  // threshold are kept in a fixed ring of the most recent CAPACITY for export as Chrome trace-event JSON
+  // (chrome://tracing, Perfetto).
+  class RequestTracer
+  {
+  public:
+    static constexpr std::size_t CAPACITY = 256;
+    static constexpr std::chrono::milliseconds DEFAULT_SLOW_THRESHOLD{ 10 };
+
+    RequestTracer();
+
+    bool enabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) noexcept { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    void setSlowThreshold(std::chrono::nanoseconds threshold) noexcept;
+
+    void finish(const RequestTrace& trace);
+
+    // Slow traces currently held, oldest first.
+    std::vector<RequestTrace> recent() const;
+
+    // {"traceEvents":[...]} with one complete event per slow request and one per non-empty stage inside it.
+    void writeChromeTrace(std::string& out) const;
+
+  private:
+    std::atomic<bool> m_enabled{ true };
+    std::atomic<std::uint64_t> m_slowThresholdNs;
+    const RequestTrace::Clock::time_point m_origin;
+
+    mutable std::mutex m_mu;
+    std::vector<RequestTrace> m_ring;
+    std::size_t m_next{ 0 };
+    std::uint64_t m_recorded{ 0 };
+  };
+
+  RequestTracer& tracer();
+
+}  // namespace server
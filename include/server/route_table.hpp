@@ -0,0 +1,65 @@
+#pragma once
+
+#include <boost/beast/http.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace server
+{
+  namespace http = boost::beast::http;
+
+  enum class RouteId : std::uint8_t
+  {
+    CreateGame,
+    ListGames,
+    JoinGame,
+    GetGame,
+    PlaceShip,
+    PlaceFleet,
+    PlaceRandomFleet,
+    ReadyUp,
+    Shoot,
+    GetHistory,
+    Spectate,
+    Matchmake,
+    GetMatch,
+    Metrics,
+    DebugTraces,
+    NotFound
+  };
+
+  inline constexpr std::size_t ROUTE_COUNT = static_cast<std::size_t>(RouteId::NotFound) + 1;
+
+  const char* to_cstr(RouteId id) noexcept;
+
+  // Path segments of a request target, viewing into the original string. The query string is dropped.
+  struct PathSegments
+  {
+    static constexpr std::size_t CAPACITY = 8;
+
+    std::array<std::string_view, CAPACITY> parts{};
+    std::size_t count{ 0 };
+    bool overflow{ false };  // more than CAPACITY segments; never matches a route
+  };
+
+  PathSegments split_path(std::string_view target) noexcept;
+
+  struct RouteMatch
+  {
+    RouteId id{ RouteId::NotFound };
+    bool requiresAuth{ false };
+    std::string_view gameId;  // the captured {id} segment (a matchmaking ticket under /matchmaking), empty when none
+  };
+
+  // Resolves method + target against the static route table. Never allocates; the cost does not grow with
+  // the number of routes, only with the number of distinct {id} positions among them.
+  RouteMatch match_route(http::verb method, std::string_view target) noexcept;
+
+  // Value of `name` in the target's query string, if present; empty when it has no '='.
+  std::optional<std::string_view> query_param(std::string_view target, std::string_view name) noexcept;
+
+}  // namespace server
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "server/cluster.hpp"
+#include "server/rate_limiter.hpp"
+#include "server/spectator_hub.hpp"
+
+#include "project/core/result.hpp"
+
+namespace server
+{
+  // Runtime tunables of HttpServer and UringServer; ClusterProxy reads the listening, drain and cluster fields.
+  // Every field has a command-line flag and a BATTLESHIP_* environment variable (see serverUsage()); a flag
+  // overrides the environment, which overrides the default.
+  struct ServerConfig
+  {
+    static constexpr int DEFAULT_BACKLOG = 1024;
+
+    std::string address{ "0.0.0.0" };
+    std::uint16_t port{ 8080 };
+    unsigned ioThreads{ 1 };                       // threads running the event loop
+    bool pinThreads{ false };                      // pin I/O thread i to CPU i modulo the CPU count (Linux only)
+    bool reusePort{ false };                       // SO_REUSEPORT, so several processes can share the port
+    int backlog{ DEFAULT_BACKLOG };                // pending-connection queue passed to listen()
+    std::chrono::seconds keepAliveTimeout{ 30 };   // idle or stalled connections are closed after this long
+    std::size_t maxConnections{ 0 };               // 0 is unlimited; at the limit, accepting pauses
+    std::chrono::seconds drainTimeout{ 10 };       // how long in-flight requests get to finish after SIGTERM
+    std::size_t maxInFlight{ 0 };                  // 0 is unlimited; polls are shed at half, setup at 3/4 (503)
+    std::size_t maxInFlightPerToken{ 0 };          // 0 is unlimited; requests per Authorization token (429)
+    RateLimit tokenRate{};                         // requests per second per Authorization token (429)
+    RateLimit clientRate{};                        // requests per second per client IP address (429)
+    std::size_t gameShards{ 0 };                   // GameStore shards; 0 is 1, or 4 per I/O thread with gameActors
+    bool gameActors{ false };                      // run each shard's games on its own strand (Asio backend)
+    bool ioUring{ false };                         // serve with UringServer where it is supported
+    std::size_t matchTickets{ 16384 };             // players queued or matched at once; 0 disables /matchmaking
+    std::chrono::seconds matchTimeout{ 30 };       // a ticket not polled for this long is dropped
+    SpectatorPolicy spectators{ SpectatorPolicy::Hidden };  // what GET /games/{id}/spectate shows; Off disables it
+    std::string walPath;                           // event log replayed at startup; empty runs without one
+    std::chrono::milliseconds commitInterval{ 5 }; // how long appended events may wait for their fdatasync
+    std::string snapshotPath;                      // restored at startup and rewritten periodically; empty for none
+    std::chrono::seconds snapshotInterval{ 60 };
+    std::string recordDir;                         // finished games are archived here; empty for none
+    std::vector<ClusterNode> clusterNodes;         // every node of a multi-process deployment, in node order
+    unsigned nodeIndex{ 0 };                       // this process's place in clusterNodes
+  };
+
+  using EnvLookup = const char* (*)(const char*);
+
+  // The defaults, then BATTLESHIP_* variables read through `env` (std::getenv when null), then `--flag value`
+  // arguments. The error names the offending flag or variable.
+  battleship::Expected<ServerConfig, std::string> parseServerConfig(int argc,
+                                                                    const char* const* argv,
+                                                                    EnvLookup env = nullptr);
+
+  std::string serverUsage(const char* argv0);
+
+  // Pins the calling thread to CPU `index` modulo the CPU count, as ServerConfig::pinThreads asks. Failure, or a
+  // platform without thread affinity, is reported on stderr and otherwise ignored.
+  void pinThreadToCpu(unsigned index);
+
+  // The GameStore shard count `config` asks for, with 0 resolved to its default.
+  std::size_t gameShardCount(const ServerConfig& config) noexcept;
+
+  // The id prefix of the games this node creates; empty outside a cluster.
+  std::string gameIdPrefix(const ServerConfig& config);
+
+}  // namespace server
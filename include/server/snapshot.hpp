@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "server/game_types.hpp"
+
+namespace server
+{
+  class EventLog;
+  class GameStore;
+
+  // Writes a compact binary image of GameStore state.
+  //
+  // Games are encoded (tokens, flags and the game's history record, which the boards are rebuilt from) into
+  // chunks of up to GAMES_PER_CHUNK games, each checksummed, followed by a trailer:
+  //   [chunk]... [{u64 offset, u32 size, u32 games, u32 crc} x N][u32 N][u64 baseSeq][u64 table offset][magic]
+  // Everything goes to "<path>.tmp", which commit() syncs and renames over <path>.
+  class SnapshotWriter
+  {
+  public:
+    static constexpr std::size_t GAMES_PER_CHUNK = 4096;
+
+    explicit SnapshotWriter(std::string path);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void addGame(const GameState& game);
+    // Writes the games added since the last call as one chunk.
+    void endChunk();
+    void commit(std::uint64_t baseSeq);
+
+  private:
+    struct ChunkEntry
+    {
+      std::uint64_t offset;
+      std::uint32_t size;
+      std::uint32_t games;
+      std::uint32_t crc;
+    };
+
+    void write(const std::string& bytes);
+
+  private:
+    std::string m_path;
+    std::string m_tmpPath;
+    int m_fd{ -1 };
+    std::string m_chunk;
+    std::uint32_t m_chunkGames{ 0 };
+    std::uint64_t m_offset{ 0 };
+    std::vector<ChunkEntry> m_table;
+    bool m_committed{ false };
+  };
+
+  struct LoadedSnapshot
+  {
+    std::uint64_t baseSeq{ 0 };
+    std::vector<std::pair<std::string, std::shared_ptr<GameState>>> games;
+  };
+
+  // Maps the snapshot and rebuilds its games, decoding chunks on up to `threads` workers. Returns nullopt when
+  // there is no snapshot or it fails validation.
+  std::optional<LoadedSnapshot> readSnapshot(const std::string& path, unsigned threads = 0);
+
+  struct SnapshotOptions
+  {
+    std::string path;
+    std::chrono::seconds interval{ 60 };
+  };
+
+  // Periodically snapshots the store and then rotates the event log, so startup only replays the events
+  // written since the last snapshot.
+  class Snapshotter
+  {
+  public:
+    Snapshotter(GameStore& store, std::shared_ptr<EventLog> log, SnapshotOptions options);
+    ~Snapshotter();
+
+    Snapshotter(const Snapshotter&) = delete;
+    Snapshotter& operator=(const Snapshotter&) = delete;
+
+    // Returns the number of games written.
+    std::size_t snapshotNow();
+
+  private:
+    void run();
+
+  private:
+    GameStore& m_store;
+    std::shared_ptr<EventLog> m_log;
+    SnapshotOptions m_options;
+
+    std::mutex m_snapshotMu;  // serialises snapshotNow() callers with the periodic thread
+    std::mutex m_mu;
+    std::condition_variable m_wake;
+    bool m_stop{ false };
+    std::thread m_thread;
+  };
+
+}  // namespace server
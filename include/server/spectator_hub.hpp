@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace server
+{
+  // What spectators see of the boards.
+  enum class SpectatorPolicy : std::uint8_t
+  {
+    Off,      // no spectating
+    Hidden,   // hits and misses only; ships are revealed once the game is finished
+    Revealed  // every ship, live
+  };
+
+  const char* to_cstr(SpectatorPolicy policy) noexcept;
+  std::optional<SpectatorPolicy> parseSpectatorPolicy(std::string_view text) noexcept;
+
+  // Response head of a spectator stream: no length, so the frames that follow run until either side closes.
+  inline constexpr std::string_view SPECTATE_RESPONSE_HEADERS = "HTTP/1.1 200 OK\r\n"
+                                                                "Server: BattleShip\r\n"
+                                                                "Content-Type: text/event-stream\r\n"
+                                                                "Cache-Control: no-cache\r\n"
+                                                                "Connection: close\r\n"
+                                                                "\r\n";
+
+  // One serialized update of a game, shared by every connection that sends it.
+  using SpectatorFrame = std::shared_ptr<const std::string>;
+
+  // A spectator connection. deliver() is called from whichever thread published the frame and must not block.
+  // Publishers of one game deliver concurrently, so a viewer drops a frame whose revision is not above the last
+  // one it took.
+  class SpectatorViewer
+  {
+  public:
+    virtual ~SpectatorViewer() = default;
+    virtual void deliver(const SpectatorFrame& frame, std::uint64_t revision) = 0;
+  };
+
+  // Spectators per game, and the last frame published for each watched game.
+  //
+  // A game update is serialized once by its publisher and the same buffer is handed to every viewer; a frame
+  // no newer than one already published for the game is dropped.
+  // Games are spread over SHARDS maps under their own locks, and a store with no spectators at all is
+  // recognised from one atomic load.
+  class SpectatorHub
+  {
+  public:
+    static constexpr std::size_t SHARDS = 16;
+
+    explicit SpectatorHub(SpectatorPolicy policy = SpectatorPolicy::Hidden);
+
+    SpectatorPolicy policy() const noexcept { return m_policy; }
+
+    // Adds a viewer of `gameId`, which then receives every later frame of the game. Returns the last frame
+    // published for the game, or null when there is none yet.
+    SpectatorFrame subscribe(const std::string& gameId, std::weak_ptr<SpectatorViewer> viewer);
+    void unsubscribe(const std::string& gameId, const SpectatorViewer* viewer);
+
+    // Whether `gameId` has viewers; publishers skip serializing when it does not.
+    bool watched(const std::string& gameId) const;
+
+    // Hands `frame`, the state of `gameId` at `revision`, to every viewer of the game unless a frame at least
+    // as recent has gone out already.
+    void publish(const std::string& gameId, std::uint64_t revision, const SpectatorFrame& frame);
+
+    std::size_t viewerCount() const noexcept { return m_viewers.load(std::memory_order_relaxed); }
+
+  private:
+    struct Channel
+    {
+      std::uint64_t revision{ 0 };
+      SpectatorFrame frame;
+      std::vector<std::weak_ptr<SpectatorViewer>> viewers;
+    };
+
+    struct alignas(64) Shard
+    {
+      mutable std::mutex mu;
+      std::unordered_map<std::string, Channel> channels;
+    };
+
+    Shard& shardFor(std::string_view gameId) const noexcept;
+
+  private:
+    const SpectatorPolicy m_policy;
+    std::atomic<std::size_t> m_viewers{ 0 };
+    std::unique_ptr<Shard[]> m_shards;
+  };
+
+}  // namespace server
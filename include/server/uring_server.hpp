@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "server/buffer_pool.hpp"
+#include "server/game_store.hpp"
+#include "server/server_config.hpp"
+
+namespace server
+{
+  class UringRuntime;
+
+  // HTTP/1.1 server on Linux io_uring, serving requests through the same handle_request() as HttpServer and
+  // driven the same way. Each I/O thread owns a ring: accepts, reads and writes are queued as submissions and
+  // handed to the kernel together, one io_uring_enter per batch of completions, which also waits for the next.
+  // Reads and small writes go through buffers registered with the ring once at start-up.
+  //
+  // Only compiled in with BattleShip_ENABLE_IO_URING; use HttpServer when supported() is false.
+  class UringServer
+  {
+  public:
+    // Built with io_uring and the running kernel lets this process create a ring.
+    static bool supported() noexcept;
+
+    explicit UringServer(GameStore& store, ServerConfig config = {});
+    ~UringServer();
+
+    UringServer(const UringServer&) = delete;
+    UringServer& operator=(const UringServer&) = delete;
+
+    // Throws std::system_error when the address cannot be bound or a ring cannot be created, and
+    // std::runtime_error when built without io_uring.
+    void start();
+    void wait();
+    void run();
+    void stop();
+
+    std::uint16_t port() const noexcept { return m_port.load(std::memory_order_acquire); }
+
+  private:
+    GameStore& m_store;
+    ServerConfig m_config;
+    BufferPool m_buffers;
+    std::atomic<std::uint16_t> m_port{ 0 };
+    std::unique_ptr<UringRuntime> m_runtime;
+  };
+
+}  // namespace server
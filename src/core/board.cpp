@@ -8,7 +8,20 @@ namespace battleship
 {
   namespace
   {
-    void advance(Coordinate& c, Orientation o)
+    bool isValidOrientation(Orientation o) noexcept
+    {
+      switch (o)
+      {
+        case Orientation::NORTH:
+        case Orientation::SOUTH:
+        case Orientation::WEST:
+        case Orientation::EAST: return true;
+      }
+      return false;
+    }
+
+    // Callers validate the orientation first; stored placements are always valid.
+    void advance(Coordinate& c, Orientation o) noexcept
     {
       switch (o)
       {
@@ -16,17 +29,31 @@ namespace battleship
         case Orientation::SOUTH: ++c.row; break;
         case Orientation::WEST: --c.col; break;
         case Orientation::EAST: ++c.col; break;
-        default: throw std::invalid_argument{ "Invalid orientation." };
       }
     }
 
+    [[noreturn]] void throwBoardError(BoardError error)
+    {
+      switch (error)
+      {
+        case BoardError::OutOfBounds:
+        case BoardError::CoordinateOutOfBounds: throw OutOfBounds{ to_cstr(error) };
+        case BoardError::Collision: throw Collision{ to_cstr(error) };
+        case BoardError::AlreadyShot: throw AlreadyShot{ to_cstr(error) };
+        case BoardError::UndefinedShot: throw UndefinedShorError{ to_cstr(error) };
+        case BoardError::InvalidOrientation: throw std::invalid_argument{ to_cstr(error) };
+        case BoardError::None: break;
+      }
+      throw Error{ to_cstr(error) };
+    }
+
     bool inBounds(int r, int c) noexcept
     {
       return r >= 0 && r < static_cast<int>(BOARD_SIZE) && c >= 0 && c < static_cast<int>(BOARD_SIZE);
     }
 
     template<typename Fn>
-    bool anyCell(const Structure& structure, const Placement& placement, Fn&& fn)
+    bool anyCell(const Structure& structure, const Placement& placement, Fn&& fn) noexcept
     {
       const auto size{ structure.size() };
       Coordinate c{ placement.coordinate };
@@ -44,10 +71,9 @@ namespace battleship
       return false;
     }
 
-    bool isInsideBoard(const Structure& structure, const Placement& placement)
+    bool isInsideBoard(const Structure& structure, const Placement& placement) noexcept
     {
-      return !anyCell(
-          structure, placement, [](const Coordinate& c) { return c.row >= BOARD_SIZE || c.col >= BOARD_SIZE; });
+      return !anyCell(structure, placement, [](const Coordinate& c) { return !inBounds(c.row, c.col); });
     }
   }  // namespace
 
@@ -66,17 +92,17 @@ namespace battleship
     m_cells.at(static_cast<std::size_t>(coord.row)).at(static_cast<std::size_t>(coord.col)) = cell_view;
   }
 
-  Cell& Board::cellAt(int row, int col)
+  Cell* Board::cellAt(int row, int col) noexcept
   {
     if (!inBounds(row, col))
     {
-      throw OutOfBounds{ "Coordinate is out of board bounds." };
+      return nullptr;
     }
 
-    return m_cells[static_cast<std::size_t>(row)][static_cast<std::size_t>(col)];
+    return &m_cells[static_cast<std::size_t>(row)][static_cast<std::size_t>(col)];
   }
 
-  bool Board::checkCollision(const Structure& structure, const Placement& placement)
+  bool Board::checkCollision(const Structure& structure, const Placement& placement) noexcept
   {
     auto touchesOccupied = [&](const Coordinate& c) -> bool
     {
@@ -109,20 +135,62 @@ namespace battleship
     m_structuresStartPositions.emplace_back(structure.clone(), placement);
   }
 
-  void Board::placeStructure(const Structure& structure, const Placement& placement)
+  BoardError Board::tryPlaceStructure(const Structure& structure, const Placement& placement)
   {
+    if (!isValidOrientation(placement.orientation))
+    {
+      return BoardError::InvalidOrientation;
+    }
+
     if (!isInsideBoard(structure, placement))
     {
-      throw OutOfBounds{ "Structure placement is out of board bounds." };
+      return BoardError::OutOfBounds;
     }
 
     if (checkCollision(structure, placement))
     {
-      throw Collision{ "Structure placement collides with existing structures." };
+      return BoardError::Collision;
     }
 
     markStructureOnBoard(structure, placement);
     addStructureStartPosition(structure, placement);
+    return BoardError::None;
+  }
+
+  void Board::placeStructure(const Structure& structure, const Placement& placement)
+  {
+    if (const auto error = tryPlaceStructure(structure, placement); error != BoardError::None)
+    {
+      throwBoardError(error);
+    }
+  }
+
+  BoardError Board::tryPlaceFleet(const std::vector<FleetPlacement>& fleet)
+  {
+    const auto saved_cells = m_cells;
+    const auto saved_count = m_structuresStartPositions.size();
+
+    for (const auto& entry : fleet)
+    {
+      if (const auto error = tryPlaceStructure(Boat{ entry.type }, entry.placement); error != BoardError::None)
+      {
+        m_cells = saved_cells;
+        m_structuresStartPositions.erase(
+            m_structuresStartPositions.begin() + static_cast<std::ptrdiff_t>(saved_count),
+            m_structuresStartPositions.end());
+        return error;
+      }
+    }
+
+    return BoardError::None;
+  }
+
+  void Board::placeFleet(const std::vector<FleetPlacement>& fleet)
+  {
+    if (const auto error = tryPlaceFleet(fleet); error != BoardError::None)
+    {
+      throwBoardError(error);
+    }
   }
 
   void Board::markStructureOnBoard(const Structure& structure, const Placement& placement) noexcept
@@ -137,7 +205,7 @@ namespace battleship
         });
   }
 
-  Structure& Board::findStructureAt(const Coordinate& coord)
+  Structure* Board::findStructureAt(const Coordinate& coord) noexcept
   {
     for (auto& [structure, placement] : m_structuresStartPositions)
     {
@@ -147,34 +215,53 @@ namespace battleship
       {
         if (c.row == coord.row && c.col == coord.col)
         {
-          return *structure;
+          return structure.get();
         }
 
         advance(c, placement.orientation);
       }
     }
 
-    throw UndefinedShorError{ "Shot in occupied cell does not correspond to any structure." };
+    return nullptr;
   }
 
-  void Board::handle_shot(const Coordinate& coord)
+  Expected<CellState, BoardError> Board::tryHandleShot(const Coordinate& coord)
   {
-    auto& hit_cell = cellAt(coord.row, coord.col).cell_state;
+    Cell* cell = cellAt(coord.row, coord.col);
+    if (cell == nullptr)
+    {
+      return unexpected(BoardError::CoordinateOutOfBounds);
+    }
+
+    auto& hit_cell = cell->cell_state;
 
     if (hit_cell == CellState::HIT || hit_cell == CellState::MISS)
     {
-      throw AlreadyShot{ "Cell has already been shot." };
+      return unexpected(BoardError::AlreadyShot);
     }
 
     if (hit_cell == CellState::EMPTY)
     {
       hit_cell = CellState::MISS;
+      return CellState::MISS;
+    }
+
+    Structure* structure = findStructureAt(coord);
+    if (structure == nullptr)
+    {
+      return unexpected(BoardError::UndefinedShot);
     }
 
-    if (hit_cell == CellState::OCCUPIED)
+    structure->hit();
+    hit_cell = CellState::HIT;
+    return CellState::HIT;
+  }
+
+  void Board::handle_shot(const Coordinate& coord)
+  {
+    if (const auto result = tryHandleShot(coord); !result)
     {
-      findStructureAt(coord).hit();
-      hit_cell = CellState::HIT;
+      throwBoardError(result.error());
     }
   }
 
@@ -191,6 +278,25 @@ namespace battleship
     return true;
   }
 
+  std::size_t Board::structureCount() const noexcept
+  {
+    return m_structuresStartPositions.size();
+  }
+
+  std::vector<FleetPlacement> Board::placedBoats() const
+  {
+    std::vector<FleetPlacement> boats;
+    boats.reserve(m_structuresStartPositions.size());
+    for (const auto& [structure, placement] : m_structuresStartPositions)
+    {
+      if (structure->type() == StructureType::BOAT)
+      {
+        boats.push_back(FleetPlacement{ static_cast<const Boat&>(*structure).getType(), placement });
+      }
+    }
+    return boats;
+  }
+
   void Board::reset()
   {
     m_cells = make_empty_cels();
@@ -0,0 +1,147 @@
+#include "project/core/fleetGenerator.hpp"
+
+#include <bitset>
+#include <cstddef>
+#include <stdexcept>
+
+namespace battleship
+{
+  namespace
+  {
+    constexpr int SIDE = BOARD_SIZE;
+    constexpr std::size_t CELL_COUNT = static_cast<std::size_t>(SIDE) * SIDE;
+    constexpr int MAX_ATTEMPTS = 64;
+
+    using CellMask = std::bitset<CELL_COUNT>;
+
+    constexpr std::size_t indexOf(int row, int col) noexcept
+    {
+      return static_cast<std::size_t>(row * SIDE + col);
+    }
+
+    std::uint8_t sizeOf(BoatType type)
+    {
+      return Boat{ type }.size();
+    }
+
+    // Blocks a cell together with its eight neighbours, mirroring the
+    // "no touching boats" rule enforced by Board::checkCollision.
+    void blockAround(CellMask& mask, int row, int col) noexcept
+    {
+      for (int r = row - 1; r <= row + 1; ++r)
+      {
+        for (int c = col - 1; c <= col + 1; ++c)
+        {
+          if (r >= 0 && r < SIDE && c >= 0 && c < SIDE)
+          {
+            mask.set(indexOf(r, c));
+          }
+        }
+      }
+    }
+
+    CellMask blockedCells(const Board& board)
+    {
+      CellMask mask;
+      for (int r = 0; r < SIDE; ++r)
+      {
+        for (int c = 0; c < SIDE; ++c)
+        {
+          if (board.getCellView(Coordinate{ r, c }).cell_state != CellState::EMPTY)
+          {
+            blockAround(mask, r, c);
+          }
+        }
+      }
+      return mask;
+    }
+
+    bool fits(const CellMask& blocked, int row, int col, Orientation o, int size) noexcept
+    {
+      for (int i = 0; i < size; ++i)
+      {
+        const int r = (o == Orientation::SOUTH) ? row + i : row;
+        const int c = (o == Orientation::EAST) ? col + i : col;
+        if (r >= SIDE || c >= SIDE || blocked.test(indexOf(r, c)))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    struct Candidate
+    {
+      std::uint8_t row{};
+      std::uint8_t col{};
+      Orientation orientation{ Orientation::EAST };
+    };
+
+    // EAST/SOUTH starts already cover every horizontal and vertical segment,
+    // so NORTH/WEST would only duplicate candidates.
+    constexpr std::array<Orientation, 2> ORIENTATIONS{ Orientation::EAST, Orientation::SOUTH };
+  }  // namespace
+
+  std::vector<FleetPlacement> generateRandomFleet(const Board& board, std::span<const BoatType> fleet, std::mt19937& rng)
+  {
+    const CellMask initial = blockedCells(board);
+
+    std::vector<FleetPlacement> placements;
+    placements.reserve(fleet.size());
+
+    std::array<Candidate, CELL_COUNT * ORIENTATIONS.size()> candidates{};
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
+    {
+      CellMask blocked = initial;
+      placements.clear();
+
+      for (const BoatType type : fleet)
+      {
+        const int size = sizeOf(type);
+
+        std::size_t count = 0;
+        for (const Orientation o : ORIENTATIONS)
+        {
+          for (int r = 0; r < SIDE; ++r)
+          {
+            for (int c = 0; c < SIDE; ++c)
+            {
+              if (fits(blocked, r, c, o, size))
+              {
+                candidates[count++] =
+                    Candidate{ .row = static_cast<std::uint8_t>(r), .col = static_cast<std::uint8_t>(c), .orientation = o };
+              }
+            }
+          }
+        }
+
+        if (count == 0)
+        {
+          break;
+        }
+
+        std::uniform_int_distribution<std::size_t> pick(0, count - 1);
+        const Candidate chosen = candidates[pick(rng)];
+
+        for (int i = 0; i < size; ++i)
+        {
+          const int r = chosen.row + (chosen.orientation == Orientation::SOUTH ? i : 0);
+          const int c = chosen.col + (chosen.orientation == Orientation::EAST ? i : 0);
+          blockAround(blocked, r, c);
+        }
+
+        placements.push_back(FleetPlacement{
+            .type = type, .placement = Placement{ Coordinate{ chosen.row, chosen.col }, chosen.orientation } });
+      }
+
+      if (placements.size() == fleet.size())
+      {
+        return placements;
+      }
+    }
+
+    throw std::runtime_error("Unable to place fleet.");
+  }
+
+}  // namespace battleship
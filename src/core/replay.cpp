@@ -0,0 +1,140 @@
+#include "project/core/replay.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace battleship
+{
+  namespace
+  {
+    BoardCells cellsOf(const Board& board)
+    {
+      BoardCells cells{};
+      for (int r = 0; r < BOARD_SIZE; ++r)
+      {
+        for (int c = 0; c < BOARD_SIZE; ++c)
+        {
+          cells[static_cast<std::size_t>(r)][static_cast<std::size_t>(c)] =
+              board.getCellView(Coordinate{ r, c }).cell_state;
+        }
+      }
+      return cells;
+    }
+
+    bool anyOccupied(const BoardCells& cells) noexcept
+    {
+      return std::any_of(cells.begin(), cells.end(), [](const auto& row) {
+        return std::find(row.begin(), row.end(), CellState::OCCUPIED) != row.end();
+      });
+    }
+  }  // namespace
+
+  Replay::Replay(const std::array<std::vector<FleetPlacement>, 2>& fleets,
+                 std::vector<ReplayMove> moves,
+                 std::size_t checkpointInterval)
+      : m_moves(std::move(moves)),
+        m_interval(std::max<std::size_t>(checkpointInterval, 1))
+  {
+    ReplayPosition initial;
+    for (std::size_t p = 0; p < 2; ++p)
+    {
+      Board board;
+      board.placeFleet(fleets[p]);
+      initial.boards[p] = cellsOf(board);
+    }
+
+    m_checkpoints.reserve(m_moves.size() / m_interval + 1);
+    m_checkpoints.push_back(initial);
+    m_results.reserve(m_moves.size());
+  }
+
+  std::size_t Replay::moveCount() const noexcept
+  {
+    return m_moves.size();
+  }
+
+  std::size_t Replay::checkpointCount() const noexcept
+  {
+    return m_checkpoints.size();
+  }
+
+  ReplayPosition Replay::positionAt(std::size_t move)
+  {
+    if (move > m_moves.size())
+    {
+      throw std::out_of_range("Move is past the end of the game.");
+    }
+
+    extendCheckpoints(move);
+    ReplayPosition position = m_checkpoints[move / m_interval];
+    while (position.move < move)
+    {
+      apply(position, m_moves[position.move]);
+    }
+    return position;
+  }
+
+  CellState Replay::resultOf(std::size_t index)
+  {
+    if (index >= m_moves.size())
+    {
+      throw std::out_of_range("Move is past the end of the game.");
+    }
+
+    extendCheckpoints(index + 1);
+    return m_results[index];
+  }
+
+  void Replay::extendCheckpoints(std::size_t move)
+  {
+    if (m_results.size() >= move)
+    {
+      return;
+    }
+
+    ReplayPosition position = m_checkpoints.back();
+    while (position.move < move)
+    {
+      const std::size_t index = position.move;
+      const CellState result = apply(position, m_moves[index]);
+      if (index == m_results.size())
+      {
+        m_results.push_back(result);
+      }
+      if (position.move % m_interval == 0)
+      {
+        m_checkpoints.push_back(position);
+      }
+    }
+  }
+
+  CellState Replay::apply(ReplayPosition& position, const ReplayMove& move) noexcept
+  {
+    ++position.move;
+
+    const auto target = static_cast<std::size_t>(1 - move.player);
+    if (target > 1 || move.target.row < 0 || move.target.row >= BOARD_SIZE || move.target.col < 0 ||
+        move.target.col >= BOARD_SIZE)
+    {
+      return CellState::MISS;
+    }
+
+    auto& cells = position.boards[target];
+    auto& cell = cells[static_cast<std::size_t>(move.target.row)][static_cast<std::size_t>(move.target.col)];
+    switch (cell)
+    {
+      case CellState::OCCUPIED:
+        cell = CellState::HIT;
+        if (position.winner < 0 && !anyOccupied(cells))
+        {
+          position.winner = move.player;
+        }
+        return CellState::HIT;
+      case CellState::EMPTY: cell = CellState::MISS; return CellState::MISS;
+      case CellState::HIT:
+      case CellState::MISS: break;
+    }
+    return CellState::MISS;
+  }
+}  // namespace battleship
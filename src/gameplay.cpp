@@ -2,6 +2,8 @@
 
 #include <stdexcept>
 
+#include "project/core/fleetGenerator.hpp"
+
 namespace battleship
 {
   namespace
@@ -118,6 +120,19 @@ namespace battleship
     placeBoat(currentPlayerId(), type, placement);
   }
 
+  std::vector<FleetPlacement> GamePlay::placeRandomFleet(int player_id, std::mt19937& rng)
+  {
+    if (isGameOver())
+    {
+      throw std::logic_error{ "Game is over." };
+    }
+
+    Board& board = playerById(player_id).board();
+    auto fleet = generateRandomFleet(board, rng);
+    board.placeFleet(fleet);
+    return fleet;
+  }
+
   CellState GamePlay::shoot(const Coordinate& target)
   {
     return shoot(currentPlayerId(), target);
@@ -0,0 +1,126 @@
+#include "server/admission.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace server
+{
+  RequestPriority priorityOf(RouteId route) noexcept
+  {
+    switch (route)
+    {
+      case RouteId::ListGames:
+      case RouteId::GetGame:
+      case RouteId::GetHistory:
+      case RouteId::GetMatch: return RequestPriority::Poll;
+      case RouteId::Shoot: return RequestPriority::Move;
+      default: return RequestPriority::Setup;
+    }
+  }
+
+  AdmissionTicket::AdmissionTicket(AdmissionTicket&& other) noexcept
+      : m_control(std::exchange(other.m_control, nullptr)),
+        m_client(other.m_client),
+        m_tokenSlot(std::exchange(other.m_tokenSlot, nullptr))
+  {
+  }
+
+  AdmissionTicket& AdmissionTicket::operator=(AdmissionTicket&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      m_control = std::exchange(other.m_control, nullptr);
+      m_client = other.m_client;
+      m_tokenSlot = std::exchange(other.m_tokenSlot, nullptr);
+    }
+    return *this;
+  }
+
+  Admission AdmissionTicket::admit(RequestPriority priority, std::string_view token) noexcept
+  {
+    if (m_control == nullptr)
+    {
+      return Admission::Admitted;
+    }
+    if (m_client != 0 && !m_control->m_clientRate.tryAcquire(m_client))
+    {
+      return Admission::RateLimited;
+    }
+    if (!token.empty() && !m_control->m_tokenRate.tryAcquire(RateLimiter::keyFor(token)))
+    {
+      return Admission::RateLimited;
+    }
+    if (m_control->inFlight() > m_control->limitFor(priority))
+    {
+      return Admission::Overloaded;
+    }
+    if (m_control->m_maxInFlightPerToken == 0 || token.empty() || m_tokenSlot != nullptr)
+    {
+      return Admission::Admitted;
+    }
+
+    auto& slot = m_control->tokenSlot(token);
+    if (slot.fetch_add(1, std::memory_order_relaxed) >= m_control->m_maxInFlightPerToken)
+    {
+      slot.fetch_sub(1, std::memory_order_relaxed);
+      return Admission::TooManyForToken;
+    }
+    m_tokenSlot = &slot;
+    return Admission::Admitted;
+  }
+
+  void AdmissionTicket::reset() noexcept
+  {
+    if (m_tokenSlot != nullptr)
+    {
+      m_tokenSlot->fetch_sub(1, std::memory_order_relaxed);
+      m_tokenSlot = nullptr;
+    }
+    if (m_control != nullptr)
+    {
+      m_control->leave();
+      m_control = nullptr;
+    }
+  }
+
+  AdmissionControl::AdmissionControl(std::size_t maxInFlight,
+                                     std::size_t maxInFlightPerToken,
+                                     RateLimit perToken,
+                                     RateLimit perClient)
+      : m_maxInFlight(maxInFlight),
+        m_maxInFlightPerToken(maxInFlightPerToken),
+        m_tokenRate(perToken),
+        m_clientRate(perClient)
+  {
+  }
+
+  AdmissionTicket AdmissionControl::enter(std::uint64_t client) noexcept
+  {
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    return AdmissionTicket{ *this, client };
+  }
+
+  std::size_t AdmissionControl::limitFor(RequestPriority priority) const noexcept
+  {
+    if (m_maxInFlight == 0)
+    {
+      return SIZE_MAX;
+    }
+    // Polls get half of the limit and setup three quarters; moves may use all of it.
+    switch (priority)
+    {
+      case RequestPriority::Poll: return std::max<std::size_t>(1, m_maxInFlight / 2);
+      case RequestPriority::Setup: return std::max<std::size_t>(1, m_maxInFlight * 3 / 4);
+      case RequestPriority::Move: break;
+    }
+    return m_maxInFlight;
+  }
+
+  std::atomic<std::uint32_t>& AdmissionControl::tokenSlot(std::string_view token) noexcept
+  {
+    return m_tokens[std::hash<std::string_view>{}(token) % TOKEN_SLOTS];
+  }
+
+}  // namespace server
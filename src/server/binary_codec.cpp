@@ -0,0 +1,37 @@
+#include "server/binary_codec.hpp"
+
+#include <array>
+
+namespace server::codec
+{
+  namespace
+  {
+    constexpr std::array<std::uint32_t, 256> makeCrcTable()
+    {
+      std::array<std::uint32_t, 256> table{};
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+        {
+          c = (c & 1U) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+      }
+      return table;
+    }
+
+    constexpr auto CRC_TABLE = makeCrcTable();
+  }  // namespace
+
+  std::uint32_t crc32(const char* data, std::size_t n) noexcept
+  {
+    std::uint32_t c = 0xFFFFFFFFU;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      c = CRC_TABLE[(c ^ static_cast<std::uint8_t>(data[i])) & 0xFFU] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFU;
+  }
+
+}  // namespace server::codec
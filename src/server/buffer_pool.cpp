@@ -0,0 +1,53 @@
+#include "server/buffer_pool.hpp"
+
+#include <utility>
+
+namespace server
+{
+  BufferPool::BufferPool(std::size_t maxBuffers, std::size_t maxCapacity)
+      : m_maxBuffers(maxBuffers),
+        m_maxCapacity(maxCapacity)
+  {
+    m_free.reserve(maxBuffers);
+  }
+
+  std::string BufferPool::acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mu);
+      if (!m_free.empty())
+      {
+        std::string buffer = std::move(m_free.back());
+        m_free.pop_back();
+        return buffer;
+      }
+    }
+
+    std::string buffer;
+    buffer.reserve(INITIAL_CAPACITY);
+    return buffer;
+  }
+
+  void BufferPool::release(std::string&& buffer)
+  {
+    if (buffer.capacity() > m_maxCapacity)
+    {
+      return;
+    }
+
+    buffer.clear();
+
+    std::lock_guard<std::mutex> lk(m_mu);
+    if (m_free.size() < m_maxBuffers)
+    {
+      m_free.push_back(std::move(buffer));
+    }
+  }
+
+  std::size_t BufferPool::size() const
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    return m_free.size();
+  }
+
+}  // namespace server
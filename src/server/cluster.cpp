@@ -0,0 +1,65 @@
+#include "server/cluster.hpp"
+
+#include <charconv>
+#include <utility>
+
+namespace server
+{
+  battleship::Expected<std::vector<ClusterNode>, std::string> parseClusterNodes(std::string_view list)
+  {
+    std::vector<ClusterNode> nodes;
+    while (!list.empty())
+    {
+      const auto comma = list.find(',');
+      const auto entry = list.substr(0, comma);
+      list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+      const auto colon = entry.rfind(':');
+      ClusterNode node;
+      if (colon == std::string_view::npos || colon == 0)
+      {
+        return battleship::unexpected("Expected host:port, got '" + std::string{ entry } + "'");
+      }
+      const auto port = entry.substr(colon + 1);
+      const auto res = std::from_chars(port.data(), port.data() + port.size(), node.port);
+      if (port.empty() || res.ec != std::errc{} || res.ptr != port.data() + port.size() || node.port == 0)
+      {
+        return battleship::unexpected("Invalid port in '" + std::string{ entry } + "'");
+      }
+      node.host = entry.substr(0, colon);
+      nodes.push_back(std::move(node));
+    }
+    if (nodes.empty())
+    {
+      return battleship::unexpected(std::string{ "No nodes given" });
+    }
+    return nodes;
+  }
+
+  std::string gameIdPrefix(unsigned node, std::size_t nodeCount)
+  {
+    return nodeCount > 1 ? std::to_string(node) + "-" : std::string{};
+  }
+
+  std::size_t gameOwner(std::string_view gameId, std::size_t nodeCount) noexcept
+  {
+    std::size_t node = 0;
+    const auto res = std::from_chars(gameId.data(), gameId.data() + gameId.size(), node);
+    if (res.ec != std::errc{} || res.ptr == gameId.data() + gameId.size() || *res.ptr != '-' || node >= nodeCount)
+    {
+      return 0;
+    }
+    return node;
+  }
+
+  LobbyCursor splitLobbyCursor(std::uint64_t cursor, std::size_t nodeCount) noexcept
+  {
+    return { .node = cursor % nodeCount, .cursor = cursor / nodeCount };
+  }
+
+  std::uint64_t joinLobbyCursor(const LobbyCursor& cursor, std::size_t nodeCount) noexcept
+  {
+    return cursor.cursor * nodeCount + cursor.node;
+  }
+
+}  // namespace server
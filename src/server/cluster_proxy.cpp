@@ -0,0 +1,696 @@
+#include "server/cluster_proxy.hpp"
+
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http.hpp>
+
+#include <charconv>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "server/cluster.hpp"
+#include "server/route_table.hpp"
+#include "server/spectator_hub.hpp"
+
+namespace server
+{
+  namespace asio = boost::asio;
+  namespace beast = boost::beast;
+  namespace http = boost::beast::http;
+  using tcp = asio::ip::tcp;
+
+  class ProxySession;
+
+  // The event loop, listening socket and I/O threads of a started ClusterProxy, the resolved node addresses, and
+  // the registry of open client sessions that draining walks. Laid out like HttpServer's runtime.
+  class ProxyRuntime
+  {
+  public:
+    explicit ProxyRuntime(const ServerConfig& serverConfig)
+        : config(serverConfig),
+          m_ioc(static_cast<int>(serverConfig.ioThreads)),
+          m_acceptor(asio::make_strand(m_ioc)),
+          m_drainTimer(m_acceptor.get_executor()),
+          m_signals(m_ioc, SIGTERM, SIGINT)
+    {
+    }
+
+    ~ProxyRuntime() { m_stopped.store(true, std::memory_order_release); }
+
+    ProxyRuntime(const ProxyRuntime&) = delete;
+    ProxyRuntime& operator=(const ProxyRuntime&) = delete;
+
+    // Resolves every node, then binds and starts accepting once the loop runs; SIGTERM and SIGINT start a drain.
+    void listen();
+    void runThreads();
+    void join();
+    void stop();
+    void sessionClosed(std::uint64_t id);
+
+    bool draining() const noexcept { return m_draining.load(std::memory_order_acquire); }
+    bool running() const noexcept { return !m_threads.empty(); }
+    std::uint16_t port() const { return m_acceptor.local_endpoint().port(); }
+
+    std::size_t nodeCount() const noexcept { return m_nodes.size(); }
+    const tcp::resolver::results_type& nodeEndpoints(std::size_t node) const { return m_nodes[node]; }
+
+    // The node owning the game or ticket `route` names. Players are only paired within one node's queue, so
+    // every POST /matchmaking goes to node 0; other requests without an id take the nodes in turn.
+    std::size_t nodeFor(const RouteMatch& route) noexcept
+    {
+      if (route.id == RouteId::Matchmake)
+      {
+        return 0;
+      }
+      return route.gameId.empty() ? m_nextNode.fetch_add(1, std::memory_order_relaxed) % m_nodes.size()
+                                  : gameOwner(route.gameId, m_nodes.size());
+    }
+
+    const ServerConfig& config;
+
+  private:
+    void doAccept();
+    void onAccept(const beast::error_code& ec, tcp::socket socket);
+    void beginDrain();
+
+  private:
+    std::vector<tcp::resolver::results_type> m_nodes;
+    std::atomic<std::size_t> m_nextNode{ 0 };
+
+    std::mutex m_sessionsMu;
+    std::unordered_map<std::uint64_t, std::weak_ptr<ProxySession>> m_sessions;
+    std::uint64_t m_nextSessionId{ 0 };
+    std::atomic<std::size_t> m_open{ 0 };
+    std::atomic<bool> m_draining{ false };
+    std::atomic<bool> m_stopped{ false };
+
+    asio::io_context m_ioc;
+    tcp::acceptor m_acceptor;
+    asio::steady_timer m_drainTimer;
+    asio::signal_set m_signals;
+    std::vector<std::thread> m_threads;
+  };
+
+  // One client connection and its connections to the nodes. Every step, upstream ones included, runs on the
+  // client connection's strand.
+  //
+  // A spectator stream the owning node opens is relayed byte for byte until either end closes; the node's
+  // connection is given up afterwards, since the stream ends it.
+  class ProxySession : public std::enable_shared_from_this<ProxySession>
+  {
+  public:
+    ProxySession(tcp::socket&& socket, ProxyRuntime& runtime, std::uint64_t id)
+        : m_stream(std::move(socket)),
+          m_runtime(runtime),
+          m_id(id),
+          m_upstreams(runtime.nodeCount())
+    {
+    }
+
+    ~ProxySession() { m_runtime.sessionClosed(m_id); }
+
+    ProxySession(const ProxySession&) = delete;
+    ProxySession& operator=(const ProxySession&) = delete;
+
+    void start()
+    {
+      asio::dispatch(m_stream.get_executor(), beast::bind_front_handler(&ProxySession::awaitRequest, shared_from_this()));
+    }
+
+    // Called while draining: a connection waiting for its next request is closed now, one inside a request
+    // finishes it first.
+    void closeIfIdle()
+    {
+      asio::post(m_stream.get_executor(), [self = shared_from_this()] {
+        if (self->m_idle)
+        {
+          self->m_stream.cancel();
+        }
+      });
+    }
+
+  private:
+    struct Upstream
+    {
+      explicit Upstream(const tcp::socket::executor_type& executor)
+          : stream(executor)
+      {
+      }
+
+      beast::tcp_stream stream;
+      beast::flat_buffer buffer;
+      bool reused{ false };  // has carried a request already, so the node may have closed it since
+    };
+
+    void awaitRequest()
+    {
+      if (m_runtime.draining())
+      {
+        return close();
+      }
+      m_idle = true;
+      m_req = {};
+      m_stream.expires_after(m_runtime.config.keepAliveTimeout);
+      http::async_read(m_stream, m_buffer, m_req, beast::bind_front_handler(&ProxySession::onRead, shared_from_this()));
+    }
+
+    void onRead(const beast::error_code& ec, std::size_t)
+    {
+      m_idle = false;
+      if (ec)
+      {
+        return close();
+      }
+      const auto target = m_req.target();
+      const auto route = match_route(m_req.method(), std::string_view{ target.data(), target.size() });
+      m_node = m_runtime.nodeFor(route);
+      m_listing = false;
+      if (route.id == RouteId::ListGames)
+      {
+        routeLobbyPage();
+      }
+      m_spectate = route.id == RouteId::Spectate;
+      m_keepAlive = m_req.keep_alive();
+      m_req.keep_alive(true);
+      m_retried = false;
+      forward();
+    }
+
+    // Sends a lobby page to the node its cursor names, carrying that node's own cursor (see splitLobbyCursor()).
+    // A cursor that does not parse goes to node 0 as it is, to be rejected there.
+    void routeLobbyPage()
+    {
+      const auto raw = m_req.target();
+      const std::string_view target{ raw.data(), raw.size() };
+      const auto param = query_param(target, "cursor");
+      std::uint64_t cursor = 0;
+      if (param.has_value())
+      {
+        const auto [end, ec] = std::from_chars(param->data(), param->data() + param->size(), cursor);
+        if (ec != std::errc{} || end != param->data() + param->size())
+        {
+          m_node = 0;
+          return;
+        }
+      }
+
+      const auto page = splitLobbyCursor(cursor, m_runtime.nodeCount());
+      m_node = page.node;
+      m_listing = true;
+      if (param.has_value())
+      {
+        const auto at = static_cast<std::size_t>(param->data() - target.data());
+        std::string rewritten{ target.substr(0, at) };
+        rewritten += std::to_string(page.cursor);
+        rewritten += target.substr(at + param->size());
+        m_req.target(rewritten);
+      }
+    }
+
+    // Turns the node's nextCursor in a lobby page into the router's, or adds one leading on to the next node
+    // once this node's lobby is exhausted.
+    void relabelLobbyCursor()
+    {
+      constexpr std::string_view FIELD = "\"nextCursor\":\"";
+      auto& body = m_res.body();
+      const auto nodes = m_runtime.nodeCount();
+      if (const auto at = body.find(FIELD); at != std::string::npos)
+      {
+        const auto begin = at + FIELD.size();
+        const auto end = body.find('"', begin);
+        std::uint64_t next = 0;
+        std::from_chars(body.data() + begin, body.data() + end, next);
+        body.replace(begin, end - begin, std::to_string(joinLobbyCursor({ .node = m_node, .cursor = next }, nodes)));
+      }
+      else if (m_node + 1 < nodes)
+      {
+        const auto close = body.rfind('}');
+        if (close == std::string::npos)
+        {
+          return;
+        }
+        body.insert(close, ",\"nextCursor\":\"" + std::to_string(joinLobbyCursor({ .node = m_node + 1 }, nodes)) + "\"");
+      }
+      m_res.prepare_payload();
+    }
+
+    Upstream& upstream()
+    {
+      auto& slot = m_upstreams[m_node];
+      if (slot == nullptr)
+      {
+        slot = std::make_unique<Upstream>(m_stream.get_executor());
+      }
+      return *slot;
+    }
+
+    void forward()
+    {
+      auto& up = upstream();
+      up.stream.expires_after(m_runtime.config.keepAliveTimeout);
+      if (up.stream.socket().is_open())
+      {
+        return send();
+      }
+      up.stream.async_connect(m_runtime.nodeEndpoints(m_node),
+                              [self = shared_from_this()](const beast::error_code& ec, const tcp::endpoint&) {
+                                if (ec)
+                                {
+                                  return self->fail(ec);
+                                }
+                                self->upstream().stream.socket().set_option(tcp::no_delay(true));
+                                self->send();
+                              });
+    }
+
+    void send()
+    {
+      http::async_write(upstream().stream, m_req, [self = shared_from_this()](const beast::error_code& ec, std::size_t) {
+        if (ec)
+        {
+          return self->retryOrFail(ec);
+        }
+        if (self->m_spectate)
+        {
+          return self->readStreamHeader();
+        }
+        self->m_res = {};
+        auto& up = self->upstream();
+        http::async_read(up.stream, up.buffer, self->m_res, [self](const beast::error_code& readEc, std::size_t) {
+          self->onResponse(readEc);
+        });
+      });
+    }
+
+    void onResponse(const beast::error_code& ec)
+    {
+      if (ec)
+      {
+        // A node closing an idle connection shows up as end of stream before any response bytes, or as a reset
+        // once the request reached the closed socket. A reset can also be a node dying halfway through the
+        // request, so only a request that is safe to repeat is sent again after one.
+        if (ec == http::error::end_of_stream || (ec == asio::error::connection_reset && repeatable()))
+        {
+          return retryOrFail(ec);
+        }
+        return fail(ec);
+      }
+      auto& up = upstream();
+      up.reused = true;
+      if (!m_res.keep_alive())
+      {
+        dropUpstream();
+      }
+      if (m_listing && m_res.result() == http::status::ok)
+      {
+        relabelLobbyCursor();
+      }
+      m_res.keep_alive(m_keepAlive && !m_runtime.draining());
+      write();
+    }
+
+    // A spectate request is answered by an open-ended stream when it succeeds and by an ordinary response
+    // otherwise, so only the head is read before deciding.
+    void readStreamHeader()
+    {
+      auto& up = upstream();
+      m_streamParser.emplace();
+      http::async_read_header(up.stream, up.buffer, *m_streamParser,
+                              beast::bind_front_handler(&ProxySession::onStreamHeader, shared_from_this()));
+    }
+
+    void onStreamHeader(const beast::error_code& ec, std::size_t)
+    {
+      if (ec)
+      {
+        return onResponse(ec);
+      }
+      if (m_streamParser->get().result() == http::status::ok && !m_runtime.draining())
+      {
+        return relayStream();
+      }
+      auto& up = upstream();
+      http::async_read(up.stream, up.buffer, *m_streamParser, [self = shared_from_this()](const beast::error_code& readEc, std::size_t) {
+        if (!readEc)
+        {
+          self->m_res = self->m_streamParser->release();
+        }
+        self->m_streamParser.reset();
+        self->onResponse(readEc);
+      });
+    }
+
+    void relayStream()
+    {
+      m_streamParser.reset();
+      m_stream.expires_never();
+      upstream().stream.expires_never();
+      m_idle = true;  // a drain closes the stream
+      asio::async_write(m_stream,
+                        asio::buffer(SPECTATE_RESPONSE_HEADERS.data(), SPECTATE_RESPONSE_HEADERS.size()),
+                        [self = shared_from_this()](const beast::error_code& ec, std::size_t) {
+                          if (ec)
+                          {
+                            return self->endStream();
+                          }
+                          self->relayFrames();
+                        });
+
+      // The client sends nothing more; its read only ends when it hangs up or a drain cancels it.
+      m_buffer.clear();
+      m_stream.async_read_some(m_buffer.prepare(512), [self = shared_from_this()](const beast::error_code&, std::size_t) {
+        self->endStream();
+      });
+    }
+
+    void relayFrames()
+    {
+      auto& up = upstream();
+      if (up.buffer.size() > 0)
+      {
+        asio::async_write(m_stream, up.buffer.data(), [self = shared_from_this()](const beast::error_code& ec, std::size_t bytes) {
+          if (ec)
+          {
+            return self->endStream();
+          }
+          self->upstream().buffer.consume(bytes);
+          self->relayFrames();
+        });
+        return;
+      }
+      up.stream.async_read_some(up.buffer.prepare(4096), [self = shared_from_this()](const beast::error_code& ec, std::size_t bytes) {
+        if (ec)
+        {
+          return self->endStream();
+        }
+        self->upstream().buffer.commit(bytes);
+        self->relayFrames();
+      });
+    }
+
+    void endStream()
+    {
+      if (!m_spectate)
+      {
+        return;
+      }
+      m_spectate = false;
+      dropUpstream();
+      close();
+    }
+
+    bool repeatable() const noexcept
+    {
+      return m_req.method() == http::verb::get || m_req.method() == http::verb::head;
+    }
+
+    void retryOrFail(const beast::error_code& ec)
+    {
+      if (upstream().reused && !m_retried)
+      {
+        m_retried = true;
+        dropUpstream();
+        return forward();
+      }
+      fail(ec);
+    }
+
+    void fail(const beast::error_code& ec)
+    {
+      dropUpstream();
+      const bool timedOut = ec == beast::error::timeout;
+      m_res = {};
+      m_res.result(timedOut ? http::status::gateway_timeout : http::status::bad_gateway);
+      m_res.version(m_req.version());
+      m_res.set(http::field::server, "BattleShip");
+      m_res.set(http::field::content_type, "text/plain");
+      m_res.body() = timedOut ? "Game server timed out" : "Game server unavailable";
+      m_res.keep_alive(m_keepAlive && !m_runtime.draining());
+      m_res.prepare_payload();
+      write();
+    }
+
+    void dropUpstream()
+    {
+      auto& up = upstream();
+      beast::error_code ignored;
+      up.stream.socket().shutdown(tcp::socket::shutdown_both, ignored);
+      up.stream.close();
+      up.buffer.clear();
+      up.reused = false;
+    }
+
+    void write()
+    {
+      m_stream.expires_after(m_runtime.config.keepAliveTimeout);
+      http::async_write(m_stream, m_res, [self = shared_from_this()](const beast::error_code& ec, std::size_t) {
+        if (ec || !self->m_res.keep_alive())
+        {
+          return self->close();
+        }
+        self->awaitRequest();
+      });
+    }
+
+    void close()
+    {
+      beast::error_code ec;
+      m_stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+      m_stream.close();
+    }
+
+  private:
+    beast::tcp_stream m_stream;
+    ProxyRuntime& m_runtime;
+    const std::uint64_t m_id;
+    beast::flat_buffer m_buffer;
+    http::request<http::string_body> m_req;
+    http::response<http::string_body> m_res;
+    std::vector<std::unique_ptr<Upstream>> m_upstreams;  // per node, connected on first use
+    std::size_t m_node{ 0 };
+    bool m_keepAlive{ false };
+    bool m_retried{ false };
+    bool m_idle{ false };
+    bool m_spectate{ false };  // the request is GET /games/{id}/spectate
+    bool m_listing{ false };   // the request is GET /games, whose cursor names a node
+    std::optional<http::response_parser<http::string_body>> m_streamParser;  // the head of its node's answer
+  };
+
+  void ProxyRuntime::listen()
+  {
+    tcp::resolver resolver{ m_ioc };
+    for (const auto& node : config.clusterNodes)
+    {
+      m_nodes.push_back(resolver.resolve(node.host, std::to_string(node.port)));
+    }
+    if (m_nodes.empty())
+    {
+      throw std::invalid_argument{ "ClusterProxy needs at least one node" };
+    }
+
+    const tcp::endpoint endpoint{ asio::ip::make_address(config.address), config.port };
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(asio::socket_base::reuse_address(true));
+    if (config.reusePort)
+    {
+#ifdef SO_REUSEPORT
+      m_acceptor.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#else
+      std::cerr << "SO_REUSEPORT is not available on this platform; ignoring --reuse-port\n";
+#endif
+    }
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen(config.backlog);
+
+    m_signals.async_wait([this](const beast::error_code& ec, int) {
+      if (!ec)
+      {
+        stop();
+      }
+    });
+    asio::post(m_acceptor.get_executor(), [this] { doAccept(); });
+  }
+
+  void ProxyRuntime::runThreads()
+  {
+    for (unsigned i = 0; i < config.ioThreads; ++i)
+    {
+      m_threads.emplace_back([this, i] {
+        if (config.pinThreads)
+        {
+          pinThreadToCpu(i);
+        }
+        m_ioc.run();
+      });
+    }
+  }
+
+  void ProxyRuntime::join()
+  {
+    for (auto& thread : m_threads)
+    {
+      thread.join();
+    }
+    m_threads.clear();
+    m_stopped.store(true, std::memory_order_release);
+  }
+
+  void ProxyRuntime::stop()
+  {
+    asio::post(m_acceptor.get_executor(), [this] { beginDrain(); });
+  }
+
+  void ProxyRuntime::doAccept()
+  {
+    m_acceptor.async_accept(asio::make_strand(m_ioc),
+                          [this](const beast::error_code& ec, tcp::socket socket) { onAccept(ec, std::move(socket)); });
+  }
+
+  void ProxyRuntime::onAccept(const beast::error_code& ec, tcp::socket socket)
+  {
+    if (ec == asio::error::operation_aborted || draining())
+    {
+      return;
+    }
+    if (!ec)
+    {
+      socket.set_option(tcp::no_delay(true));
+      std::shared_ptr<ProxySession> session;
+      {
+        std::lock_guard<std::mutex> lk(m_sessionsMu);
+        const auto id = m_nextSessionId++;
+        session = std::make_shared<ProxySession>(std::move(socket), *this, id);
+        m_sessions.emplace(id, session);
+      }
+      m_open.fetch_add(1, std::memory_order_relaxed);
+      session->start();
+    }
+    doAccept();
+  }
+
+  void ProxyRuntime::sessionClosed(std::uint64_t id)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_sessionsMu);
+      m_sessions.erase(id);
+    }
+    m_open.fetch_sub(1, std::memory_order_relaxed);
+    if (m_stopped.load(std::memory_order_acquire))
+    {
+      return;
+    }
+
+    asio::post(m_acceptor.get_executor(), [this] {
+      if (draining() && m_open.load(std::memory_order_relaxed) == 0)
+      {
+        m_drainTimer.cancel();
+      }
+    });
+  }
+
+  void ProxyRuntime::beginDrain()
+  {
+    if (m_draining.exchange(true, std::memory_order_acq_rel))
+    {
+      return;
+    }
+
+    beast::error_code ec;
+    m_acceptor.close(ec);
+    m_signals.cancel(ec);
+
+    std::vector<std::shared_ptr<ProxySession>> open;
+    {
+      std::lock_guard<std::mutex> lk(m_sessionsMu);
+      for (const auto& [id, weak] : m_sessions)
+      {
+        if (auto session = weak.lock())
+        {
+          open.push_back(std::move(session));
+        }
+      }
+    }
+    for (const auto& session : open)
+    {
+      session->closeIfIdle();
+    }
+
+    if (m_open.load(std::memory_order_relaxed) != 0)
+    {
+      m_drainTimer.expires_after(config.drainTimeout);
+      m_drainTimer.async_wait([this](const beast::error_code& timerEc) {
+        if (!timerEc)
+        {
+          m_ioc.stop();
+        }
+      });
+    }
+  }
+
+  ClusterProxy::ClusterProxy(ServerConfig config)
+      : m_config(std::move(config))
+  {
+  }
+
+  ClusterProxy::~ClusterProxy()
+  {
+    if (m_runtime != nullptr && m_runtime->running())
+    {
+      stop();
+      wait();
+    }
+  }
+
+  void ClusterProxy::start()
+  {
+    m_runtime = std::make_unique<ProxyRuntime>(m_config);
+    m_runtime->listen();
+    m_port.store(m_runtime->port(), std::memory_order_release);
+    m_runtime->runThreads();
+  }
+
+  void ClusterProxy::wait()
+  {
+    if (m_runtime != nullptr)
+    {
+      m_runtime->join();
+    }
+  }
+
+  void ClusterProxy::run()
+  {
+    start();
+    std::cout << "Routing http://" << m_config.address << ":" << port() << " to " << m_config.clusterNodes.size()
+              << " node" << (m_config.clusterNodes.size() == 1 ? "" : "s") << " with " << m_config.ioThreads
+              << " I/O thread" << (m_config.ioThreads == 1 ? "" : "s") << "\n";
+    wait();
+  }
+
+  void ClusterProxy::stop()
+  {
+    if (m_runtime != nullptr)
+    {
+      m_runtime->stop();
+    }
+  }
+
+}  // namespace server
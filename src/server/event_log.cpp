@@ -0,0 +1,405 @@
+#include "server/event_log.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "server/binary_codec.hpp"
+
+namespace server
+{
+  namespace
+  {
+    constexpr std::size_t HEADER_SIZE = 8;
+    constexpr std::uint32_t MAX_PAYLOAD = 1024;
+
+    bool getCoordinate(codec::Reader& in, battleship::Coordinate& c)
+    {
+      std::uint8_t r = 0;
+      std::uint8_t col = 0;
+      if (!in.u8(r) || !in.u8(col))
+      {
+        return false;
+      }
+      c = battleship::Coordinate{ static_cast<std::int8_t>(r), static_cast<std::int8_t>(col) };
+      return true;
+    }
+
+    bool decode(const char* data, std::size_t size, GameEvent& ev)
+    {
+      codec::Reader in{ data, size };
+      std::uint8_t type = 0;
+      if (!in.u8(type) || !in.u64(ev.seq) || !in.string(ev.gameId))
+      {
+        return false;
+      }
+
+      std::uint8_t player = 0;
+      std::uint8_t boat = 0;
+      std::uint8_t orientation = 0;
+      switch (static_cast<GameEventType>(type))
+      {
+        case GameEventType::CreateGame:
+          if (!in.string(ev.tokens[0]) || !in.string(ev.tokens[1]))
+          {
+            return false;
+          }
+          break;
+        case GameEventType::JoinGame: break;
+        case GameEventType::PlaceShip:
+          if (!in.u8(player) || !in.u8(boat) || !in.u8(orientation) || !getCoordinate(in, ev.coordinate))
+          {
+            return false;
+          }
+          ev.boat = static_cast<battleship::BoatType>(boat);
+          ev.orientation = static_cast<battleship::Orientation>(orientation);
+          break;
+        case GameEventType::ReadyUp:
+          if (!in.u8(player))
+          {
+            return false;
+          }
+          break;
+        case GameEventType::Shoot:
+          if (!in.u8(player) || !getCoordinate(in, ev.coordinate))
+          {
+            return false;
+          }
+          break;
+        default: return false;
+      }
+
+      ev.type = static_cast<GameEventType>(type);
+      ev.player = player;
+      return in.done();
+    }
+
+    // Decodes records from the start of the buffer; returns the length of the valid prefix.
+    std::size_t decodeAll(const std::string& bytes, std::vector<GameEvent>& out)
+    {
+      std::size_t pos = 0;
+      while (bytes.size() - pos >= HEADER_SIZE)
+      {
+        codec::Reader header{ bytes.data() + pos, HEADER_SIZE };
+        std::uint32_t len = 0;
+        std::uint32_t crc = 0;
+        header.u32(len);
+        header.u32(crc);
+
+        if (len == 0 || len > MAX_PAYLOAD || bytes.size() - pos - HEADER_SIZE < len)
+        {
+          break;
+        }
+        const char* payload = bytes.data() + pos + HEADER_SIZE;
+        if (codec::crc32(payload, len) != crc)
+        {
+          break;
+        }
+
+        GameEvent ev;
+        if (!decode(payload, len, ev))
+        {
+          break;
+        }
+        out.push_back(std::move(ev));
+        pos += HEADER_SIZE + len;
+      }
+      return pos;
+    }
+
+    std::string readFile(const std::string& path)
+    {
+      std::ifstream in(path, std::ios::binary);
+      return std::string{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    }
+
+    [[noreturn]] void throwErrno(const char* what)
+    {
+      throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    bool writeAll(int fd, const std::string& bytes)
+    {
+      std::size_t off = 0;
+      while (off < bytes.size())
+      {
+        const ::ssize_t n = ::write(fd, bytes.data() + off, bytes.size() - off);
+        if (n < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          return false;
+        }
+        off += static_cast<std::size_t>(n);
+      }
+      return true;
+    }
+  }  // namespace
+
+  void EventLog::encode(const GameEvent& event, std::string& out)
+  {
+    const std::size_t start = out.size();
+    out.append(HEADER_SIZE, '\0');
+
+    codec::putU8(out, static_cast<std::uint8_t>(event.type));
+    codec::putU64(out, event.seq);
+    codec::putString(out, event.gameId);
+    switch (event.type)
+    {
+      case GameEventType::CreateGame:
+        codec::putString(out, event.tokens[0]);
+        codec::putString(out, event.tokens[1]);
+        break;
+      case GameEventType::JoinGame: break;
+      case GameEventType::PlaceShip:
+        codec::putU8(out, static_cast<std::uint8_t>(event.player));
+        codec::putU8(out, static_cast<std::uint8_t>(event.boat));
+        codec::putU8(out, static_cast<std::uint8_t>(event.orientation));
+        codec::putU8(out, static_cast<std::uint8_t>(event.coordinate.row));
+        codec::putU8(out, static_cast<std::uint8_t>(event.coordinate.col));
+        break;
+      case GameEventType::ReadyUp: codec::putU8(out, static_cast<std::uint8_t>(event.player)); break;
+      case GameEventType::Shoot:
+        codec::putU8(out, static_cast<std::uint8_t>(event.player));
+        codec::putU8(out, static_cast<std::uint8_t>(event.coordinate.row));
+        codec::putU8(out, static_cast<std::uint8_t>(event.coordinate.col));
+        break;
+    }
+
+    const auto len = static_cast<std::uint32_t>(out.size() - start - HEADER_SIZE);
+    std::string header;
+    codec::putU32(header, len);
+    codec::putU32(header, codec::crc32(out.data() + start + HEADER_SIZE, len));
+    out.replace(start, HEADER_SIZE, header);
+  }
+
+  std::vector<GameEvent> EventLog::readAll(const std::string& path)
+  {
+    std::vector<GameEvent> events;
+    decodeAll(readFile(path), events);
+    return events;
+  }
+
+  EventLog::EventLog(EventLogOptions options) : m_options(std::move(options))
+  {
+    decodeAll(readFile(previousPath()), m_recovered);
+    const std::string bytes = readFile(m_options.path);
+    const std::size_t valid = decodeAll(bytes, m_recovered);
+    if (!m_recovered.empty())
+    {
+      m_nextSeq = m_recovered.back().seq + 1;
+    }
+    m_pendingSeq = m_committedSeq = m_nextSeq - 1;
+
+    m_fd = ::open(m_options.path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+      throwErrno("event log open");
+    }
+    // Drop a torn tail so new records are not hidden behind it.
+    if (valid != bytes.size() && ::ftruncate(m_fd, static_cast<::off_t>(valid)) != 0)
+    {
+      ::close(m_fd);
+      throwErrno("event log truncate");
+    }
+    ::lseek(m_fd, 0, SEEK_END);
+
+    m_thread = std::thread([this] { run(); });
+  }
+
+  EventLog::~EventLog()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mu);
+      m_stop = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable())
+    {
+      m_thread.join();
+    }
+    if (m_fd >= 0)
+    {
+      ::close(m_fd);
+    }
+  }
+
+  std::uint64_t EventLog::append(GameEvent event)
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    event.seq = m_nextSeq++;
+    encode(event, m_pending);
+    m_pendingSeq = event.seq;
+    return event.seq;
+  }
+
+  void EventLog::flush()
+  {
+    std::unique_lock<std::mutex> lk(m_mu);
+    const std::uint64_t target = m_pendingSeq;
+    if (m_committedSeq >= target)
+    {
+      return;
+    }
+    m_flushRequested = true;
+    m_wake.notify_one();
+    // A failure counts once a commit attempted after this call has failed, not when an earlier one had.
+    const std::uint64_t attempts = m_attempts;
+    m_committedCv.wait(lk, [&] {
+      return m_committedSeq >= target || (m_attempts != attempts && m_errno.load(std::memory_order_relaxed) != 0);
+    });
+    if (m_committedSeq < target)
+    {
+      throw std::system_error(error(), "event log commit");
+    }
+  }
+
+  std::error_code EventLog::error() const noexcept
+  {
+    const int code = m_errno.load(std::memory_order_relaxed);
+    return code == 0 ? std::error_code{} : std::error_code{ code, std::generic_category() };
+  }
+
+  std::string EventLog::previousPath() const
+  {
+    return m_options.path + ".prev";
+  }
+
+  void EventLog::rotate()
+  {
+    std::lock_guard<std::mutex> file(m_fileMu);
+
+    ::fdatasync(m_fd);
+    if (::rename(m_options.path.c_str(), previousPath().c_str()) != 0)
+    {
+      throwErrno("event log rotate");
+    }
+    const int fd = ::open(m_options.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+      throwErrno("event log open");
+    }
+    ::close(m_fd);
+    m_fd = fd;
+    syncParentDirectory(m_options.path);
+  }
+
+  void syncParentDirectory(const std::string& path)
+  {
+    auto directory = std::filesystem::path(path).parent_path();
+    if (directory.empty())
+    {
+      directory = ".";
+    }
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      throwErrno("directory open");
+    }
+    const int rc = ::fsync(fd);
+    const int error = errno;
+    ::close(fd);
+    if (rc != 0)
+    {
+      throw std::system_error(error, std::generic_category(), "directory sync");
+    }
+  }
+
+  void EventLog::releaseRecovered()
+  {
+    std::vector<GameEvent>{}.swap(m_recovered);
+  }
+
+  std::uint64_t EventLog::lastSeq() const
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    return m_nextSeq - 1;
+  }
+
+  void EventLog::advanceTo(std::uint64_t seq)
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    if (seq < m_nextSeq)
+    {
+      return;
+    }
+    m_nextSeq = seq + 1;
+    if (m_pending.empty() && m_pendingSeq == m_committedSeq)
+    {
+      m_pendingSeq = m_committedSeq = seq;
+    }
+  }
+
+  void EventLog::run()
+  {
+    std::unique_lock<std::mutex> lk(m_mu);
+    while (!m_stop)
+    {
+      m_wake.wait_for(lk, m_options.commitInterval, [&] { return m_stop || m_flushRequested; });
+      commit(lk);
+    }
+    commit(lk);
+  }
+
+  void EventLog::commit(std::unique_lock<std::mutex>& lk)
+  {
+    m_flushRequested = false;
+    if (m_pending.empty())
+    {
+      return;
+    }
+
+    m_writing.swap(m_pending);
+    const std::uint64_t batchSeq = m_pendingSeq;
+
+    // Appenders keep filling m_pending while this batch goes to disk.
+    lk.unlock();
+    int failure = 0;
+    {
+      std::lock_guard<std::mutex> file(m_fileMu);
+      const ::off_t start = ::lseek(m_fd, 0, SEEK_CUR);
+      if (!writeAll(m_fd, m_writing) || ::fdatasync(m_fd) != 0)
+      {
+        failure = errno;
+        // Cut the batch off again: later batches must not land behind a torn record, which recovery stops at.
+        if (::ftruncate(m_fd, start) != 0 || ::lseek(m_fd, start, SEEK_SET) != start)
+        {
+          std::cerr << "event log: cannot cut off a failed batch: " << std::strerror(errno) << std::endl;
+        }
+      }
+    }
+    lk.lock();
+
+    ++m_attempts;
+    if (failure != 0)
+    {
+      // The batch goes out again ahead of whatever was appended meanwhile.
+      m_writing += m_pending;
+      m_pending.swap(m_writing);
+      m_writing.clear();
+      if (m_errno.exchange(failure, std::memory_order_relaxed) == 0)
+      {
+        std::cerr << "event log: " << std::strerror(failure) << std::endl;
+      }
+      m_committedCv.notify_all();
+      return;
+    }
+
+    m_writing.clear();
+    m_errno.store(0, std::memory_order_relaxed);
+    m_committedSeq = batchSeq;
+    m_committedCv.notify_all();
+  }
+
+}  // namespace server
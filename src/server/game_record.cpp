@@ -0,0 +1,151 @@
+#include "server/game_record.hpp"
+
+#include "server/binary_codec.hpp"
+
+namespace server
+{
+  namespace
+  {
+    constexpr std::uint8_t RECORD_VERSION = 1;
+    constexpr std::size_t HEADER_SIZE = 8;
+    constexpr std::uint32_t MAX_PAYLOAD = 4096;
+
+    void putU16(std::string& out, std::uint16_t v)
+    {
+      codec::putU8(out, static_cast<std::uint8_t>(v & 0xFFU));
+      codec::putU8(out, static_cast<std::uint8_t>(v >> 8));
+    }
+
+    bool getU16(codec::Reader& in, std::uint16_t& v)
+    {
+      std::uint8_t lo = 0;
+      std::uint8_t hi = 0;
+      if (!in.u8(lo) || !in.u8(hi))
+      {
+        return false;
+      }
+      v = static_cast<std::uint16_t>(lo | (hi << 8));
+      return true;
+    }
+  }  // namespace
+
+  void encodeGameRecord(const GameRecord& record, std::string& out)
+  {
+    const std::size_t start = out.size();
+    out.append(HEADER_SIZE, '\0');
+
+    codec::putU8(out, RECORD_VERSION);
+    codec::putString(out, record.gameId);
+    codec::putU64(out, record.playerHash[0]);
+    codec::putU64(out, record.playerHash[1]);
+    codec::putU64(out, static_cast<std::uint64_t>(record.startedAtMs));
+    codec::putU64(out, static_cast<std::uint64_t>(record.finishedAtMs));
+    codec::putU8(out, record.winner);
+    for (const auto& fleet : record.fleets)
+    {
+      codec::putU8(out, static_cast<std::uint8_t>(fleet.size()));
+      for (const auto packed : fleet)
+      {
+        putU16(out, packed);
+      }
+    }
+    putU16(out, static_cast<std::uint16_t>(record.shots.size()));
+    out.append(reinterpret_cast<const char*>(record.shots.data()), record.shots.size());
+
+    const auto len = static_cast<std::uint32_t>(out.size() - start - HEADER_SIZE);
+    std::string header;
+    codec::putU32(header, len);
+    codec::putU32(header, codec::crc32(out.data() + start + HEADER_SIZE, len));
+    out.replace(start, HEADER_SIZE, header);
+  }
+
+  bool parseGameRecord(const char* data,
+                       std::size_t size,
+                       GameRecordView& view,
+                       std::size_t& consumed,
+                       bool verifyChecksum) noexcept
+  {
+    codec::Reader header{ data, size };
+    std::uint32_t len = 0;
+    std::uint32_t crc = 0;
+    if (!header.u32(len) || !header.u32(crc) || len == 0 || len > MAX_PAYLOAD || header.remaining() < len ||
+        (verifyChecksum && codec::crc32(data + HEADER_SIZE, len) != crc))
+    {
+      return false;
+    }
+
+    const char* payload = data + HEADER_SIZE;
+    const auto bytesAt = [payload](std::size_t offset, std::size_t n) {
+      return std::span<const std::uint8_t>{ reinterpret_cast<const std::uint8_t*>(payload + offset), n };
+    };
+
+    codec::Reader in{ payload, len };
+    std::uint8_t version = 0;
+    std::uint8_t idLength = 0;
+    if (!in.u8(version) || version != RECORD_VERSION || !in.u8(idLength) || in.remaining() < idLength)
+    {
+      return false;
+    }
+    view.gameId = std::string_view{ payload + in.position(), idLength };
+    in.skip(idLength);
+
+    std::uint64_t started = 0;
+    std::uint64_t finished = 0;
+    if (!in.u64(view.playerHash[0]) || !in.u64(view.playerHash[1]) || !in.u64(started) || !in.u64(finished) ||
+        !in.u8(view.winner))
+    {
+      return false;
+    }
+    view.startedAtMs = static_cast<std::int64_t>(started);
+    view.finishedAtMs = static_cast<std::int64_t>(finished);
+
+    for (auto& fleet : view.fleets)
+    {
+      std::uint8_t count = 0;
+      if (!in.u8(count) || in.remaining() < 2U * count)
+      {
+        return false;
+      }
+      fleet = bytesAt(in.position(), 2U * count);
+      in.skip(2U * count);
+    }
+
+    std::uint16_t shotCount = 0;
+    if (!getU16(in, shotCount) || in.remaining() != shotCount)
+    {
+      return false;
+    }
+    view.shots = bytesAt(in.position(), shotCount);
+
+    consumed = HEADER_SIZE + len;
+    return true;
+  }
+
+  std::optional<GameRecord> decodeGameRecord(const char* data, std::size_t size, std::size_t& consumed)
+  {
+    GameRecordView view;
+    if (!parseGameRecord(data, size, view, consumed))
+    {
+      return std::nullopt;
+    }
+
+    GameRecord record;
+    record.gameId = std::string{ view.gameId };
+    record.playerHash = view.playerHash;
+    record.startedAtMs = view.startedAtMs;
+    record.finishedAtMs = view.finishedAtMs;
+    record.winner = view.winner;
+    for (int p = 0; p < 2; ++p)
+    {
+      auto& fleet = record.fleets[static_cast<std::size_t>(p)];
+      fleet.reserve(view.fleetSize(p));
+      for (std::size_t i = 0; i < view.fleetSize(p); ++i)
+      {
+        fleet.push_back(view.placement(p, i));
+      }
+    }
+    record.shots.assign(view.shots.begin(), view.shots.end());
+    return record;
+  }
+
+}  // namespace server
@@ -0,0 +1,214 @@
+#include "server/game_recorder.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <utility>
+
+namespace server
+{
+  namespace
+  {
+    constexpr const char* SEGMENT_PREFIX = "segment-";
+    constexpr const char* SEGMENT_SUFFIX = ".bsr";
+
+    std::string segmentName(std::uint32_t index)
+    {
+      char name[32];
+      std::snprintf(name, sizeof(name), "%s%06u%s", SEGMENT_PREFIX, index, SEGMENT_SUFFIX);
+      return name;
+    }
+
+    bool isSegment(const std::filesystem::path& p)
+    {
+      const std::string name = p.filename().string();
+      return name.rfind(SEGMENT_PREFIX, 0) == 0 && p.extension() == SEGMENT_SUFFIX;
+    }
+
+    bool writeAll(int fd, const std::string& bytes)
+    {
+      std::size_t off = 0;
+      while (off < bytes.size())
+      {
+        const ::ssize_t n = ::write(fd, bytes.data() + off, bytes.size() - off);
+        if (n < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          return false;
+        }
+        off += static_cast<std::size_t>(n);
+      }
+      return true;
+    }
+  }  // namespace
+
+  std::vector<std::string> GameRecorder::listSegments(const std::string& directory)
+  {
+    std::vector<std::string> segments;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+    {
+      if (entry.is_regular_file() && isSegment(entry.path()))
+      {
+        segments.push_back(entry.path().string());
+      }
+    }
+    // Indices are zero-padded, so name order is creation order.
+    std::sort(segments.begin(), segments.end());
+    return segments;
+  }
+
+  GameRecorder::GameRecorder(RecorderOptions options) : m_options(std::move(options))
+  {
+    std::filesystem::create_directories(m_options.directory);
+    const auto existing = listSegments(m_options.directory);
+    if (!existing.empty())
+    {
+      const std::string last = std::filesystem::path(existing.back()).stem().string();
+      m_segmentIndex = static_cast<std::uint32_t>(std::stoul(last.substr(std::strlen(SEGMENT_PREFIX)))) + 1;
+    }
+    if (!openSegment())
+    {
+      throw std::system_error(errno, std::generic_category(), "game recorder open");
+    }
+
+    m_thread = std::thread([this] { run(); });
+  }
+
+  GameRecorder::~GameRecorder()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mu);
+      m_stop = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable())
+    {
+      m_thread.join();
+    }
+    if (m_fd >= 0)
+    {
+      ::fdatasync(m_fd);
+      ::close(m_fd);
+    }
+  }
+
+  void GameRecorder::submit(std::unique_ptr<GameRecord> record) noexcept
+  {
+    auto* node = new (std::nothrow) Node{ std::move(record), nullptr };
+    if (node == nullptr)
+    {
+      return;
+    }
+    node->next = m_head.load(std::memory_order_relaxed);
+    while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void GameRecorder::flush()
+  {
+    const std::uint64_t target = m_submitted.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lk(m_mu);
+    const auto settled = [&] { return recordsWritten() + recordsFailed() >= target; };
+    if (settled())
+    {
+      return;
+    }
+    m_flushRequested = true;
+    m_wake.notify_one();
+    m_drained.wait(lk, settled);
+  }
+
+  void GameRecorder::run()
+  {
+    std::unique_lock<std::mutex> lk(m_mu);
+    while (!m_stop)
+    {
+      m_wake.wait_for(lk, m_options.flushInterval, [&] { return m_stop || m_flushRequested; });
+      m_flushRequested = false;
+      lk.unlock();
+      drain();
+      lk.lock();
+      m_drained.notify_all();
+    }
+    lk.unlock();
+    drain();
+  }
+
+  void GameRecorder::drain()
+  {
+    Node* head = m_head.exchange(nullptr, std::memory_order_acquire);
+    if (head == nullptr)
+    {
+      return;
+    }
+
+    // The stack holds the newest record first; reverse it to write in submission order.
+    Node* ordered = nullptr;
+    while (head != nullptr)
+    {
+      Node* next = head->next;
+      head->next = ordered;
+      ordered = head;
+      head = next;
+    }
+
+    std::uint64_t count = 0;
+    m_buffer.clear();
+    while (ordered != nullptr)
+    {
+      std::unique_ptr<Node> node{ ordered };
+      ordered = node->next;
+      encodeGameRecord(*node->record, m_buffer);
+      ++count;
+    }
+
+    if (m_segmentSize > 0 && m_segmentSize + m_buffer.size() > m_options.segmentBytes)
+    {
+      rollSegment();
+    }
+    // A segment that failed to open is retried on every batch.
+    if ((m_fd < 0 && !openSegment()) || !writeAll(m_fd, m_buffer))
+    {
+      std::cerr << "game recorder: dropped " << count << " records: " << std::strerror(errno) << std::endl;
+      // Cut the partial batch off so readers don't stop at a torn record; failing that, leave the segment be.
+      if (m_fd >= 0 && ::ftruncate(m_fd, static_cast<::off_t>(m_segmentSize)) != 0)
+      {
+        rollSegment();
+      }
+      m_failed.fetch_add(count, std::memory_order_release);
+      return;
+    }
+    m_segmentSize += m_buffer.size();
+    m_written.fetch_add(count, std::memory_order_release);
+  }
+
+  void GameRecorder::rollSegment()
+  {
+    ::fdatasync(m_fd);
+    ::close(m_fd);
+    ++m_segmentIndex;
+    openSegment();
+  }
+
+  bool GameRecorder::openSegment()
+  {
+    const auto path = std::filesystem::path(m_options.directory) / segmentName(m_segmentIndex);
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    m_segmentSize = 0;
+    return m_fd >= 0;
+  }
+
+}  // namespace server
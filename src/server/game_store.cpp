@@ -1,22 +1,82 @@
 #include "server/game_store.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <random>
 #include <stdexcept>
 #include <memory>
+#include <tuple>
+#include <utility>
+
+#include "server/binary_codec.hpp"
+#include "server/event_log.hpp"
+#include "server/game_recorder.hpp"
+#include "server/matchmaker.hpp"
+#include "server/snapshot.hpp"
+#include "server/spectator_hub.hpp"
 
 #include "project/core/boat.hpp"
+#include "project/core/fleetGenerator.hpp"
+#include "project/exceptions/exceptions.hpp"
 
 namespace server
 {
   namespace
   {
+    // One generator per thread: ids, tokens and fleets are drawn outside any shard lock, from every I/O thread
+    // and the matchmaker.
     std::mt19937& rng()
     {
-      static std::mt19937 gen{ std::random_device{}() };
+      thread_local std::mt19937 gen{ std::random_device{}() };
       return gen;
     }
+
+    std::int64_t nowMs()
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    void startHistory(GameState& game, const std::string& gameId)
+    {
+      game.history.gameId = gameId;
+      game.history.playerHash = { codec::fnv1a64(game.token[0]), codec::fnv1a64(game.token[1]) };
+      game.history.startedAtMs = nowMs();
+    }
+
+    GameEvent makeEvent(GameEventType type, const std::string& gameId, int playerIndex = 0)
+    {
+      GameEvent ev;
+      ev.type = type;
+      ev.gameId = gameId;
+      ev.player = playerIndex;
+      return ev;
+    }
   }  // namespace
 
+  GameStore::GameStore(std::size_t shards, std::string idPrefix)
+      : m_shardCount(std::max<std::size_t>(1, shards)),
+        m_shards(std::make_unique<Shard[]>(m_shardCount)),
+        m_idPrefix(std::move(idPrefix))
+  {
+  }
+
+  std::size_t GameStore::shardOf(std::string_view gameId) const noexcept
+  {
+    return m_shardCount == 1 ? 0 : codec::fnv1a64(gameId) % m_shardCount;
+  }
+
+  std::vector<ProfiledMutex::Guard> GameStore::lockAll(StoreOp op) const
+  {
+    std::vector<ProfiledMutex::Guard> guards;
+    guards.reserve(m_shardCount);
+    for (std::size_t i = 0; i < m_shardCount; ++i)
+    {
+      guards.push_back(m_shards[i].mu.acquire(op));
+    }
+    return guards;
+  }
+
   std::string GameStore::randomId(std::size_t n)
   {
     static const char* alphabet = "abcdefghijklmnopqrstuvwxyz0123456789";
@@ -35,50 +95,130 @@ namespace server
     return randomId(2) + "-" + randomId(24);
   }
 
-  CreateGameResult GameStore::createGame()
+  StoreResult<CreateGameResult> GameStore::tryCreateGame()
   {
-    std::lock_guard<std::mutex> lk(m_mu);
-
-    const std::string gid = randomId(8);
+    if (logFailed())
+    {
+      return battleship::unexpected(StoreError::LogUnavailable);
+    }
+    const std::string gid = m_idPrefix + randomId(8);
+    Shard& shard = shardFor(gid);
+    const auto lk = shard.mu.acquire(StoreOp::CreateGame);
 
     auto g = std::make_shared<GameState>();
     g->token[0] = randomToken();
     g->token[1] = randomToken();
     g->status = GameStatus::WaitingForPlayers;
 
-    m_games.emplace(gid, g);
+    startHistory(*g, gid);
+
+    shard.games.emplace(gid, g);
+    indexGame(shard, gid, *g);
+
+    if (m_log)
+    {
+      auto ev = makeEvent(GameEventType::CreateGame, gid);
+      ev.tokens = { g->token[0], g->token[1] };
+      g->lastSeq = m_log->append(std::move(ev));
+    }
 
     return CreateGameResult{ .gameId=gid, .playerId=1, .playerToken=g->token[0], .status=g->status };
   }
 
+  namespace
+  {
+    [[noreturn]] void throwStoreError(StoreError error)
+    {
+      switch (error)
+      {
+        case StoreError::OutOfBounds:
+        case StoreError::CoordinateOutOfBounds: throw battleship::OutOfBounds{ to_cstr(error) };
+        case StoreError::Collision: throw battleship::Collision{ to_cstr(error) };
+        case StoreError::AlreadyShot: throw battleship::AlreadyShot{ to_cstr(error) };
+        case StoreError::UndefinedShot: throw battleship::UndefinedShorError{ to_cstr(error) };
+        case StoreError::InvalidOrientation: throw std::invalid_argument{ to_cstr(error) };
+        default: throw std::runtime_error{ to_cstr(error) };
+      }
+    }
+
+    template<typename T>
+    T valueOrThrow(StoreResult<T>&& result)
+    {
+      if (!result)
+      {
+        throwStoreError(result.error());
+      }
+      return std::move(result).value();
+    }
+
+    void throwIfError(const std::optional<StoreError>& error)
+    {
+      if (error.has_value())
+      {
+        throwStoreError(*error);
+      }
+    }
+  }  // namespace
+
+  CreateGameResult GameStore::createGame()
+  {
+    return valueOrThrow(tryCreateGame());
+  }
+
   JoinGameResult GameStore::joinGame(const std::string& gameId)
   {
-    std::lock_guard<std::mutex> lk(m_mu);
+    return valueOrThrow(tryJoinGame(gameId));
+  }
 
-    auto it = m_games.find(gameId);
-    if (it == m_games.end())
+  bool GameStore::logFailed() const noexcept
+  {
+    return m_log != nullptr && m_log->error();
+  }
+
+  StoreResult<JoinGameResult> GameStore::tryJoinGame(const std::string& gameId)
+  {
+    if (logFailed())
     {
-      throw std::runtime_error("Game not found.");
+      return battleship::unexpected(StoreError::LogUnavailable);
+    }
+    Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::JoinGame);
+
+    auto joined = joinLocked(shard, gameId);
+    if (joined)
+    {
+      record(shard, makeEvent(GameEventType::JoinGame, gameId));
+    }
+    return joined;
+  }
+
+  StoreResult<JoinGameResult> GameStore::joinLocked(Shard& shard, const std::string& gameId)
+  {
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
+    {
+      return battleship::unexpected(StoreError::GameNotFound);
     }
 
     auto& g = *it->second;
     if (g.joined[1])
     {
-      throw std::runtime_error("Game already has 2 players.");
+      return battleship::unexpected(StoreError::GameFull);
     }
 
     g.joined[1] = true;
-    g.status = GameStatus::Placing;
+    setStatus(shard, g, GameStatus::Placing);
 
     return JoinGameResult{ .gameId=gameId, .playerId=2, .playerToken=g.token[1], .status=g.status };
   }
 
   AuthContext GameStore::authenticate(const std::string& gameId, const std::string& authHeader) const
   {
-    std::lock_guard<std::mutex> lk(m_mu);
+    const Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::Authenticate);
 
-    auto it = m_games.find(gameId);
-    if (it == m_games.end())
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
     {
       return AuthContext{ -1, "" };
     }
@@ -103,86 +243,295 @@ namespace server
     return AuthContext{ -1, tok };
   }
 
+  int GameStore::authorizedPlayer(const std::string& gameId, std::string_view authHeader) const
+  {
+    constexpr std::string_view prefix = "Bearer ";
+    if (authHeader.substr(0, prefix.size()) != prefix)
+    {
+      return -1;
+    }
+    const std::string_view tok = authHeader.substr(prefix.size());
+
+    const Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::Authenticate);
+
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
+    {
+      return -1;
+    }
+
+    const auto& g = *it->second;
+    if (tok == g.token[0])
+    {
+      return 0;
+    }
+    if (tok == g.token[1])
+    {
+      return 1;
+    }
+    return -1;
+  }
+
+  StoreResult<GameState*> GameStore::placingGame(Shard& shard, const std::string& gameId, int playerIndex)
+  {
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
+    {
+      return battleship::unexpected(StoreError::GameNotFound);
+    }
+    auto& g = *it->second;
+
+    if (playerIndex < 0 || playerIndex > 1)
+    {
+      return battleship::unexpected(StoreError::InvalidPlayer);
+    }
+    if (!g.joined[playerIndex])
+    {
+      return battleship::unexpected(StoreError::PlayerNotJoined);
+    }
+    if (g.status == GameStatus::Finished)
+    {
+      return battleship::unexpected(StoreError::GameFinished);
+    }
+
+    return &g;
+  }
+
   void GameStore::placeShip(const std::string& gameId,
                             int playerIndex,
                             battleship::BoatType type,
                             const battleship::Coordinate& start,
                             battleship::Orientation orientation)
   {
-    std::lock_guard<std::mutex> lk(m_mu);
+    throwIfError(tryPlaceShip(gameId, playerIndex, type, start, orientation));
+  }
 
-    auto it = m_games.find(gameId);
-    if (it == m_games.end())
+  std::optional<StoreError> GameStore::tryPlaceShip(const std::string& gameId,
+                                                    int playerIndex,
+                                                    battleship::BoatType type,
+                                                    const battleship::Coordinate& start,
+                                                    battleship::Orientation orientation)
+  {
+    if (logFailed())
     {
-      throw std::runtime_error("Game not found.");
+      return StoreError::LogUnavailable;
     }
-    auto& g = *it->second;
+    Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::PlaceShip);
 
-    if (playerIndex < 0 || playerIndex > 1)
+    auto game = placeShipLocked(shard, gameId, playerIndex, type, start, orientation);
+    if (!game)
     {
-      throw std::runtime_error("Invalid player.");
+      return game.error();
     }
-    if (!g.joined[playerIndex])
+    recordPlacement(shard, gameId, playerIndex, battleship::FleetPlacement{ type, battleship::Placement{ start, orientation } });
+    return std::nullopt;
+  }
+
+  StoreResult<GameState*> GameStore::placeShipLocked(Shard& shard,
+                                                     const std::string& gameId,
+                                                     int playerIndex,
+                                                     battleship::BoatType type,
+                                                     const battleship::Coordinate& start,
+                                                     battleship::Orientation orientation)
+  {
+    auto game = placingGame(shard, gameId, playerIndex);
+    if (!game)
     {
-      throw std::runtime_error("Player not joined.");
+      return game;
     }
-    if (g.status == GameStatus::Finished)
+
+    const auto placed =
+        (*game)->boards[playerIndex].tryPlaceStructure(battleship::Boat{ type }, battleship::Placement{ start, orientation });
+    if (placed != battleship::BoardError::None)
+    {
+      return battleship::unexpected(to_store_error(placed));
+    }
+    (*game)->history.addPlacement(playerIndex, battleship::FleetPlacement{ type, battleship::Placement{ start, orientation } });
+    return game;
+  }
+
+  void GameStore::placeFleet(const std::string& gameId,
+                             int playerIndex,
+                             const std::vector<battleship::FleetPlacement>& fleet)
+  {
+    throwIfError(tryPlaceFleet(gameId, playerIndex, fleet));
+  }
+
+  std::optional<StoreError> GameStore::tryPlaceFleet(const std::string& gameId,
+                                                     int playerIndex,
+                                                     const std::vector<battleship::FleetPlacement>& fleet)
+  {
+    if (logFailed())
     {
-      throw std::runtime_error("Game finished.");
+      return StoreError::LogUnavailable;
     }
+    Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::PlaceFleet);
+
+    auto game = placingGame(shard, gameId, playerIndex);
+    if (!game)
+    {
+      return game.error();
+    }
+
+    const auto placed = (*game)->boards[playerIndex].tryPlaceFleet(fleet);
+    if (placed != battleship::BoardError::None)
+    {
+      return to_store_error(placed);
+    }
+    for (const auto& ship : fleet)
+    {
+      (*game)->history.addPlacement(playerIndex, ship);
+      recordPlacement(shard, gameId, playerIndex, ship);
+    }
+    return std::nullopt;
+  }
 
-    g.boards[playerIndex].placeStructure(battleship::Boat{ type }, battleship::Placement{ start, orientation });
+  std::vector<battleship::FleetPlacement> GameStore::placeRandomFleet(const std::string& gameId, int playerIndex)
+  {
+    return valueOrThrow(tryPlaceRandomFleet(gameId, playerIndex));
+  }
+
+  StoreResult<std::vector<battleship::FleetPlacement>> GameStore::tryPlaceRandomFleet(const std::string& gameId,
+                                                                                     int playerIndex)
+  {
+    if (logFailed())
+    {
+      return battleship::unexpected(StoreError::LogUnavailable);
+    }
+    Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::PlaceRandomFleet);
+
+    auto game = placingGame(shard, gameId, playerIndex);
+    if (!game)
+    {
+      return battleship::unexpected(game.error());
+    }
+
+    auto& board = (*game)->boards[playerIndex];
+    if (board.structureCount() != 0)
+    {
+      return battleship::unexpected(StoreError::FleetAlreadyPlaced);
+    }
+
+    // The standard fleet always fits an empty board, so generation cannot fail here.
+    auto fleet = battleship::generateRandomFleet(board, rng());
+    if (const auto placed = board.tryPlaceFleet(fleet); placed != battleship::BoardError::None)
+    {
+      return battleship::unexpected(to_store_error(placed));
+    }
+    for (const auto& ship : fleet)
+    {
+      (*game)->history.addPlacement(playerIndex, ship);
+      recordPlacement(shard, gameId, playerIndex, ship);
+    }
+    return fleet;
   }
 
   GameStatus GameStore::readyUp(const std::string& gameId, int playerIndex)
   {
-    std::lock_guard<std::mutex> lk(m_mu);
+    return valueOrThrow(tryReadyUp(gameId, playerIndex));
+  }
+
+  StoreResult<GameStatus> GameStore::tryReadyUp(const std::string& gameId, int playerIndex)
+  {
+    if (logFailed())
+    {
+      return battleship::unexpected(StoreError::LogUnavailable);
+    }
+    Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::ReadyUp);
+
+    auto status = readyUpLocked(shard, gameId, playerIndex);
+    if (status)
+    {
+      record(shard, makeEvent(GameEventType::ReadyUp, gameId, playerIndex));
+    }
+    return status;
+  }
 
-    auto it = m_games.find(gameId);
-    if (it == m_games.end())
+  StoreResult<GameStatus> GameStore::readyUpLocked(Shard& shard, const std::string& gameId, int playerIndex)
+  {
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
     {
-      throw std::runtime_error("Game not found.");
+      return battleship::unexpected(StoreError::GameNotFound);
     }
     auto& g = *it->second;
 
     if (playerIndex < 0 || playerIndex > 1)
     {
-      throw std::runtime_error("Invalid player.");
+      return battleship::unexpected(StoreError::InvalidPlayer);
     }
 
     g.ready[playerIndex] = true;
-    g.status = (g.ready[0] && g.ready[1]) ? GameStatus::InProgress : GameStatus::Placing;
+    setStatus(shard, g, (g.ready[0] && g.ready[1]) ? GameStatus::InProgress : GameStatus::Placing);
     return g.status;
   }
 
   ShotOutcome GameStore::shoot(const std::string& gameId, int playerIndex, const battleship::Coordinate& target)
   {
-    std::lock_guard<std::mutex> lk(m_mu);
+    return valueOrThrow(tryShoot(gameId, playerIndex, target));
+  }
+
+  StoreResult<ShotOutcome> GameStore::tryShoot(const std::string& gameId,
+                                               int playerIndex,
+                                               const battleship::Coordinate& target)
+  {
+    if (logFailed())
+    {
+      return battleship::unexpected(StoreError::LogUnavailable);
+    }
+    Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::Shoot);
+
+    auto outcome = shootLocked(shard, gameId, playerIndex, target);
+    if (outcome)
+    {
+      auto ev = makeEvent(GameEventType::Shoot, gameId, playerIndex);
+      ev.coordinate = target;
+      record(shard, std::move(ev));
+    }
+    return outcome;
+  }
 
-    auto it = m_games.find(gameId);
-    if (it == m_games.end())
+  StoreResult<ShotOutcome> GameStore::shootLocked(Shard& shard,
+                                                  const std::string& gameId,
+                                                  int playerIndex,
+                                                  const battleship::Coordinate& target)
+  {
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
     {
-      throw std::runtime_error("Game not found.");
+      return battleship::unexpected(StoreError::GameNotFound);
     }
     auto& g = *it->second;
 
     if (g.status != GameStatus::InProgress)
     {
-      throw std::runtime_error("Game not in progress.");
+      return battleship::unexpected(StoreError::NotInProgress);
     }
     if (g.turn != playerIndex)
     {
-      throw std::runtime_error("Not your turn.");
+      return battleship::unexpected(StoreError::NotYourTurn);
     }
 
     const int enemy = 1 - playerIndex;
-    g.boards[enemy].handle_shot(target);
+    const auto shot = g.boards[enemy].tryHandleShot(target);
+    if (!shot)
+    {
+      return battleship::unexpected(to_store_error(shot.error()));
+    }
+    g.history.addShot(target, *shot == battleship::CellState::HIT);
 
     std::string result = "OK";
 
     if (g.boards[enemy].allBoatsDestroyed())
     {
-      g.status = GameStatus::Finished;
+      setStatus(shard, g, GameStatus::Finished);
+      finishHistory(g, playerIndex);
     }
     else
     {
@@ -192,11 +541,296 @@ namespace server
     return ShotOutcome{ result, g.turn + 1, g.status };
   }
 
+  void GameStore::attachRecorder(std::shared_ptr<GameRecorder> recorder)
+  {
+    const auto lk = lockAll(StoreOp::AttachRecorder);
+    m_recorder = std::move(recorder);
+  }
+
+  void GameStore::attachMatchmaker(std::shared_ptr<Matchmaker> matchmaker)
+  {
+    m_matchmaker = std::move(matchmaker);
+  }
+
+  void GameStore::attachSpectators(std::shared_ptr<SpectatorHub> hub)
+  {
+    m_spectators = std::move(hub);
+  }
+
+  void GameStore::setStatus(Shard& shard, GameState& game, GameStatus status)
+  {
+    // The id's node moves to the end of the new status's index; nothing is allocated.
+    auto entry = shard.byStatus[static_cast<std::size_t>(game.status)].extract(game.listingKey);
+    game.listingKey = m_nextListingKey.fetch_add(1, std::memory_order_relaxed);
+    entry.key() = game.listingKey;
+    shard.byStatus[static_cast<std::size_t>(status)].insert(std::move(entry));
+    game.status = status;
+  }
+
+  void GameStore::indexGame(Shard& shard, const std::string& gameId, GameState& game)
+  {
+    game.listingKey = m_nextListingKey.fetch_add(1, std::memory_order_relaxed);
+    shard.byStatus[static_cast<std::size_t>(game.status)].emplace(game.listingKey, gameId);
+  }
+
+  void GameStore::unindexGame(Shard& shard, const GameState& game)
+  {
+    shard.byStatus[static_cast<std::size_t>(game.status)].erase(game.listingKey);
+  }
+
+  GameListing GameStore::listGames(GameStatus status, std::size_t limit, std::uint64_t cursor) const
+  {
+    // One entry past the page from every shard tells whether another page follows.
+    std::vector<std::pair<std::uint64_t, std::string>> candidates;
+    for (std::size_t i = 0; i < m_shardCount && limit != 0; ++i)
+    {
+      const Shard& shard = m_shards[i];
+      const auto lk = shard.mu.acquire(StoreOp::ListGames);
+      const auto& index = shard.byStatus[static_cast<std::size_t>(status)];
+      std::size_t taken = 0;
+      for (auto it = index.upper_bound(cursor); it != index.end() && taken <= limit; ++it, ++taken)
+      {
+        candidates.emplace_back(it->first, it->second);
+      }
+    }
+
+    const std::size_t page = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(page), candidates.end());
+
+    GameListing listing;
+    listing.gameIds.reserve(page);
+    for (std::size_t i = 0; i < page; ++i)
+    {
+      listing.gameIds.push_back(std::move(candidates[i].second));
+    }
+    if (candidates.size() > page)
+    {
+      listing.nextCursor = candidates[page - 1].first;
+    }
+    return listing;
+  }
+
+  StoreStats GameStore::stats() const
+  {
+    StoreStats stats;
+    for (std::size_t i = 0; i < m_shardCount; ++i)
+    {
+      const Shard& shard = m_shards[i];
+      const auto lk = shard.mu.acquire(StoreOp::Stats);
+      for (std::size_t s = 0; s < GAME_STATUS_COUNT; ++s)
+      {
+        stats.gamesByStatus[s] += shard.byStatus[s].size();
+      }
+      stats.lockAcquisitions += shard.mu.acquisitions();
+      stats.lockContended += shard.mu.contended();
+      stats.lockWaitNs += shard.mu.waitNs();
+    }
+    return stats;
+  }
+
+  LockProfile GameStore::lockProfile() const
+  {
+    LockProfile profile;
+    for (std::size_t i = 0; i < m_shardCount; ++i)
+    {
+      const Shard& shard = m_shards[i];
+      const auto lk = shard.mu.acquire(StoreOp::Stats);
+      for (std::size_t op = 0; op < STORE_OP_COUNT; ++op)
+      {
+        const LockOpStats& from = shard.mu.profile().ops[op];
+        LockOpStats& to = profile.ops[op];
+        to.acquisitions += from.acquisitions;
+        to.contended += from.contended;
+        to.waitNs += from.waitNs;
+        to.holdNs += from.holdNs;
+        to.maxWaitNs = std::max(to.maxWaitNs, from.maxWaitNs);
+        to.maxHoldNs = std::max(to.maxHoldNs, from.maxHoldNs);
+      }
+    }
+    return profile;
+  }
+
+  void GameStore::finishHistory(GameState& game, int winnerIndex)
+  {
+    game.history.finishedAtMs = nowMs();
+    game.history.winner = static_cast<std::uint8_t>(winnerIndex + 1);
+    // Games finished again while replaying the log were recorded when they first ended.
+    if (m_recorder && !m_replaying)
+    {
+      m_recorder->submit(std::make_unique<GameRecord>(game.history));
+    }
+  }
+
+  std::size_t GameStore::attachEventLog(std::shared_ptr<EventLog> log)
+  {
+    const auto lk = lockAll(StoreOp::AttachLog);
+
+    std::size_t applied = 0;
+    if (log)
+    {
+      m_replaying = true;
+      for (const auto& ev : log->recovered())
+      {
+        if (applyLocked(ev))
+        {
+          ++applied;
+        }
+      }
+      m_replaying = false;
+      log->releaseRecovered();
+      log->advanceTo(m_restoredSeq);
+    }
+    m_log = std::move(log);
+    return applied;
+  }
+
+  std::size_t GameStore::writeSnapshot(const std::string& path) const
+  {
+    std::vector<std::pair<std::string, std::shared_ptr<GameState>>> games;
+    std::uint64_t baseSeq = 0;
+    {
+      const auto lk = lockAll(StoreOp::WriteSnapshot);
+      for (std::size_t i = 0; i < m_shardCount; ++i)
+      {
+        for (const auto& [id, game] : m_shards[i].games)
+        {
+          games.emplace_back(id, game);
+        }
+      }
+      baseSeq = m_log ? m_log->lastSeq() : 0;
+    }
+
+    // Each game is captured with its lastSeq, so games changing between chunks stay individually consistent.
+    SnapshotWriter writer{ path };
+    for (std::size_t begin = 0; begin < games.size(); begin += SnapshotWriter::GAMES_PER_CHUNK)
+    {
+      const std::size_t end = std::min(games.size(), begin + SnapshotWriter::GAMES_PER_CHUNK);
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        const auto lk = shardFor(games[i].first).mu.acquire(StoreOp::WriteSnapshot);
+        writer.addGame(*games[i].second);
+      }
+      writer.endChunk();
+    }
+    writer.commit(baseSeq);
+    return games.size();
+  }
+
+  bool GameStore::loadSnapshot(const std::string& path)
+  {
+    auto snapshot = readSnapshot(path);
+    if (!snapshot)
+    {
+      return false;
+    }
+
+    const auto lk = lockAll(StoreOp::LoadSnapshot);
+    // A game can be captured past baseSeq, with events appended while the snapshot was written.
+    m_restoredSeq = std::max(m_restoredSeq, snapshot->baseSeq);
+    for (auto& [id, game] : snapshot->games)
+    {
+      m_restoredSeq = std::max(m_restoredSeq, game->lastSeq);
+      Shard& shard = shardFor(id);
+      auto [it, inserted] = shard.games.try_emplace(std::move(id), game);
+      if (!inserted)
+      {
+        unindexGame(shard, *it->second);
+        it->second = std::move(game);
+      }
+      indexGame(shard, it->first, *it->second);
+    }
+    return true;
+  }
+
+  bool GameStore::applyLocked(const GameEvent& ev)
+  {
+    Shard& shard = shardFor(ev.gameId);
+    auto it = shard.games.find(ev.gameId);
+    if (it != shard.games.end() && it->second->lastSeq >= ev.seq)
+    {
+      // Already contained in the snapshot the game was restored from.
+      return false;
+    }
+
+    bool applied = false;
+    switch (ev.type)
+    {
+      case GameEventType::CreateGame:
+      {
+        auto g = std::make_shared<GameState>();
+        g->token[0] = ev.tokens[0];
+        g->token[1] = ev.tokens[1];
+        g->status = GameStatus::WaitingForPlayers;
+        startHistory(*g, ev.gameId);
+        std::tie(it, applied) = shard.games.emplace(ev.gameId, std::move(g));
+        if (applied)
+        {
+          indexGame(shard, it->first, *it->second);
+        }
+        break;
+      }
+      case GameEventType::JoinGame: applied = joinLocked(shard, ev.gameId).has_value(); break;
+      case GameEventType::PlaceShip:
+        applied = placeShipLocked(shard, ev.gameId, ev.player, ev.boat, ev.coordinate, ev.orientation).has_value();
+        break;
+      case GameEventType::ReadyUp: applied = readyUpLocked(shard, ev.gameId, ev.player).has_value(); break;
+      case GameEventType::Shoot: applied = shootLocked(shard, ev.gameId, ev.player, ev.coordinate).has_value(); break;
+    }
+
+    if (applied)
+    {
+      it->second->lastSeq = ev.seq;
+    }
+    return applied;
+  }
+
+  void GameStore::record(Shard& shard, GameEvent&& ev)
+  {
+    if (!m_log)
+    {
+      return;
+    }
+    auto it = shard.games.find(ev.gameId);
+    const std::uint64_t seq = m_log->append(std::move(ev));
+    if (it != shard.games.end())
+    {
+      it->second->lastSeq = seq;
+    }
+  }
+
+  void GameStore::recordPlacement(Shard& shard,
+                                  const std::string& gameId,
+                                  int playerIndex,
+                                  const battleship::FleetPlacement& ship)
+  {
+    if (m_log)
+    {
+      auto ev = makeEvent(GameEventType::PlaceShip, gameId, playerIndex);
+      ev.boat = ship.type;
+      ev.orientation = ship.placement.orientation;
+      ev.coordinate = ship.placement.coordinate;
+      record(shard, std::move(ev));
+    }
+  }
+
+  std::optional<GameHistory> GameStore::getHistory(const std::string& gameId) const
+  {
+    const Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::GetHistory);
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
+    {
+      return std::nullopt;
+    }
+    return GameHistory{ it->second->status, it->second->history };
+  }
+
   std::optional<GameView> GameStore::getGameView(const std::string& gameId) const
   {
-    std::lock_guard<std::mutex> lk(m_mu);
-    auto it = m_games.find(gameId);
-    if (it == m_games.end())
+    const Shard& shard = shardFor(gameId);
+    const auto lk = shard.mu.acquire(StoreOp::GetGameView);
+    auto it = shard.games.find(gameId);
+    if (it == shard.games.end())
     {
       return std::nullopt;
     }
@@ -207,6 +841,12 @@ namespace server
     v.turn = g.turn;
     v.ready[0] = g.ready[0];
     v.ready[1] = g.ready[1];
+    // Every mutation adds a join, a ready flag, a placement or a shot, so their count orders the views.
+    v.revision = g.history.fleets[0].size() + g.history.fleets[1].size() + g.history.shots.size();
+    for (const bool flag : { g.joined[1], g.ready[0], g.ready[1] })
+    {
+      v.revision += flag ? 1U : 0U;
+    }
 
     for (int p = 0; p < 2; ++p)
     {
@@ -3,12 +3,25 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <chrono>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "server/admission.hpp"
+#include "server/json_writer.hpp"
+#include "server/matchmaker.hpp"
+#include "server/metrics.hpp"
+#include "server/route_table.hpp"
+#include "server/spectator_hub.hpp"
+
+#include "project/core/replay.hpp"
+
 namespace server
 {
   namespace http = boost::beast::http;
@@ -16,53 +29,82 @@ namespace server
 
   namespace
   {
-    http::response<http::string_body> make_response(http::status status,
-                                                    std::string body,
-                                                    unsigned version,
-                                                    bool keep_alive,
-                                                    std::string_view content_type = "text/plain")
+    // Everything a route handler needs about the request being served. Handlers write into `res`, which may
+    // be a response object reused across requests on the same connection.
+    struct Exchange
     {
-      http::response<http::string_body> res{ status, version };
-      res.set(http::field::server, "BattleShip");
-      res.set(http::field::content_type, content_type);
-      res.keep_alive(keep_alive);
-      res.body() = std::move(body);
-      res.prepare_payload();
-      return res;
-    }
-
-    http::response<http::string_body> make_json_response(http::status status,
-                                                         const pt::ptree& body,
-                                                         unsigned version,
-                                                         bool keep_alive)
+      GameStore& store;
+      const http::request<http::string_body>& req;
+      http::response<http::string_body>& res;
+      std::string gameId;
+      int playerIndex{ -1 };
+      RequestTrace* trace{ nullptr };
+      bool streamsSpectators{ false };  // the connection turns an answered spectate request into a stream itself
+    };
+
+    void mark(Exchange& ex, TraceStage stage) noexcept
     {
-      std::ostringstream oss;
-      pt::write_json(oss, body, false);
-      return make_response(status, oss.str(), version, keep_alive, "application/json");
+      if (ex.trace != nullptr)
+      {
+        ex.trace->mark(stage);
+      }
     }
 
-    std::vector<std::string> split_path(std::string path)
+    // Reused responses already carry these headers; only touch a field when its value changes, so a warm
+    // response does not allocate a new field node.
+    void set_field(http::response<http::string_body>& res, http::field name, std::string_view value)
     {
-      const std::size_t query_pos = path.find('?');
-      if (query_pos != std::string::npos)
+      const auto it = res.find(name);
+      if (it != res.end() && std::string_view{ it->value().data(), it->value().size() } == value)
       {
-        path.erase(query_pos);
+        return;
       }
+      res.set(name, boost::beast::string_view{ value.data(), value.size() });
+    }
 
-      std::vector<std::string> parts;
-      std::stringstream ss(path);
-      std::string part;
-      while (std::getline(ss, part, '/'))
+    void finish_response(Exchange& ex, http::status status, std::string_view content_type)
+    {
+      auto& res = ex.res;
+      res.result(status);
+      res.version(ex.req.version());
+      set_field(res, http::field::server, "BattleShip");
+      set_field(res, http::field::content_type, content_type);
+      res.keep_alive(ex.req.keep_alive());
+      if (status != http::status::service_unavailable && status != http::status::too_many_requests)
       {
-        if (!part.empty())
-        {
-          parts.push_back(part);
-        }
+        res.erase(http::field::retry_after);
       }
-      return parts;
+
+      std::array<char, 24> length{};
+      const auto [end, ec] = std::to_chars(length.data(), length.data() + length.size(), res.body().size());
+      set_field(res, http::field::content_length, std::string_view{ length.data(), static_cast<std::size_t>(end - length.data()) });
+      mark(ex, TraceStage::Serialize);
     }
 
-    pt::ptree parse_json_or_throw(const std::string& body)
+    void respond(Exchange& ex, http::status status, std::string_view body)
+    {
+      mark(ex, TraceStage::Store);
+      ex.res.body().assign(body.data(), body.size());
+      finish_response(ex, status, "text/plain");
+    }
+
+    JsonWriter begin_json(Exchange& ex)
+    {
+      mark(ex, TraceStage::Store);
+      ex.res.body().clear();
+      JsonWriter json{ ex.res.body() };
+      json.beginObject();
+      return json;
+    }
+
+    void respond_json(Exchange& ex, JsonWriter& json, http::status status = http::status::ok)
+    {
+      json.endObject();
+      json.finish();
+      finish_response(ex, status, "application/json");
+    }
+
+    std::optional<pt::ptree> parse_json(const std::string& body)
     {
       std::istringstream iss(body);
       pt::ptree tree;
@@ -72,12 +114,19 @@ namespace server
       }
       catch (const pt::json_parser_error&)
       {
-        throw std::invalid_argument("Invalid JSON");
+        return std::nullopt;
       }
       return tree;
     }
 
-    battleship::BoatType parse_boat_type(const std::string& raw)
+    std::optional<pt::ptree> parse_body(Exchange& ex)
+    {
+      auto tree = parse_json(ex.req.body());
+      mark(ex, TraceStage::Parse);
+      return tree;
+    }
+
+    battleship::Expected<battleship::BoatType, const char*> parse_boat_type(std::string_view raw) noexcept
     {
       if (raw == "CARRIER")
       {
@@ -100,14 +149,14 @@ namespace server
         return battleship::BoatType::DESTROYER;
       }
 
-      throw std::invalid_argument("Invalid boat type.");
+      return battleship::unexpected("Invalid boat type.");
     }
 
-    battleship::Orientation parse_orientation(const std::string& raw)
+    battleship::Expected<battleship::Orientation, const char*> parse_orientation(std::string_view raw) noexcept
     {
       if (raw.size() != 1U)
       {
-        throw std::invalid_argument("Invalid orientation (use N/S/E/W). ");
+        return battleship::unexpected("Invalid orientation (use N/S/E/W). ");
       }
 
       switch (std::toupper(static_cast<unsigned char>(raw[0])))
@@ -116,11 +165,87 @@ namespace server
         case 'S': return battleship::Orientation::SOUTH;
         case 'E': return battleship::Orientation::EAST;
         case 'W': return battleship::Orientation::WEST;
-        default: throw std::invalid_argument("Invalid orientation (use N/S/E/W). ");
+        default: return battleship::unexpected("Invalid orientation (use N/S/E/W). ");
+      }
+    }
+
+    // Reads one {"type","start","orientation"} object as sent to /place and inside /fleet.
+    battleship::Expected<battleship::FleetPlacement, const char*> parse_ship(const pt::ptree& ship)
+    {
+      const auto type = ship.get_optional<std::string>("type");
+      const auto start = ship.get_optional<std::string>("start");
+      const auto orientation = ship.get_optional<std::string>("orientation");
+      if (!type.has_value() || !start.has_value() || !orientation.has_value())
+      {
+        return battleship::unexpected("Missing fields: type/start/orientation");
       }
+
+      const auto boat_type = parse_boat_type(*type);
+      if (!boat_type)
+      {
+        return battleship::unexpected(boat_type.error());
+      }
+      const auto start_coord = battleship::Coordinate::tryParse(*start);
+      if (!start_coord)
+      {
+        return battleship::unexpected(start_coord.error());
+      }
+      const auto orient = parse_orientation(*orientation);
+      if (!orient)
+      {
+        return battleship::unexpected(orient.error());
+      }
+
+      return battleship::FleetPlacement{ .type = *boat_type,
+                                         .placement = battleship::Placement{ *start_coord, *orient } };
     }
 
-    std::string cell_state_to_string(battleship::CellState state)
+    http::status status_for(StoreError error) noexcept
+    {
+      switch (error)
+      {
+        case StoreError::GameNotFound: return http::status::not_found;
+        case StoreError::GameFull:
+        case StoreError::NotInProgress:
+        case StoreError::NotYourTurn:
+        case StoreError::AlreadyShot:
+        case StoreError::FleetAlreadyPlaced: return http::status::conflict;
+        case StoreError::LogUnavailable: return http::status::service_unavailable;
+        default: return http::status::bad_request;
+      }
+    }
+
+    void respond_error(Exchange& ex, StoreError error)
+    {
+      respond(ex, status_for(error), to_cstr(error));
+    }
+
+    const char* boat_type_to_string(battleship::BoatType type)
+    {
+      switch (type)
+      {
+        case battleship::BoatType::CARRIER: return "CARRIER";
+        case battleship::BoatType::BATTLESHIP: return "BATTLESHIP";
+        case battleship::BoatType::CRUISER: return "CRUISER";
+        case battleship::BoatType::SUBMARINE: return "SUBMARINE";
+        case battleship::BoatType::DESTROYER: return "DESTROYER";
+      }
+      return "UNKNOWN";
+    }
+
+    const char* orientation_to_string(battleship::Orientation orientation)
+    {
+      switch (orientation)
+      {
+        case battleship::Orientation::NORTH: return "N";
+        case battleship::Orientation::SOUTH: return "S";
+        case battleship::Orientation::EAST: return "E";
+        case battleship::Orientation::WEST: return "W";
+      }
+      return "?";
+    }
+
+    const char* cell_state_to_string(battleship::CellState state)
     {
       switch (state)
       {
@@ -132,222 +257,628 @@ namespace server
       return "unknown";
     }
 
-    pt::ptree make_board_json(const GameView& view, int board_index, bool reveal_occupied)
+    // Reads the number in query parameter `name` into `out`, leaving it alone when absent; false when malformed.
+    template<typename T>
+    bool query_number(std::string_view target, std::string_view name, T& out)
+    {
+      const auto param = query_param(target, name);
+      if (!param.has_value())
+      {
+        return true;
+      }
+      const auto [end, ec] = std::from_chars(param->data(), param->data() + param->size(), out);
+      return ec == std::errc{} && end == param->data() + param->size();
+    }
+
+    void write_board_json(JsonWriter& json, std::string_view key, const GameView& view, int board_index, bool reveal_occupied)
     {
-      pt::ptree board;
-      board.put("width", static_cast<int>(battleship::BOARD_SIZE));
-      board.put("height", static_cast<int>(battleship::BOARD_SIZE));
+      json.beginObject(key);
+      json.field("width", static_cast<int>(battleship::BOARD_SIZE));
+      json.field("height", static_cast<int>(battleship::BOARD_SIZE));
 
-      pt::ptree cells;
-      for (int r = 0; r < static_cast<int>(battleship::BOARD_SIZE); ++r)
+      json.beginArray("cells");
+      for (const auto& row : view.boards[board_index].cells)
       {
-        for (int c = 0; c < static_cast<int>(battleship::BOARD_SIZE); ++c)
+        for (auto state : row)
         {
-          auto state = view.boards[board_index].cells[static_cast<std::size_t>(r)][static_cast<std::size_t>(c)];
           if (!reveal_occupied && state == battleship::CellState::OCCUPIED)
           {
             state = battleship::CellState::EMPTY;
           }
-
-          pt::ptree cell_value;
-          cell_value.put("", cell_state_to_string(state));
-          cells.push_back({ "", cell_value });
+          json.element(cell_state_to_string(state));
         }
       }
+      json.endArray();
+
+      json.endObject();
+    }
 
-      board.add_child("cells", cells);
-      return board;
+    std::string spectator_frame(const std::string& game_id, const GameView& view, SpectatorPolicy policy)
+    {
+      const bool reveal = policy == SpectatorPolicy::Revealed || view.status == GameStatus::Finished;
+
+      std::string frame{ "data: " };
+      JsonWriter json{ frame };
+      json.beginObject();
+      json.field("gameId", game_id);
+      json.field("status", to_cstr(view.status));
+      json.field("turnPlayerId", view.turn + 1);
+      json.field("revision", view.revision);
+      json.field("player1Ready", view.ready[0]);
+      json.field("player2Ready", view.ready[1]);
+      write_board_json(json, "player1Board", view, 0, reveal);
+      write_board_json(json, "player2Board", view, 1, reveal);
+      json.endObject();
+      json.finish();
+      frame.push_back('\n');  // the blank line that ends an event
+      return frame;
     }
 
-    AuthContext authenticate_request(const GameStore& store,
-                                     const std::string& game_id,
-                                     const http::request<http::string_body>& req)
+    int authenticate_request(const GameStore& store,
+                             const std::string& game_id,
+                             const http::request<http::string_body>& req)
     {
       const auto auth_it = req.find(http::field::authorization);
       if (auth_it == req.end())
       {
-        return AuthContext{};
+        return -1;
       }
-      return store.authenticate(game_id, std::string(auth_it->value()));
+      return store.authorizedPlayer(game_id, std::string_view{ auth_it->value().data(), auth_it->value().size() });
     }
-  }  // namespace
 
-  http::response<http::string_body> handle_request(GameStore& store, http::request<http::string_body> req)
-  {
-    const auto version = req.version();
-    const bool keep_alive = req.keep_alive();
-    const auto parts = split_path(std::string(req.target()));
+    void handle_create_game(Exchange& ex)
+    {
+      const auto created = ex.store.tryCreateGame();
+      if (!created)
+      {
+        return respond_error(ex, created.error());
+      }
 
-    if (req.method() == http::verb::post && parts.size() == 1 && parts[0] == "games")
+      auto json = begin_json(ex);
+      json.field("gameId", created->gameId);
+      json.field("playerId", created->playerId);
+      json.field("playerToken", created->playerToken);
+      json.field("status", to_cstr(created->status));
+      respond_json(ex, json);
+    }
+
+    // Lobby listing: `?status=` (default waiting_for_players), `?limit=` (1 to MAX_LIST_LIMIT, default 20) and
+    // `?cursor=` from the previous page's nextCursor.
+    void handle_list_games(Exchange& ex)
     {
-      const auto created = store.createGame();
-      pt::ptree body;
-      body.put("gameId", created.gameId);
-      body.put("playerId", created.playerId);
-      body.put("playerToken", created.playerToken);
-      body.put("status", to_cstr(created.status));
-      return make_json_response(http::status::ok, body, version, keep_alive);
+      constexpr std::size_t DEFAULT_LIST_LIMIT = 20;
+      constexpr std::size_t MAX_LIST_LIMIT = 100;
+
+      const auto raw_target = ex.req.target();
+      const std::string_view target{ raw_target.data(), raw_target.size() };
+      auto status = std::optional<GameStatus>{ GameStatus::WaitingForPlayers };
+      if (const auto param = query_param(target, "status"))
+      {
+        status = parseGameStatus(*param);
+      }
+      if (!status.has_value())
+      {
+        return respond(ex, http::status::bad_request, "Invalid status");
+      }
+
+      std::size_t limit = DEFAULT_LIST_LIMIT;
+      if (!query_number(target, "limit", limit) || limit == 0 || limit > MAX_LIST_LIMIT)
+      {
+        return respond(ex, http::status::bad_request, "Invalid limit");
+      }
+      std::uint64_t cursor = 0;
+      if (!query_number(target, "cursor", cursor))
+      {
+        return respond(ex, http::status::bad_request, "Invalid cursor");
+      }
+
+      const auto listing = ex.store.listGames(*status, limit, cursor);
+
+      auto json = begin_json(ex);
+      json.field("status", to_cstr(*status));
+      json.beginArray("gameIds");
+      for (const auto& id : listing.gameIds)
+      {
+        json.element(id);
+      }
+      json.endArray();
+      if (listing.nextCursor != 0)
+      {
+        json.field("nextCursor", std::to_string(listing.nextCursor));
+      }
+      respond_json(ex, json);
     }
 
-    if (parts.size() < 2 || parts[0] != "games")
+    void handle_join_game(Exchange& ex)
     {
-      return make_response(http::status::not_found, "Not found", version, keep_alive);
+      const auto joined = ex.store.tryJoinGame(ex.gameId);
+      if (!joined)
+      {
+        return respond_error(ex, joined.error());
+      }
+
+      auto json = begin_json(ex);
+      json.field("gameId", joined->gameId);
+      json.field("playerId", joined->playerId);
+      json.field("playerToken", joined->playerToken);
+      json.field("status", to_cstr(joined->status));
+      respond_json(ex, json);
     }
 
-    const std::string& game_id = parts[1];
+    void handle_get_game(Exchange& ex)
+    {
+      const auto view = ex.store.getGameView(ex.gameId);
+      if (!view.has_value())
+      {
+        return respond(ex, http::status::not_found, "Game not found.");
+      }
 
-    if (req.method() == http::verb::post && parts.size() == 3 && parts[2] == "join")
+      auto json = begin_json(ex);
+      json.field("gameId", ex.gameId);
+      json.field("status", to_cstr(view->status));
+      json.field("turnPlayerId", view->turn + 1);
+      json.beginObject("you");
+      json.field("playerId", ex.playerIndex + 1);
+      json.field("ready", view->ready[ex.playerIndex]);
+      json.endObject();
+      write_board_json(json, "yourBoard", *view, ex.playerIndex, true);
+      write_board_json(json, "enemyBoard", *view, 1 - ex.playerIndex, false);
+      respond_json(ex, json);
+    }
+
+    // Move log plus the position after `?move=N` (default: the latest move). The opponent's ships stay hidden
+    // until the game is finished.
+    void handle_get_history(Exchange& ex)
     {
-      try
+      const auto history = ex.store.getHistory(ex.gameId);
+      if (!history.has_value())
       {
-        const auto joined = store.joinGame(game_id);
-        pt::ptree body;
-        body.put("gameId", joined.gameId);
-        body.put("playerId", joined.playerId);
-        body.put("playerToken", joined.playerToken);
-        body.put("status", to_cstr(joined.status));
-        return make_json_response(http::status::ok, body, version, keep_alive);
+        return respond(ex, http::status::not_found, "Game not found.");
       }
-      catch (const std::runtime_error& e)
+      const auto& record = history->record;
+
+      std::array<std::vector<battleship::FleetPlacement>, 2> fleets;
+      for (std::size_t p = 0; p < 2; ++p)
       {
-        const std::string message = e.what();
-        if (message == "Game already has 2 players.")
+        for (const auto packed : record.fleets[p])
         {
-          return make_response(http::status::conflict, message, version, keep_alive);
+          fleets[p].push_back(GameRecord::unpackPlacement(packed));
         }
-        if (message == "Game not found.")
-        {
-          return make_response(http::status::not_found, message, version, keep_alive);
-        }
-        return make_response(http::status::bad_request, message, version, keep_alive);
       }
+      std::vector<battleship::ReplayMove> moves;
+      moves.reserve(record.shots.size());
+      for (std::size_t i = 0; i < record.shots.size(); ++i)
+      {
+        moves.push_back(battleship::ReplayMove{ static_cast<int>(i % 2), GameRecord::unpackCell(record.shots[i]) });
+      }
+
+      std::size_t move = moves.size();
+      const auto target = ex.req.target();
+      if (!query_number(std::string_view{ target.data(), target.size() }, "move", move) || move > moves.size())
+      {
+        return respond(ex, http::status::bad_request, "Invalid move");
+      }
+
+      battleship::Replay replay{ fleets, std::move(moves) };
+      const auto position = replay.positionAt(move);
+      const bool finished = history->status == GameStatus::Finished;
+
+      auto json = begin_json(ex);
+      json.field("gameId", ex.gameId);
+      json.field("status", to_cstr(history->status));
+      json.field("moveCount", replay.moveCount());
+      if (record.winner != 0)
+      {
+        json.field("winnerPlayerId", static_cast<int>(record.winner));
+      }
+
+      json.beginArray("moves");
+      for (std::size_t i = 0; i < replay.moveCount(); ++i)
+      {
+        json.beginObject();
+        json.field("playerId", static_cast<int>(i % 2) + 1);
+        json.field("target", GameRecord::unpackCell(record.shots[i]).toString());
+        json.field("result", (record.shots[i] & GameRecord::HIT_BIT) != 0 ? "hit" : "miss");
+        json.endObject();
+      }
+      json.endArray();
+
+      GameView view;
+      view.boards[0].cells = position.boards[0];
+      view.boards[1].cells = position.boards[1];
+      json.beginObject("position");
+      json.field("move", position.move);
+      if (position.winner >= 0)
+      {
+        json.field("winnerPlayerId", position.winner + 1);
+      }
+      else
+      {
+        json.field("turnPlayerId", static_cast<int>(position.move % 2) + 1);
+      }
+      write_board_json(json, "yourBoard", view, ex.playerIndex, true);
+      write_board_json(json, "enemyBoard", view, 1 - ex.playerIndex, finished);
+      json.endObject();
+      respond_json(ex, json);
     }
 
-    const AuthContext auth = authenticate_request(store, game_id, req);
-    if (auth.playerIndex < 0)
+    void handle_debug_traces(Exchange& ex)
     {
-      return make_response(http::status::unauthorized, "Unauthorized", version, keep_alive);
+      mark(ex, TraceStage::Store);
+      ex.res.body().clear();
+      tracer().writeChromeTrace(ex.res.body());
+      finish_response(ex, http::status::ok, "application/json");
     }
 
-    if (req.method() == http::verb::get && parts.size() == 2)
+    void handle_metrics(Exchange& ex)
     {
-      const auto view = store.getGameView(game_id);
-      if (!view.has_value())
+      mark(ex, TraceStage::Store);
+      ex.res.body().clear();
+      metrics().writePrometheus(ex.res.body(), ex.store);
+      finish_response(ex, http::status::ok, "text/plain; version=0.0.4");
+    }
+
+    void handle_place_ship(Exchange& ex)
+    {
+      const auto payload = parse_body(ex);
+      if (!payload.has_value())
+      {
+        return respond(ex, http::status::bad_request, "Invalid JSON");
+      }
+
+      const auto ship = parse_ship(*payload);
+      if (!ship)
       {
-        return make_response(http::status::not_found, "Game not found.", version, keep_alive);
+        return respond(ex, http::status::bad_request, ship.error());
       }
 
-      pt::ptree body;
-      body.put("gameId", game_id);
-      body.put("status", to_cstr(view->status));
-      body.put("turnPlayerId", view->turn + 1);
-      body.put("you.playerId", auth.playerIndex + 1);
-      body.put("you.ready", view->ready[auth.playerIndex]);
-      body.add_child("yourBoard", make_board_json(*view, auth.playerIndex, true));
-      body.add_child("enemyBoard", make_board_json(*view, 1 - auth.playerIndex, false));
-      return make_json_response(http::status::ok, body, version, keep_alive);
+      const auto error = ex.store.tryPlaceShip(
+          ex.gameId, ex.playerIndex, ship->type, ship->placement.coordinate, ship->placement.orientation);
+      if (error.has_value())
+      {
+        return respond_error(ex, *error);
+      }
+
+      auto json = begin_json(ex);
+      json.field("ok", true);
+      respond_json(ex, json);
     }
 
-    if (req.method() == http::verb::post && parts.size() == 3 && parts[2] == "place")
+    void handle_place_fleet(Exchange& ex)
     {
-      try
+      const auto payload = parse_body(ex);
+      if (!payload.has_value())
       {
-        const pt::ptree payload = parse_json_or_throw(req.body());
+        return respond(ex, http::status::bad_request, "Invalid JSON");
+      }
 
-        const auto type = payload.get_optional<std::string>("type");
-        const auto start = payload.get_optional<std::string>("start");
-        const auto orientation = payload.get_optional<std::string>("orientation");
-        if (!type.has_value() || !start.has_value() || !orientation.has_value())
+      const auto ships = payload->get_child_optional("ships");
+      if (!ships.has_value() || ships->empty())
+      {
+        return respond(ex, http::status::bad_request, "Missing field: ships");
+      }
+
+      std::vector<battleship::FleetPlacement> fleet;
+      fleet.reserve(ships->size());
+      for (const auto& [key, node] : *ships)
+      {
+        const auto ship = parse_ship(node);
+        if (!ship)
         {
-          return make_response(http::status::bad_request, "Missing fields: type/start/orientation", version, keep_alive);
+          return respond(ex, http::status::bad_request, ship.error());
         }
+        fleet.push_back(*ship);
+      }
 
-        const auto boat_type = parse_boat_type(*type);
-        const auto start_coord = battleship::Coordinate::parseFromString(*start);
-        const auto orient = parse_orientation(*orientation);
+      if (const auto error = ex.store.tryPlaceFleet(ex.gameId, ex.playerIndex, fleet); error.has_value())
+      {
+        return respond_error(ex, *error);
+      }
 
-        store.placeShip(game_id, auth.playerIndex, boat_type, start_coord, orient);
+      auto json = begin_json(ex);
+      json.field("ok", true);
+      json.field("placed", fleet.size());
+      respond_json(ex, json);
+    }
 
-        pt::ptree body;
-        body.put("ok", true);
-        return make_json_response(http::status::ok, body, version, keep_alive);
+    void handle_place_random_fleet(Exchange& ex)
+    {
+      const auto fleet = ex.store.tryPlaceRandomFleet(ex.gameId, ex.playerIndex);
+      if (!fleet)
+      {
+        return respond_error(ex, fleet.error());
       }
-      catch (const std::invalid_argument& e)
+
+      auto json = begin_json(ex);
+      json.field("ok", true);
+      json.beginArray("ships");
+      for (const auto& entry : *fleet)
       {
-        return make_response(http::status::bad_request, e.what(), version, keep_alive);
+        json.beginObject();
+        json.field("type", boat_type_to_string(entry.type));
+        json.field("start", entry.placement.coordinate.toString());
+        json.field("orientation", orientation_to_string(entry.placement.orientation));
+        json.endObject();
       }
-      catch (const std::runtime_error& e)
+      json.endArray();
+      respond_json(ex, json);
+    }
+
+    void handle_ready_up(Exchange& ex)
+    {
+      const auto status = ex.store.tryReadyUp(ex.gameId, ex.playerIndex);
+      if (!status)
       {
-        const std::string message = e.what();
-        if (message == "Game not found.")
-        {
-          return make_response(http::status::not_found, message, version, keep_alive);
-        }
-        return make_response(http::status::bad_request, message, version, keep_alive);
+        return respond_error(ex, status.error());
       }
+
+      auto json = begin_json(ex);
+      json.field("status", to_cstr(*status));
+      respond_json(ex, json);
     }
 
-    if (req.method() == http::verb::post && parts.size() == 3 && parts[2] == "ready")
+    void handle_shoot(Exchange& ex)
     {
-      try
+      const auto payload = parse_body(ex);
+      if (!payload.has_value())
       {
-        const auto status = store.readyUp(game_id, auth.playerIndex);
+        return respond(ex, http::status::bad_request, "Invalid JSON");
+      }
 
-        pt::ptree body;
-        body.put("status", to_cstr(status));
-        return make_json_response(http::status::ok, body, version, keep_alive);
+      const auto target = payload->get_optional<std::string>("target");
+      if (!target.has_value())
+      {
+        return respond(ex, http::status::bad_request, "Missing field: target");
       }
-      catch (const std::runtime_error& e)
+
+      const auto target_coord = battleship::Coordinate::tryParse(*target);
+      if (!target_coord)
       {
-        const std::string message = e.what();
-        if (message == "Game not found.")
-        {
-          return make_response(http::status::not_found, message, version, keep_alive);
-        }
-        return make_response(http::status::bad_request, message, version, keep_alive);
+        return respond(ex, http::status::bad_request, target_coord.error());
       }
+
+      const auto out = ex.store.tryShoot(ex.gameId, ex.playerIndex, *target_coord);
+      if (!out)
+      {
+        return respond_error(ex, out.error());
+      }
+
+      auto json = begin_json(ex);
+      json.field("result", out->result);
+      json.field("nextTurnPlayerId", out->nextTurnPlayerId);
+      json.field("status", to_cstr(out->status));
+      respond_json(ex, json);
     }
 
-    if (req.method() == http::verb::post && parts.size() == 3 && parts[2] == "shoot")
+    void respond_match(Exchange& ex, const std::string& ticket, const MatchStatus& status)
     {
-      try
+      auto json = begin_json(ex);
+      json.field("ticket", ticket);
+      if (!status.matched)
       {
-        const pt::ptree payload = parse_json_or_throw(req.body());
-        const auto target = payload.get_optional<std::string>("target");
-        if (!target.has_value())
+        json.field("status", "waiting");
+        return respond_json(ex, json, http::status::accepted);
+      }
+      json.field("status", "matched");
+      json.field("gameId", status.seat.gameId);
+      json.field("playerId", status.seat.playerId);
+      json.field("playerToken", status.seat.playerToken);
+      json.field("gameStatus", to_cstr(status.seat.status));
+      respond_json(ex, json);
+    }
+
+    // Optional body {"bucket": n}: only players of the same bucket are paired.
+    void handle_matchmake(Exchange& ex)
+    {
+      auto* matchmaker = ex.store.matchmaker();
+      if (matchmaker == nullptr)
+      {
+        return respond(ex, http::status::not_found, "Matchmaking is disabled");
+      }
+
+      std::size_t bucket = 0;
+      if (!ex.req.body().empty())
+      {
+        const auto payload = parse_body(ex);
+        if (!payload.has_value())
+        {
+          return respond(ex, http::status::bad_request, "Invalid JSON");
+        }
+        const auto requested = payload->get_optional<std::size_t>("bucket");
+        if (payload->count("bucket") != 0 && (!requested.has_value() || *requested >= Matchmaker::BUCKETS))
         {
-          return make_response(http::status::bad_request, "Missing field: target", version, keep_alive);
+          return respond(ex, http::status::bad_request, "Invalid bucket");
         }
+        bucket = requested.value_or(0);
+      }
+
+      const auto ticket = matchmaker->enqueue(bucket);
+      if (!ticket.has_value())
+      {
+        set_field(ex.res, http::field::retry_after, "1");
+        return respond(ex, http::status::service_unavailable, "Matchmaking is full, retry later");
+      }
+      respond_match(ex, *ticket, MatchStatus{});
+    }
+
+    void handle_get_match(Exchange& ex)
+    {
+      auto* matchmaker = ex.store.matchmaker();
+      const auto status = matchmaker != nullptr ? matchmaker->poll(ex.gameId) : std::nullopt;
+      if (!status.has_value())
+      {
+        return respond(ex, http::status::not_found, "Ticket not found.");
+      }
+      respond_match(ex, ex.gameId, *status);
+    }
 
-        const auto target_coord = battleship::Coordinate::parseFromString(*target);
-        const auto out = store.shoot(game_id, auth.playerIndex, target_coord);
+    // A streaming backend only needs the status: it sends the stream head and the hub's frames itself, so the
+    // frame is not serialized for it. Anywhere else the connection is answered with the current frame alone,
+    // which an EventSource client re-requests when the response ends.
+    void handle_spectate(Exchange& ex)
+    {
+      auto* hub = ex.store.spectators();
+      if (hub == nullptr)
+      {
+        return respond(ex, http::status::not_found, "Spectating is disabled");
+      }
+      const auto view = ex.store.getGameView(ex.gameId);
+      if (!view.has_value())
+      {
+        return respond(ex, http::status::not_found, "Game not found.");
+      }
 
-        pt::ptree body;
-        body.put("result", out.result);
-        body.put("nextTurnPlayerId", out.nextTurnPlayerId);
-        body.put("status", to_cstr(out.status));
-        return make_json_response(http::status::ok, body, version, keep_alive);
+      mark(ex, TraceStage::Store);
+      if (ex.streamsSpectators)
+      {
+        ex.res.body().clear();
       }
-      catch (const std::invalid_argument& e)
+      else
       {
-        return make_response(http::status::bad_request, e.what(), version, keep_alive);
+        ex.res.body() = spectator_frame(ex.gameId, *view, hub->policy());
       }
-      catch (const std::runtime_error& e)
+      finish_response(ex, http::status::ok, "text/event-stream");
+    }
+
+    bool changes_game(RouteId id) noexcept
+    {
+      switch (id)
       {
-        const std::string message = e.what();
-        if (message == "Game not in progress." || message == "Not your turn." || message == "Cell has already been shot.")
-        {
-          return make_response(http::status::conflict, message, version, keep_alive);
-        }
-        if (message == "Game not found.")
+        case RouteId::JoinGame:
+        case RouteId::PlaceShip:
+        case RouteId::PlaceFleet:
+        case RouteId::PlaceRandomFleet:
+        case RouteId::ReadyUp:
+        case RouteId::Shoot: return true;
+        default: return false;
+      }
+    }
+
+    // Answers a request turned away by admission control; nothing past the route lookup has run for it.
+    void respond_rejected(Exchange& ex, Admission admission)
+    {
+      set_field(ex.res, http::field::retry_after, "1");
+      if (admission == Admission::Overloaded)
+      {
+        return respond(ex, http::status::service_unavailable, "Overloaded, retry later");
+      }
+      if (admission == Admission::RateLimited)
+      {
+        return respond(ex, http::status::too_many_requests, "Rate limit exceeded");
+      }
+      respond(ex, http::status::too_many_requests, "Too many requests in flight for this token");
+    }
+
+    std::string_view authorization(const http::request<http::string_body>& req)
+    {
+      const auto it = req.find(http::field::authorization);
+      return it == req.end() ? std::string_view{} : std::string_view{ it->value().data(), it->value().size() };
+    }
+
+    void dispatch(const RouteMatch& route, Exchange& ex)
+    {
+      if (route.requiresAuth)
+      {
+        ex.playerIndex = authenticate_request(ex.store, ex.gameId, ex.req);
+        mark(ex, TraceStage::Auth);
+        if (ex.playerIndex < 0)
         {
-          return make_response(http::status::not_found, message, version, keep_alive);
+          return respond(ex, http::status::unauthorized, "Unauthorized");
         }
-        return make_response(http::status::bad_request, message, version, keep_alive);
       }
+
+      switch (route.id)
+      {
+        case RouteId::CreateGame: return handle_create_game(ex);
+        case RouteId::ListGames: return handle_list_games(ex);
+        case RouteId::JoinGame: return handle_join_game(ex);
+        case RouteId::GetGame: return handle_get_game(ex);
+        case RouteId::PlaceShip: return handle_place_ship(ex);
+        case RouteId::PlaceFleet: return handle_place_fleet(ex);
+        case RouteId::PlaceRandomFleet: return handle_place_random_fleet(ex);
+        case RouteId::ReadyUp: return handle_ready_up(ex);
+        case RouteId::Shoot: return handle_shoot(ex);
+        case RouteId::GetHistory: return handle_get_history(ex);
+        case RouteId::Spectate: return handle_spectate(ex);
+        case RouteId::Matchmake: return handle_matchmake(ex);
+        case RouteId::GetMatch: return handle_get_match(ex);
+        case RouteId::Metrics: return handle_metrics(ex);
+        case RouteId::DebugTraces: return handle_debug_traces(ex);
+        case RouteId::NotFound: break;
+      }
+
+      respond(ex, http::status::not_found, "Not found");
+    }
+  }  // namespace
+
+  void handle_request(GameStore& store,
+                      const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      RequestTrace* trace,
+                      AdmissionTicket* admission)
+  {
+    const auto target = req.target();
+    handle_request(store, match_route(req.method(), std::string_view{ target.data(), target.size() }), req, res, trace,
+                   admission);
+  }
+
+  void handle_request(GameStore& store,
+                      const RouteMatch& route,
+                      const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      RequestTrace* trace,
+                      AdmissionTicket* admission,
+                      bool streamsSpectators)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    Exchange ex{ .store = store,
+                 .req = req,
+                 .res = res,
+                 .gameId = std::string(route.gameId),
+                 .trace = trace,
+                 .streamsSpectators = streamsSpectators };
+    mark(ex, TraceStage::Route);
+    if (const auto verdict = admission != nullptr ? admission->admit(priorityOf(route.id), authorization(req))
+                                                  : Admission::Admitted;
+        verdict != Admission::Admitted)
+    {
+      respond_rejected(ex, verdict);
+    }
+    else
+    {
+      dispatch(route, ex);
     }
 
-    return make_response(http::status::not_found, "Not found", version, keep_alive);
+    if (auto* hub = store.spectators();
+        hub != nullptr && changes_game(route.id) && res.result_int() < 300 && hub->watched(ex.gameId))
+    {
+      publish_spectator_frame(store, *hub, ex.gameId);
+    }
+
+    metrics().recordRequest(route.id, res.result_int(), std::chrono::steady_clock::now() - start);
+    if (trace != nullptr)
+    {
+      trace->route = route.id;
+      trace->status = res.result_int();
+    }
+  }
+
+  bool publish_spectator_frame(const GameStore& store, SpectatorHub& hub, const std::string& gameId)
+  {
+    const auto view = store.getGameView(gameId);
+    if (!view.has_value())
+    {
+      return false;
+    }
+    hub.publish(gameId, view->revision, std::make_shared<const std::string>(spectator_frame(gameId, *view, hub.policy())));
+    return true;
+  }
+
+  http::response<http::string_body> handle_request(GameStore& store, http::request<http::string_body> req)
+  {
+    http::response<http::string_body> res;
+    handle_request(store, req, res);
+    return res;
   }
 
 }  // namespace server
@@ -3,11 +3,21 @@
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 
+#include <csignal>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "server/admission.hpp"
 #include "server/http_router.hpp"
+#include "server/metrics.hpp"
+#include "server/route_table.hpp"
+#include "server/spectator_hub.hpp"
 
 namespace server
 {
@@ -16,58 +26,634 @@ namespace server
   namespace http = boost::beast::http;
   using tcp = asio::ip::tcp;
 
+  class HttpSession;
+
   namespace
   {
-    void do_session(tcp::socket socket, GameStore& store)
+    // Rate-limiting key of the peer's address; 0 when the socket has none.
+    std::uint64_t client_key(const tcp::socket& socket)
     {
-      beast::flat_buffer buffer;
+      beast::error_code ec;
+      const auto address = socket.remote_endpoint(ec).address();
+      if (ec)
+      {
+        return 0;
+      }
+      if (address.is_v4())
+      {
+        const auto bytes = address.to_v4().to_bytes();
+        return RateLimiter::keyFor({ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+      }
+      const auto bytes = address.to_v6().to_bytes();
+      return RateLimiter::keyFor({ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+    }
+  }  // namespace
 
-      for (;;)
+  // The event loop, listening socket and I/O threads of a started HttpServer, plus the registry of open sessions
+  // that draining walks. The acceptor and the drain timer are only touched on the acceptor's strand.
+  class ServerRuntime
+  {
+  public:
+    ServerRuntime(GameStore& gameStore, const ServerConfig& serverConfig, BufferPool& bufferPool)
+        : store(gameStore),
+          config(serverConfig),
+          pool(bufferPool),
+          admission(serverConfig.maxInFlight,
+                    serverConfig.maxInFlightPerToken,
+                    serverConfig.tokenRate,
+                    serverConfig.clientRate),
+          m_ioc(static_cast<int>(serverConfig.ioThreads)),
+          m_acceptor(asio::make_strand(m_ioc)),
+          m_drainTimer(m_acceptor.get_executor()),
+          m_signals(m_ioc, SIGTERM, SIGINT),
+          m_profileSignal(m_ioc)
+    {
+      if (serverConfig.gameActors)
       {
-        http::request<http::string_body> req;
-        beast::error_code ec;
-        http::read(socket, buffer, req, ec);
-        if (ec == http::error::end_of_stream)
+        for (std::size_t i = 0; i < gameStore.shardCount(); ++i)
         {
-          break;
+          m_gameStrands.push_back(asio::make_strand(m_ioc));
         }
-        if (ec)
+      }
+    }
+
+    ~ServerRuntime() { m_stopped.store(true, std::memory_order_release); }
+
+    ServerRuntime(const ServerRuntime&) = delete;
+    ServerRuntime& operator=(const ServerRuntime&) = delete;
+
+    // Binds and starts accepting once the loop runs; SIGTERM and SIGINT start a drain. With lock profiling
+    // compiled in, SIGUSR1 prints the store's lock profile to stderr until the drain.
+    void listen();
+    void runThreads();
+    void join();
+    void stop();
+    void sessionClosed(std::uint64_t id);
+
+    bool draining() const noexcept { return m_draining.load(std::memory_order_acquire); }
+    bool gameActors() const noexcept { return !m_gameStrands.empty(); }
+
+    // The strand owning `gameId`'s shard; requests without a game take the strands in turn.
+    asio::strand<asio::io_context::executor_type>& gameStrand(std::string_view gameId)
+    {
+      const std::size_t index = gameId.empty() ? m_nextGameStrand.fetch_add(1, std::memory_order_relaxed)
+                                               : store.shardOf(gameId);
+      return m_gameStrands[index % m_gameStrands.size()];
+    }
+    bool running() const noexcept { return !m_threads.empty(); }
+    std::uint16_t port() const { return m_acceptor.local_endpoint().port(); }
+
+    GameStore& store;
+    const ServerConfig& config;
+    BufferPool& pool;
+    AdmissionControl admission;
+
+  private:
+    void doAccept();
+    void onAccept(const beast::error_code& ec, tcp::socket socket);
+    void beginDrain();
+    void awaitProfileSignal();
+
+  private:
+    std::mutex m_sessionsMu;
+    std::unordered_map<std::uint64_t, std::weak_ptr<HttpSession>> m_sessions;
+    std::uint64_t m_nextHttpSessionId{ 0 };
+    std::atomic<std::size_t> m_open{ 0 };
+    std::atomic<bool> m_draining{ false };
+    std::atomic<bool> m_stopped{ false };
+    bool m_acceptPaused{ false };
+
+    // After the registry: sessions still held by queued handlers are released when the loop is destroyed.
+    asio::io_context m_ioc;
+    tcp::acceptor m_acceptor;
+    asio::steady_timer m_drainTimer;
+    asio::signal_set m_signals;
+    asio::signal_set m_profileSignal;
+    std::vector<asio::strand<asio::io_context::executor_type>> m_gameStrands;
+    std::atomic<std::size_t> m_nextGameStrand{ 0 };
+    std::vector<std::thread> m_threads;
+  };
+
+  // One connection. Every step runs on the connection's strand, and the session stays alive for as long as a
+  // handler holds it.
+  //
+  // An answered GET /games/{id}/spectate turns the connection into a spectator stream: the session subscribes
+  // to the game and writes each frame the hub hands it, the shared buffer itself. At most one frame is being
+  // written; a viewer too slow for the updates skips to the latest one instead of queueing them.
+  class HttpSession : public std::enable_shared_from_this<HttpSession>, public SpectatorViewer
+  {
+  public:
+    HttpSession(tcp::socket&& socket, ServerRuntime& runtime, std::uint64_t id)
+        : m_client(client_key(socket)),
+          m_stream(std::move(socket)),
+          m_runtime(runtime),
+          m_id(id)
+    {
+      metrics().connectionOpened();
+      m_req.body() = runtime.pool.acquire();
+      m_res.body() = runtime.pool.acquire();
+    }
+
+    ~HttpSession() override
+    {
+      if (!m_spectating.empty())
+      {
+        m_runtime.store.spectators()->unsubscribe(m_spectating, this);
+      }
+      m_runtime.pool.release(std::move(m_req.body()));
+      m_runtime.pool.release(std::move(m_res.body()));
+      metrics().connectionClosed();
+      m_runtime.sessionClosed(m_id);
+    }
+
+    HttpSession(const HttpSession&) = delete;
+    HttpSession& operator=(const HttpSession&) = delete;
+
+    void start()
+    {
+      asio::dispatch(m_stream.get_executor(), beast::bind_front_handler(&HttpSession::awaitRequest, shared_from_this()));
+    }
+
+    // Called while draining: a connection waiting for its next request is closed now, one inside a request
+    // finishes it first.
+    void closeIfIdle()
+    {
+      asio::post(m_stream.get_executor(), [self = shared_from_this()] {
+        if (self->m_idle)
         {
-          break;
+          self->m_stream.cancel();
         }
+      });
+    }
+
+    void deliver(const SpectatorFrame& frame, std::uint64_t revision) override
+    {
+      asio::post(m_stream.get_executor(),
+                 [self = shared_from_this(), frame, revision] { self->queueFrame(frame, revision); });
+    }
+
+  private:
+    // Keep-alive idle time is not part of a request: its trace and read start once the first bytes are in.
+    void awaitRequest()
+    {
+      if (m_runtime.draining())
+      {
+        return close();
+      }
+      if (m_buffer.size() > 0)
+      {
+        return readRequest();  // pipelined request already buffered
+      }
+      m_idle = true;
+      m_stream.expires_after(m_runtime.config.keepAliveTimeout);
+      m_stream.async_read_some(m_buffer.prepare(BufferPool::INITIAL_CAPACITY),
+                               beast::bind_front_handler(&HttpSession::onFirstBytes, shared_from_this()));
+    }
+
+    void onFirstBytes(const beast::error_code& ec, std::size_t bytes)
+    {
+      m_idle = false;
+      if (ec)
+      {
+        return close();
+      }
+      m_buffer.commit(bytes);
+      readRequest();
+    }
+
+    void readRequest()
+    {
+      m_ticket = m_runtime.admission.enter(m_client);
+      m_traced = tracer().enabled() ? &m_trace : nullptr;
+      if (m_traced != nullptr)
+      {
+        m_traced->begin();
+      }
 
-        auto res = handle_request(store, std::move(req));
-        http::write(socket, res, ec);
-        if (ec)
+      m_req.base().clear();
+      m_req.body().clear();
+      m_stream.expires_after(m_runtime.config.keepAliveTimeout);
+      http::async_read(m_stream, m_buffer, m_req, beast::bind_front_handler(&HttpSession::onRead, shared_from_this()));
+    }
+
+    void onRead(const beast::error_code& ec, std::size_t)
+    {
+      if (ec)
+      {
+        return close();
+      }
+      if (m_traced != nullptr)
+      {
+        m_traced->mark(TraceStage::Read);
+      }
+
+      // The route views into m_req, which stays put until the response has been written.
+      const auto target = m_req.target();
+      const auto route = match_route(m_req.method(), std::string_view{ target.data(), target.size() });
+      if (route.id == RouteId::Spectate && m_runtime.store.spectators() != nullptr)
+      {
+        m_spectating = route.gameId;  // not subscribed yet; write() streams once the game is known to exist
+      }
+      if (!m_runtime.gameActors())
+      {
+        serve(route);
+        return write();
+      }
+
+      // The request runs on the strand that owns its game's shard and the response is written back on ours;
+      // nothing else touches the session in between.
+      asio::post(m_runtime.gameStrand(route.gameId), [self = shared_from_this(), route] {
+        self->serve(route);
+        asio::post(self->m_stream.get_executor(), [self] { self->write(); });
+      });
+    }
+
+    void serve(const RouteMatch& route)
+    {
+      handle_request(m_runtime.store, route, m_req, m_res, m_traced, &m_ticket, !m_spectating.empty());
+      if (m_runtime.draining())
+      {
+        m_res.keep_alive(false);
+      }
+    }
+
+    void write()
+    {
+      if (!m_spectating.empty())
+      {
+        if (m_res.result() == http::status::ok && !m_runtime.draining())
         {
-          break;
+          return startStream();
         }
-        if (!res.keep_alive())
+        // A drain that began after serve() sends the frameless 200 as it is: a stream that has already ended.
+        m_spectating.clear();
+      }
+      m_stream.expires_after(m_runtime.config.keepAliveTimeout);
+      http::async_write(m_stream, m_res, beast::bind_front_handler(&HttpSession::onWrite, shared_from_this()));
+    }
+
+    void onWrite(const beast::error_code& ec, std::size_t)
+    {
+      m_ticket.reset();
+      if (ec)
+      {
+        return close();
+      }
+      if (m_traced != nullptr)
+      {
+        m_traced->mark(TraceStage::Write);
+        tracer().finish(*m_traced);
+      }
+      if (!m_res.keep_alive())
+      {
+        return close();
+      }
+      awaitRequest();
+    }
+
+    // The response only settled that the game exists; the stream starts from whatever the hub has published,
+    // so a frame racing this subscription can never arrive ahead of an older one.
+    void startStream()
+    {
+      m_ticket.reset();
+      if (m_traced != nullptr)
+      {
+        tracer().finish(*m_traced);
+      }
+
+      auto& hub = *m_runtime.store.spectators();
+      m_stream.expires_never();
+      m_idle = true;  // nothing left to finish: a drain closes the stream
+      m_pending = hub.subscribe(m_spectating, std::static_pointer_cast<SpectatorViewer>(shared_from_this()));
+      if (m_pending == nullptr && !publish_spectator_frame(m_runtime.store, hub, m_spectating))
+      {
+        return stopStream();  // the game went away in between
+      }
+
+      m_writing = true;
+      asio::async_write(m_stream, asio::buffer(SPECTATE_RESPONSE_HEADERS.data(), SPECTATE_RESPONSE_HEADERS.size()),
+                        beast::bind_front_handler(&HttpSession::onFrameWritten, shared_from_this()));
+      awaitHangup();
+    }
+
+    void queueFrame(SpectatorFrame frame, std::uint64_t revision)
+    {
+      if (m_spectating.empty() || revision < m_nextRevision)
+      {
+        return;
+      }
+      m_nextRevision = revision + 1;
+      if (m_writing)
+      {
+        m_pending = std::move(frame);
+        return;
+      }
+      writeFrame(std::move(frame));
+    }
+
+    void writeFrame(SpectatorFrame frame)
+    {
+      m_writing = true;
+      const auto buffer = asio::buffer(frame->data(), frame->size());
+      asio::async_write(m_stream,
+                        buffer,
+                        [self = shared_from_this(), frame = std::move(frame)](const beast::error_code& ec, std::size_t bytes) {
+                          self->onFrameWritten(ec, bytes);
+                        });
+    }
+
+    void onFrameWritten(const beast::error_code& ec, std::size_t)
+    {
+      m_writing = false;
+      if (ec)
+      {
+        return stopStream();
+      }
+      if (m_pending != nullptr)
+      {
+        writeFrame(std::exchange(m_pending, nullptr));
+      }
+    }
+
+    // A spectator sends nothing more; the read only ends when it hangs up or a drain cancels it.
+    void awaitHangup()
+    {
+      m_buffer.clear();
+      m_stream.async_read_some(m_buffer.prepare(BufferPool::INITIAL_CAPACITY),
+                               [self = shared_from_this()](const beast::error_code& ec, std::size_t) {
+                                 if (ec)
+                                 {
+                                   return self->stopStream();
+                                 }
+                                 self->awaitHangup();
+                               });
+    }
+
+    void stopStream()
+    {
+      if (m_spectating.empty())
+      {
+        return;
+      }
+      m_runtime.store.spectators()->unsubscribe(m_spectating, this);
+      m_spectating.clear();
+      m_pending = nullptr;
+      close();
+    }
+
+    void close()
+    {
+      beast::error_code ec;
+      m_stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+      m_stream.close();
+    }
+
+  private:
+    const std::uint64_t m_client;
+    beast::tcp_stream m_stream;
+    ServerRuntime& m_runtime;
+    const std::uint64_t m_id;
+    beast::flat_buffer m_buffer;
+
+    // One request and one response live for the whole connection; only their contents change.
+    http::request<http::string_body> m_req;
+    http::response<http::string_body> m_res;
+    RequestTrace m_trace;
+    RequestTrace* m_traced{ nullptr };
+    AdmissionTicket m_ticket;
+    bool m_idle{ false };
+
+    std::string m_spectating;  // the game this connection streams, empty for a request/response connection
+    SpectatorFrame m_pending;  // the latest frame not yet written
+    std::uint64_t m_nextRevision{ 0 };  // frames below it are older than one already taken
+    bool m_writing{ false };
+  };
+
+  void ServerRuntime::listen()
+  {
+    const tcp::endpoint endpoint{ asio::ip::make_address(config.address), config.port };
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(asio::socket_base::reuse_address(true));
+    if (config.reusePort)
+    {
+#ifdef SO_REUSEPORT
+      m_acceptor.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#else
+      std::cerr << "SO_REUSEPORT is not available on this platform; ignoring --reuse-port\n";
+#endif
+    }
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen(config.backlog);
+
+    m_signals.async_wait([this](const beast::error_code& ec, int) {
+      if (!ec)
+      {
+        stop();
+      }
+    });
+    if constexpr (LOCK_PROFILING_ENABLED)
+    {
+      m_profileSignal.add(SIGUSR1);
+      awaitProfileSignal();
+    }
+    asio::post(m_acceptor.get_executor(), [this] { doAccept(); });
+  }
+
+  void ServerRuntime::awaitProfileSignal()
+  {
+    m_profileSignal.async_wait([this](const beast::error_code& ec, int) {
+      if (ec)
+      {
+        return;  // cancelled by the drain
+      }
+      writeLockProfile(std::cerr, store.lockProfile());
+      awaitProfileSignal();
+    });
+  }
+
+  void ServerRuntime::runThreads()
+  {
+    for (unsigned i = 0; i < config.ioThreads; ++i)
+    {
+      m_threads.emplace_back([this, i] {
+        if (config.pinThreads)
         {
-          break;
+          pinThreadToCpu(i);
         }
+        m_ioc.run();
+      });
+    }
+  }
+
+  void ServerRuntime::join()
+  {
+    for (auto& thread : m_threads)
+    {
+      thread.join();
+    }
+    m_threads.clear();
+    m_stopped.store(true, std::memory_order_release);
+  }
+
+  void ServerRuntime::stop()
+  {
+    asio::post(m_acceptor.get_executor(), [this] { beginDrain(); });
+  }
+
+  void ServerRuntime::doAccept()
+  {
+    m_acceptor.async_accept(asio::make_strand(m_ioc),
+                          [this](const beast::error_code& ec, tcp::socket socket) { onAccept(ec, std::move(socket)); });
+  }
+
+  void ServerRuntime::onAccept(const beast::error_code& ec, tcp::socket socket)
+  {
+    if (ec == asio::error::operation_aborted || draining())
+    {
+      return;
+    }
+    if (!ec)
+    {
+      std::shared_ptr<HttpSession> session;
+      {
+        std::lock_guard<std::mutex> lk(m_sessionsMu);
+        const auto id = m_nextHttpSessionId++;
+        session = std::make_shared<HttpSession>(std::move(socket), *this, id);
+        m_sessions.emplace(id, session);
       }
+      m_open.fetch_add(1, std::memory_order_relaxed);
+      session->start();
+    }
 
-      beast::error_code ec;
-      socket.shutdown(tcp::socket::shutdown_send, ec);
+    // At the connection limit, leave further connections in the listen backlog until a session closes.
+    if (config.maxConnections != 0 && m_open.load(std::memory_order_relaxed) >= config.maxConnections)
+    {
+      m_acceptPaused = true;
+      return;
     }
-  }  // namespace
+    doAccept();
+  }
 
-  HttpServer::HttpServer(GameStore& store) : m_store(store) {}
+  void ServerRuntime::sessionClosed(std::uint64_t id)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_sessionsMu);
+      m_sessions.erase(id);
+    }
+    m_open.fetch_sub(1, std::memory_order_relaxed);
+    if (m_stopped.load(std::memory_order_acquire))
+    {
+      return;
+    }
 
-  void HttpServer::run(std::uint16_t port)
+    asio::post(m_acceptor.get_executor(), [this] {
+      if (draining())
+      {
+        if (m_open.load(std::memory_order_relaxed) == 0)
+        {
+          m_drainTimer.cancel();
+        }
+      }
+      else if (m_acceptPaused && m_open.load(std::memory_order_relaxed) < config.maxConnections)
+      {
+        m_acceptPaused = false;
+        doAccept();
+      }
+    });
+  }
+
+  void ServerRuntime::beginDrain()
   {
-    asio::io_context ioc{ 1 };
-    tcp::acceptor acceptor{ ioc, { tcp::v4(), port } };
+    if (m_draining.exchange(true, std::memory_order_acq_rel))
+    {
+      return;
+    }
 
-    std::cout << "Listening on http://0.0.0.0:" << port << "\n";
+    beast::error_code ec;
+    m_acceptor.close(ec);
+    m_signals.cancel(ec);
+    m_profileSignal.cancel(ec);
 
-    for (;;)
+    std::vector<std::shared_ptr<HttpSession>> open;
+    {
+      std::lock_guard<std::mutex> lk(m_sessionsMu);
+      for (const auto& [id, weak] : m_sessions)
+      {
+        if (auto session = weak.lock())
+        {
+          open.push_back(std::move(session));
+        }
+      }
+    }
+    for (const auto& session : open)
     {
-      tcp::socket socket{ ioc };
-      acceptor.accept(socket);
+      session->closeIfIdle();
+    }
 
-      std::thread{ [s = std::move(socket), this]() mutable { do_session(std::move(s), m_store); } }.detach();
+    // The loop runs out of work once the last session is gone; the timer bounds how long that may take.
+    if (m_open.load(std::memory_order_relaxed) != 0)
+    {
+      m_drainTimer.expires_after(config.drainTimeout);
+      m_drainTimer.async_wait([this](const beast::error_code& timerEc) {
+        if (!timerEc)
+        {
+          m_ioc.stop();
+        }
+      });
+    }
+  }
+
+  HttpServer::HttpServer(GameStore& store, ServerConfig config)
+      : m_store(store),
+        m_config(std::move(config))
+  {
+  }
+
+  HttpServer::~HttpServer()
+  {
+    if (m_runtime != nullptr && m_runtime->running())
+    {
+      stop();
+      wait();
+    }
+  }
+
+  void HttpServer::start()
+  {
+    m_runtime = std::make_unique<ServerRuntime>(m_store, m_config, m_buffers);
+    m_runtime->listen();
+    m_port.store(m_runtime->port(), std::memory_order_release);
+
+    m_runtime->runThreads();
+  }
+
+  void HttpServer::wait()
+  {
+    if (m_runtime != nullptr)
+    {
+      m_runtime->join();
+    }
+  }
+
+  void HttpServer::run()
+  {
+    start();
+    std::cout << "Listening on http://" << m_config.address << ":" << port() << " with " << m_config.ioThreads
+              << " I/O thread" << (m_config.ioThreads == 1 ? "" : "s") << "\n";
+    wait();
+  }
+
+  void HttpServer::run(std::uint16_t port)
+  {
+    m_config.port = port;
+    run();
+  }
+
+  void HttpServer::stop()
+  {
+    if (m_runtime != nullptr)
+    {
+      m_runtime->stop();
     }
   }
 
@@ -0,0 +1,159 @@
+#include "server/json_writer.hpp"
+
+#include <charconv>
+
+namespace server
+{
+  namespace
+  {
+    bool passes_unescaped(unsigned char c) noexcept
+    {
+      // Same ranges as property_tree's create_escapes().
+      return c == 0x20 || c == 0x21 || (c >= 0x23 && c <= 0x2E) || (c >= 0x30 && c <= 0x5B) || c >= 0x5D;
+    }
+  }  // namespace
+
+  JsonWriter::JsonWriter(std::string& out) noexcept : m_out(out) {}
+
+  void JsonWriter::push()
+  {
+    if (m_depth < MAX_DEPTH)
+    {
+      m_hasMembers[m_depth] = false;
+    }
+    ++m_depth;
+  }
+
+  void JsonWriter::separator()
+  {
+    if (m_depth == 0 || m_depth > MAX_DEPTH)
+    {
+      return;
+    }
+    if (m_hasMembers[m_depth - 1])
+    {
+      m_out.push_back(',');
+    }
+    m_hasMembers[m_depth - 1] = true;
+  }
+
+  void JsonWriter::string(std::string_view value)
+  {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+
+    m_out.push_back('"');
+    for (const char ch : value)
+    {
+      const auto c = static_cast<unsigned char>(ch);
+      if (passes_unescaped(c))
+      {
+        m_out.push_back(ch);
+        continue;
+      }
+
+      m_out.push_back('\\');
+      switch (ch)
+      {
+        case '\b': m_out.push_back('b'); break;
+        case '\f': m_out.push_back('f'); break;
+        case '\n': m_out.push_back('n'); break;
+        case '\r': m_out.push_back('r'); break;
+        case '\t': m_out.push_back('t'); break;
+        case '/': m_out.push_back('/'); break;
+        case '"': m_out.push_back('"'); break;
+        case '\\': m_out.push_back('\\'); break;
+        default:
+          m_out.append("u00");
+          m_out.push_back(HEX[c >> 4U]);
+          m_out.push_back(HEX[c & 0xFU]);
+          break;
+      }
+    }
+    m_out.push_back('"');
+  }
+
+  void JsonWriter::key(std::string_view name)
+  {
+    separator();
+    string(name);
+    m_out.push_back(':');
+  }
+
+  void JsonWriter::beginObject()
+  {
+    separator();
+    m_out.push_back('{');
+    push();
+  }
+
+  void JsonWriter::beginObject(std::string_view name)
+  {
+    key(name);
+    m_out.push_back('{');
+    push();
+  }
+
+  void JsonWriter::endObject()
+  {
+    m_out.push_back('}');
+    --m_depth;
+  }
+
+  void JsonWriter::beginArray(std::string_view name)
+  {
+    key(name);
+    m_out.push_back('[');
+    push();
+  }
+
+  void JsonWriter::endArray()
+  {
+    m_out.push_back(']');
+    --m_depth;
+  }
+
+  void JsonWriter::field(std::string_view name, std::string_view value)
+  {
+    key(name);
+    string(value);
+  }
+
+  void JsonWriter::field(std::string_view name, const char* value)
+  {
+    field(name, std::string_view{ value });
+  }
+
+  void JsonWriter::field(std::string_view name, bool value)
+  {
+    field(name, value ? std::string_view{ "true" } : std::string_view{ "false" });
+  }
+
+  void JsonWriter::field(std::string_view name, std::int64_t value)
+  {
+    std::array<char, 24> digits{};
+    const auto [end, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    field(name, std::string_view{ digits.data(), static_cast<std::size_t>(end - digits.data()) });
+  }
+
+  void JsonWriter::field(std::string_view name, int value)
+  {
+    field(name, static_cast<std::int64_t>(value));
+  }
+
+  void JsonWriter::field(std::string_view name, std::size_t value)
+  {
+    field(name, static_cast<std::int64_t>(value));
+  }
+
+  void JsonWriter::element(std::string_view value)
+  {
+    separator();
+    string(value);
+  }
+
+  void JsonWriter::finish()
+  {
+    m_out.push_back('\n');
+  }
+
+}  // namespace server
@@ -0,0 +1,65 @@
+#include "server/mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+namespace server
+{
+  MappedFile::MappedFile(const std::string& path)
+  {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      return;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED)
+      {
+        m_data = static_cast<const char*>(p);
+        m_size = static_cast<std::size_t>(st.st_size);
+        ::madvise(p, m_size, MADV_WILLNEED);
+      }
+    }
+    ::close(fd);
+  }
+
+  MappedFile::~MappedFile()
+  {
+    reset();
+  }
+
+  MappedFile::MappedFile(MappedFile&& other) noexcept
+      : m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0))
+  {
+  }
+
+  MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      m_data = std::exchange(other.m_data, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+  }
+
+  void MappedFile::reset() noexcept
+  {
+    if (m_data != nullptr)
+    {
+      ::munmap(const_cast<char*>(m_data), m_size);
+      m_data = nullptr;
+      m_size = 0;
+    }
+  }
+
+}  // namespace server
@@ -0,0 +1,243 @@
+#include "server/matchmaker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <random>
+#include <utility>
+
+#include "server/game_store.hpp"
+
+namespace server
+{
+  namespace
+  {
+    constexpr std::uint32_t NO_TICKET = UINT32_MAX;
+
+    std::uint64_t randomSecret()
+    {
+      thread_local std::mt19937_64 rng{ std::random_device{}() };
+      return rng() | 1U;  // never 0, the secret of a free ticket
+    }
+  }  // namespace
+
+  Matchmaker::Matchmaker(GameStore& store, std::size_t capacity, std::chrono::seconds timeout)
+      : m_store(store),
+        m_timeoutNs(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count()),
+        m_capacity(std::min<std::size_t>(std::max<std::size_t>(capacity, 2), NO_TICKET)),
+        m_tickets(std::make_unique<Ticket[]>(m_capacity)),
+        m_free(m_capacity)
+  {
+    for (std::size_t i = 0; i < m_capacity; ++i)
+    {
+      (void)m_free.tryPush(static_cast<std::uint32_t>(i));
+    }
+    // Every ticket fits in any one bucket, so a queued ticket always has room.
+    for (std::size_t b = 0; b < BUCKETS; ++b)
+    {
+      m_waiting.push_back(std::make_unique<MpmcQueue<std::uint32_t>>(m_capacity));
+    }
+    m_worker = std::thread{ [this] { run(); } };
+  }
+
+  Matchmaker::~Matchmaker()
+  {
+    m_stopping.store(true, std::memory_order_release);
+    wake();
+    m_worker.join();
+  }
+
+  void Matchmaker::wake() noexcept
+  {
+    // Whoever flips the flag releases; it is only cleared once that release has been acquired, so the
+    // semaphore never goes above 1.
+    if (!m_signalled.exchange(true, std::memory_order_acq_rel))
+    {
+      m_wake.release();
+    }
+  }
+
+  std::int64_t Matchmaker::nowNs() noexcept
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+  }
+
+  std::optional<std::string> Matchmaker::enqueue(std::size_t bucket)
+  {
+    std::uint32_t index = 0;
+    if (bucket >= BUCKETS || !m_free.tryPop(index))
+    {
+      return std::nullopt;
+    }
+
+    Ticket& ticket = m_tickets[index];
+    const std::uint64_t secret = randomSecret();
+    ticket.secret.store(secret, std::memory_order_relaxed);
+    ticket.touchedNs.store(nowNs(), std::memory_order_relaxed);
+    ticket.state.store(Waiting, std::memory_order_release);
+    (void)m_waiting[bucket]->tryPush(index);
+    wake();
+
+    // "<node prefix>m<index>.<secret in hex>": the prefix keeps polls routable in a cluster like game ids.
+    std::array<char, 48> text{};
+    char* end = std::to_chars(text.data(), text.data() + text.size(), index).ptr;
+    *end++ = '.';
+    end = std::to_chars(end, text.data() + text.size(), secret, 16).ptr;
+    return m_store.idPrefix() + "m" + std::string{ text.data(), end };
+  }
+
+  std::optional<MatchStatus> Matchmaker::poll(std::string_view text)
+  {
+    const std::string& prefix = m_store.idPrefix();
+    if (!text.starts_with(prefix) || !text.substr(prefix.size()).starts_with('m'))
+    {
+      return std::nullopt;
+    }
+    text.remove_prefix(prefix.size() + 1);
+
+    std::uint32_t index = 0;
+    std::uint64_t secret = 0;
+    const auto dot = text.find('.');
+    const auto idx = std::from_chars(text.data(), text.data() + text.size(), index);
+    if (dot == std::string_view::npos || idx.ptr != text.data() + dot || index >= m_capacity)
+    {
+      return std::nullopt;
+    }
+    const auto sec = std::from_chars(text.data() + dot + 1, text.data() + text.size(), secret, 16);
+    if (sec.ec != std::errc{} || sec.ptr != text.data() + text.size() || secret == 0)
+    {
+      return std::nullopt;
+    }
+
+    Ticket& ticket = m_tickets[index];
+    std::uint32_t state = ticket.state.load(std::memory_order_acquire);
+    if (ticket.secret.load(std::memory_order_relaxed) != secret)
+    {
+      return std::nullopt;
+    }
+    if (state == Waiting)
+    {
+      ticket.touchedNs.store(nowNs(), std::memory_order_relaxed);
+      return MatchStatus{};
+    }
+    if (state != Matched || !ticket.state.compare_exchange_strong(state, Claimed, std::memory_order_acquire))
+    {
+      return std::nullopt;
+    }
+    // The entry may have been collected and reused between the secret check and the claim.
+    if (ticket.secret.load(std::memory_order_relaxed) != secret)
+    {
+      ticket.state.store(Matched, std::memory_order_release);
+      return std::nullopt;
+    }
+
+    MatchStatus status{ .matched = true, .seat = std::move(ticket.seat) };
+    release(index);
+    return status;
+  }
+
+  void Matchmaker::run()
+  {
+    // The player of each bucket still waiting for an opponent; only this thread touches it.
+    std::array<std::uint32_t, BUCKETS> pending{};
+    pending.fill(NO_TICKET);
+    auto lastSweep = nowNs();
+
+    while (!m_stopping.load(std::memory_order_acquire))
+    {
+      if (m_wake.try_acquire_for(std::chrono::seconds{ 1 }))
+      {
+        m_signalled.store(false, std::memory_order_release);
+      }
+
+      const auto now = nowNs();
+      for (std::size_t b = 0; b < BUCKETS; ++b)
+      {
+        std::uint32_t index = 0;
+        while (m_waiting[b]->tryPop(index))
+        {
+          if (stale(m_tickets[index], now))
+          {
+            release(index);
+          }
+          else if (pending[b] == NO_TICKET)
+          {
+            pending[b] = index;
+          }
+          else
+          {
+            pair(pending[b], index);
+            pending[b] = NO_TICKET;
+          }
+        }
+        if (pending[b] != NO_TICKET && stale(m_tickets[pending[b]], now))
+        {
+          release(pending[b]);
+          pending[b] = NO_TICKET;
+        }
+      }
+
+      if (now - lastSweep >= std::chrono::nanoseconds{ std::chrono::seconds{ 1 } }.count())
+      {
+        sweep(now);
+        lastSweep = now;
+      }
+    }
+  }
+
+  void Matchmaker::pair(std::uint32_t first, std::uint32_t second)
+  {
+    const auto created = m_store.tryCreateGame();
+    const auto joined = created ? m_store.tryJoinGame(created->gameId)
+                                : StoreResult<JoinGameResult>{ battleship::unexpected(created.error()) };
+    if (!joined)
+    {
+      release(first);
+      release(second);
+      return;
+    }
+
+    const auto now = nowNs();
+    Ticket& host = m_tickets[first];
+    host.seat = JoinGameResult{ .gameId = created->gameId,
+                                .playerId = created->playerId,
+                                .playerToken = created->playerToken,
+                                .status = joined->status };
+    Ticket& guest = m_tickets[second];
+    guest.seat = *joined;
+    for (Ticket* ticket : { &host, &guest })
+    {
+      ticket->touchedNs.store(now, std::memory_order_relaxed);
+      ticket->state.store(Matched, std::memory_order_release);
+    }
+  }
+
+  void Matchmaker::release(std::uint32_t index)
+  {
+    Ticket& ticket = m_tickets[index];
+    ticket.secret.store(0, std::memory_order_relaxed);
+    ticket.seat = {};
+    ticket.state.store(Free, std::memory_order_release);
+    (void)m_free.tryPush(index);
+  }
+
+  bool Matchmaker::stale(const Ticket& ticket, std::int64_t now) const noexcept
+  {
+    return now - ticket.touchedNs.load(std::memory_order_relaxed) > m_timeoutNs;
+  }
+
+  void Matchmaker::sweep(std::int64_t now)
+  {
+    for (std::size_t i = 0; i < m_capacity; ++i)
+    {
+      Ticket& ticket = m_tickets[i];
+      std::uint32_t state = Matched;
+      if (ticket.state.load(std::memory_order_relaxed) == Matched && stale(ticket, now)
+          && ticket.state.compare_exchange_strong(state, Claimed, std::memory_order_acquire))
+      {
+        release(static_cast<std::uint32_t>(i));
+      }
+    }
+  }
+
+}  // namespace server
@@ -0,0 +1,309 @@
+#include "server/metrics.hpp"
+
+#include <charconv>
+
+#include "server/game_store.hpp"
+#include "server/spectator_hub.hpp"
+
+namespace server
+{
+  namespace
+  {
+    std::atomic<unsigned> g_nextShard{ 0 };
+
+    void appendNumber(std::string& out, std::uint64_t value)
+    {
+      char buf[24];
+      const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+      out.append(buf, res.ptr);
+    }
+
+    void appendNumber(std::string& out, std::int64_t value)
+    {
+      char buf[24];
+      const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+      out.append(buf, res.ptr);
+    }
+
+    // Seconds from an integer count of `unit`ths of a second, without going through floating point formatting.
+    void appendSeconds(std::string& out, std::uint64_t value, std::uint64_t unit)
+    {
+      appendNumber(out, value / unit);
+      std::uint64_t frac = value % unit;
+      if (frac == 0)
+      {
+        return;
+      }
+      out.push_back('.');
+      for (std::uint64_t digit = unit / 10; digit > 0 && frac > 0; digit /= 10)
+      {
+        out.push_back(static_cast<char>('0' + frac / digit));
+        frac %= digit;
+      }
+    }
+
+    void appendHeader(std::string& out, std::string_view name, std::string_view type, std::string_view help)
+    {
+      out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+      out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+    }
+
+    // _bucket, _sum and _count series of one labelled histogram.
+    void appendHistogram(std::string& out,
+                         std::string_view name,
+                         std::string_view label,
+                         std::string_view value,
+                         const std::array<std::uint64_t, LatencyBuckets::COUNT>& buckets,
+                         std::uint64_t sumNs)
+    {
+      const auto series = [&](std::string_view suffix) -> std::string& {
+        return out.append(name).append(suffix).append("{").append(label).append("=\"").append(value).append("\"");
+      };
+
+      std::uint64_t cumulative = 0;
+      for (std::size_t b = 0; b + 1 < buckets.size(); ++b)
+      {
+        cumulative += buckets[b];
+        series("_bucket").append(",le=\"");
+        appendSeconds(out, LatencyBuckets::upperBoundMicros(b), 1'000'000);
+        out.append("\"} ");
+        appendNumber(out, cumulative);
+        out.push_back('\n');
+      }
+      cumulative += buckets.back();
+      series("_bucket").append(",le=\"+Inf\"} ");
+      appendNumber(out, cumulative);
+      out.push_back('\n');
+      series("_sum").append("} ");
+      appendSeconds(out, sumNs, 1'000'000'000);
+      out.push_back('\n');
+      series("_count").append("} ");
+      appendNumber(out, cumulative);
+      out.push_back('\n');
+    }
+
+    // One series per StoreOp that has taken the lock; `field` picks the value and `unit` scales it to seconds.
+    template<typename Field>
+    void appendLockOpSeries(std::string& out,
+                            const LockProfile& profile,
+                            std::string_view name,
+                            std::string_view help,
+                            Field field,
+                            std::uint64_t unit)
+    {
+      appendHeader(out, name, "counter", help);
+      for (std::size_t i = 0; i < profile.ops.size(); ++i)
+      {
+        if (profile.ops[i].acquisitions == 0)
+        {
+          continue;
+        }
+        out.append(name).append("{op=\"").append(to_cstr(static_cast<StoreOp>(i))).append("\"} ");
+        appendSeconds(out, profile.ops[i].*field, unit);
+        out.push_back('\n');
+      }
+    }
+
+    void writeLockProfileMetrics(std::string& out, const LockProfile& profile)
+    {
+      appendLockOpSeries(out,
+                         profile,
+                         "battleship_store_lock_op_acquisitions_total",
+                         "GameStore lock acquisitions, by operation.",
+                         &LockOpStats::acquisitions,
+                         1);
+      appendLockOpSeries(out,
+                         profile,
+                         "battleship_store_lock_op_contended_total",
+                         "GameStore lock acquisitions that had to wait, by operation.",
+                         &LockOpStats::contended,
+                         1);
+      appendLockOpSeries(out,
+                         profile,
+                         "battleship_store_lock_op_wait_seconds_total",
+                         "Time spent waiting for the GameStore lock, by operation.",
+                         &LockOpStats::waitNs,
+                         1'000'000'000);
+      appendLockOpSeries(out,
+                         profile,
+                         "battleship_store_lock_op_hold_seconds_total",
+                         "Time the GameStore lock was held, by operation.",
+                         &LockOpStats::holdNs,
+                         1'000'000'000);
+    }
+  }  // namespace
+
+  Metrics::Shard& Metrics::local() noexcept
+  {
+    thread_local const unsigned shard = g_nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return m_shards[shard];
+  }
+
+  void Metrics::recordRequest(RouteId route, unsigned status, std::chrono::nanoseconds latency) noexcept
+  {
+    auto& shard = local();
+    const auto r = static_cast<std::size_t>(route);
+    const auto ns = static_cast<std::uint64_t>(latency.count() > 0 ? latency.count() : 0);
+
+    shard.requests[r].fetch_add(1, std::memory_order_relaxed);
+    shard.latencySumNs[r].fetch_add(ns, std::memory_order_relaxed);
+    shard.latency[r][LatencyBuckets::bucketFor(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+    shard.statuses[status < MAX_STATUS ? status : 0].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Metrics::recordStages(const RequestTrace& trace) noexcept
+  {
+    auto& shard = local();
+    for (std::size_t i = 0; i < TRACE_STAGE_COUNT; ++i)
+    {
+      const std::uint64_t ns = trace.stageNs[i];
+      shard.stageSumNs[i].fetch_add(ns, std::memory_order_relaxed);
+      shard.stages[i][LatencyBuckets::bucketFor(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void Metrics::connectionOpened() noexcept
+  {
+    local().connections.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Metrics::connectionClosed() noexcept
+  {
+    local().connections.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  std::uint64_t Metrics::requestCount(RouteId route) const noexcept
+  {
+    return sum([r = static_cast<std::size_t>(route)](const Shard& s) -> const Counter& { return s.requests[r]; });
+  }
+
+  std::uint64_t Metrics::statusCount(unsigned status) const noexcept
+  {
+    if (status >= MAX_STATUS)
+    {
+      return 0;
+    }
+    return sum([status](const Shard& s) -> const Counter& { return s.statuses[status]; });
+  }
+
+  std::int64_t Metrics::openConnections() const noexcept
+  {
+    std::int64_t total = 0;
+    for (const auto& shard : m_shards)
+    {
+      total += shard.connections.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  std::array<std::uint64_t, LatencyBuckets::COUNT> Metrics::latencyBuckets(RouteId route) const noexcept
+  {
+    return merge([r = static_cast<std::size_t>(route)](const Shard& s) -> const Histogram& { return s.latency[r]; });
+  }
+
+  std::array<std::uint64_t, LatencyBuckets::COUNT> Metrics::stageBuckets(TraceStage stage) const noexcept
+  {
+    return merge([i = static_cast<std::size_t>(stage)](const Shard& s) -> const Histogram& { return s.stages[i]; });
+  }
+
+  void Metrics::writePrometheus(std::string& out, const GameStore& store) const
+  {
+    appendHeader(out, "battleship_http_requests_total", "counter", "Requests served, by route.");
+    for (std::size_t r = 0; r < ROUTE_COUNT; ++r)
+    {
+      const auto route = static_cast<RouteId>(r);
+      out.append("battleship_http_requests_total{route=\"").append(to_cstr(route)).append("\"} ");
+      appendNumber(out, requestCount(route));
+      out.push_back('\n');
+    }
+
+    appendHeader(out, "battleship_http_responses_total", "counter", "Responses sent, by status code.");
+    for (unsigned code = 100; code < MAX_STATUS; ++code)
+    {
+      if (const auto count = statusCount(code); count != 0)
+      {
+        out.append("battleship_http_responses_total{code=\"");
+        appendNumber(out, std::uint64_t{ code });
+        out.append("\"} ");
+        appendNumber(out, count);
+        out.push_back('\n');
+      }
+    }
+
+    appendHeader(out, "battleship_http_request_duration_seconds", "histogram", "Time spent handling a request.");
+    for (std::size_t r = 0; r < ROUTE_COUNT; ++r)
+    {
+      const auto route = static_cast<RouteId>(r);
+      appendHistogram(out,
+                      "battleship_http_request_duration_seconds",
+                      "route",
+                      to_cstr(route),
+                      latencyBuckets(route),
+                      sum([r](const Shard& s) -> const Counter& { return s.latencySumNs[r]; }));
+    }
+
+    appendHeader(out,
+                 "battleship_request_stage_duration_seconds",
+                 "histogram",
+                 "Time traced requests spent in each pipeline stage.");
+    for (std::size_t i = 0; i < TRACE_STAGE_COUNT; ++i)
+    {
+      const auto stage = static_cast<TraceStage>(i);
+      appendHistogram(out,
+                      "battleship_request_stage_duration_seconds",
+                      "stage",
+                      to_cstr(stage),
+                      stageBuckets(stage),
+                      sum([i](const Shard& s) -> const Counter& { return s.stageSumNs[i]; }));
+    }
+
+    appendHeader(out, "battleship_open_connections", "gauge", "Client connections currently open.");
+    out.append("battleship_open_connections ");
+    appendNumber(out, openConnections());
+    out.push_back('\n');
+
+    if (const auto* hub = store.spectators(); hub != nullptr)
+    {
+      appendHeader(out, "battleship_spectators", "gauge", "Spectator streams currently open.");
+      out.append("battleship_spectators ");
+      appendNumber(out, std::uint64_t{ hub->viewerCount() });
+      out.push_back('\n');
+    }
+
+    const StoreStats stats = store.stats();
+    appendHeader(out, "battleship_games", "gauge", "Games held by the store, by status.");
+    for (std::size_t s = 0; s < GAME_STATUS_COUNT; ++s)
+    {
+      out.append("battleship_games{status=\"").append(to_cstr(static_cast<GameStatus>(s))).append("\"} ");
+      appendNumber(out, std::uint64_t{ stats.gamesByStatus[s] });
+      out.push_back('\n');
+    }
+
+    appendHeader(out, "battleship_store_lock_acquisitions_total", "counter", "GameStore lock acquisitions.");
+    out.append("battleship_store_lock_acquisitions_total ");
+    appendNumber(out, stats.lockAcquisitions);
+    out.push_back('\n');
+
+    appendHeader(out, "battleship_store_lock_contended_total", "counter", "GameStore lock acquisitions that had to wait.");
+    out.append("battleship_store_lock_contended_total ");
+    appendNumber(out, stats.lockContended);
+    out.push_back('\n');
+
+    appendHeader(out, "battleship_store_lock_wait_seconds_total", "counter", "Time spent waiting for the GameStore lock.");
+    out.append("battleship_store_lock_wait_seconds_total ");
+    appendSeconds(out, stats.lockWaitNs, 1'000'000'000);
+    out.push_back('\n');
+
+    if constexpr (LOCK_PROFILING_ENABLED)
+    {
+      writeLockProfileMetrics(out, store.lockProfile());
+    }
+  }
+
+  Metrics& metrics()
+  {
+    static Metrics instance;
+    return instance;
+  }
+
+}  // namespace server
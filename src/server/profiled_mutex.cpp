@@ -0,0 +1,45 @@
+#include "server/profiled_mutex.hpp"
+
+namespace server
+{
+  const char* to_cstr(StoreOp op) noexcept
+  {
+    switch (op)
+    {
+      case StoreOp::CreateGame: return "create_game";
+      case StoreOp::JoinGame: return "join_game";
+      case StoreOp::Authenticate: return "authenticate";
+      case StoreOp::PlaceShip: return "place_ship";
+      case StoreOp::PlaceFleet: return "place_fleet";
+      case StoreOp::PlaceRandomFleet: return "place_random_fleet";
+      case StoreOp::ReadyUp: return "ready_up";
+      case StoreOp::Shoot: return "shoot";
+      case StoreOp::GetGameView: return "get_game_view";
+      case StoreOp::GetHistory: return "get_history";
+      case StoreOp::ListGames: return "list_games";
+      case StoreOp::WriteSnapshot: return "write_snapshot";
+      case StoreOp::LoadSnapshot: return "load_snapshot";
+      case StoreOp::AttachLog: return "attach_log";
+      case StoreOp::AttachRecorder: return "attach_recorder";
+      case StoreOp::Stats: return "stats";
+    }
+    return "unknown";
+  }
+
+  void writeLockProfile(std::ostream& out, const LockProfile& profile)
+  {
+    out << "op acquisitions contended wait_us max_wait_us hold_us max_hold_us\n";
+    for (std::size_t i = 0; i < profile.ops.size(); ++i)
+    {
+      const auto& op = profile.ops[i];
+      if (op.acquisitions == 0)
+      {
+        continue;
+      }
+      out << to_cstr(static_cast<StoreOp>(i)) << ' ' << op.acquisitions << ' ' << op.contended << ' '
+          << op.waitNs / 1000 << ' ' << op.maxWaitNs / 1000 << ' ' << op.holdNs / 1000 << ' ' << op.maxHoldNs / 1000
+          << '\n';
+    }
+  }
+
+}  // namespace server
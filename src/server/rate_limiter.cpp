@@ -0,0 +1,73 @@
+#include "server/rate_limiter.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+
+namespace server
+{
+  RateLimiter::RateLimiter(RateLimit limit, std::size_t capacity)
+  {
+    if (limit.perSecond <= 0)
+    {
+      return;
+    }
+    const double burst = limit.burst == 0 ? std::max(1.0, std::ceil(limit.perSecond)) : limit.burst;
+    m_intervalNs = static_cast<std::uint64_t>(std::max(1.0, 1e9 / limit.perSecond));
+    m_burstNs = static_cast<std::uint64_t>(burst) * m_intervalNs;
+
+    const std::size_t slots = std::bit_ceil(std::max(capacity, PROBES));
+    m_mask = slots - 1;
+    m_slots = std::make_unique<Slot[]>(slots);
+  }
+
+  bool RateLimiter::tryAcquire(std::uint64_t key, Clock::time_point now) noexcept
+  {
+    if (m_slots == nullptr)
+    {
+      return true;
+    }
+    const auto nowNs =
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count());
+
+    for (std::size_t probe = 0; probe < PROBES; ++probe)
+    {
+      Slot& slot = m_slots[(key + probe) & m_mask];
+      std::uint64_t owner = slot.key.load(std::memory_order_acquire);
+      if (owner != key)
+      {
+        // Free, or a full bucket of another key: take it over, unless another thread just did.
+        if (owner != 0 && slot.fullAtNs.load(std::memory_order_relaxed) > nowNs)
+        {
+          continue;
+        }
+        if (!slot.key.compare_exchange_strong(owner, key, std::memory_order_acq_rel) && owner != key)
+        {
+          continue;
+        }
+      }
+
+      std::uint64_t fullAt = slot.fullAtNs.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        const std::uint64_t next = std::max(fullAt, nowNs) + m_intervalNs;
+        if (next - nowNs > m_burstNs)
+        {
+          return false;
+        }
+        if (slot.fullAtNs.compare_exchange_weak(fullAt, next, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+    }
+    return true;
+  }
+
+  std::uint64_t RateLimiter::keyFor(std::string_view bytes) noexcept
+  {
+    return std::hash<std::string_view>{}(bytes) | 1U;
+  }
+
+}  // namespace server
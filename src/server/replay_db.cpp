@@ -0,0 +1,196 @@
+#include "server/replay_db.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include "server/game_recorder.hpp"
+
+namespace server
+{
+  namespace
+  {
+    // Runs fn(worker, begin, end) over `workers` contiguous slices of [0, n).
+    template<typename Fn>
+    void parallelFor(unsigned workers, std::size_t n, Fn&& fn)
+    {
+      const std::size_t slice = (n + workers - 1) / workers;
+      std::vector<std::thread> threads;
+      threads.reserve(workers);
+      for (unsigned w = 1; w < workers; ++w)
+      {
+        const std::size_t begin = std::min(n, w * slice);
+        threads.emplace_back([&fn, w, begin, end = std::min(n, begin + slice)] { fn(w, begin, end); });
+      }
+      fn(0U, std::size_t{ 0 }, std::min(n, slice));
+      for (auto& t : threads)
+      {
+        t.join();
+      }
+    }
+
+    struct SegmentIndex
+    {
+      std::vector<std::uint64_t> offsets;
+      std::vector<std::uint32_t> sizes;
+      std::vector<std::array<std::uint64_t, 2>> players;
+      std::vector<std::int64_t> finishedAt;
+      std::vector<std::uint8_t> winner;
+      std::vector<std::uint16_t> shotCount;
+    };
+
+    SegmentIndex indexSegment(const MappedFile& file)
+    {
+      SegmentIndex index;
+      std::size_t pos = 0;
+      GameRecordView view;
+      std::size_t consumed = 0;
+      while (parseGameRecord(file.data() + pos, file.size() - pos, view, consumed))
+      {
+        index.offsets.push_back(pos);
+        index.sizes.push_back(static_cast<std::uint32_t>(consumed));
+        index.players.push_back(view.playerHash);
+        index.finishedAt.push_back(view.finishedAtMs);
+        index.winner.push_back(view.winner);
+        index.shotCount.push_back(static_cast<std::uint16_t>(view.shots.size()));
+        pos += consumed;
+      }
+      return index;
+    }
+
+    template<typename T>
+    void append(std::vector<T>& to, const std::vector<T>& from)
+    {
+      to.insert(to.end(), from.begin(), from.end());
+    }
+  }  // namespace
+
+  ReplayDb::ReplayDb(const std::string& directory, unsigned threads)
+      : m_threads(threads != 0 ? threads : std::max(1U, std::thread::hardware_concurrency()))
+  {
+    for (const auto& path : GameRecorder::listSegments(directory))
+    {
+      m_segments.emplace_back(path);
+    }
+
+    std::vector<SegmentIndex> indexes(m_segments.size());
+    const unsigned workers = static_cast<unsigned>(std::clamp<std::size_t>(m_segments.size(), 1, m_threads));
+    parallelFor(workers, m_segments.size(), [&](unsigned, std::size_t begin, std::size_t end) {
+      for (std::size_t s = begin; s < end; ++s)
+      {
+        indexes[s] = indexSegment(m_segments[s]);
+      }
+    });
+
+    std::size_t total = 0;
+    for (const auto& index : indexes)
+    {
+      total += index.offsets.size();
+    }
+    m_location.reserve(total);
+    m_players.reserve(total);
+    m_finishedAt.reserve(total);
+    m_winner.reserve(total);
+    m_shotCount.reserve(total);
+
+    for (std::size_t s = 0; s < indexes.size(); ++s)
+    {
+      const auto& index = indexes[s];
+      for (std::size_t i = 0; i < index.offsets.size(); ++i)
+      {
+        m_location.push_back(Location{ static_cast<std::uint32_t>(s), index.sizes[i], index.offsets[i] });
+      }
+      append(m_players, index.players);
+      append(m_finishedAt, index.finishedAt);
+      append(m_winner, index.winner);
+      append(m_shotCount, index.shotCount);
+    }
+  }
+
+  GameRecordView ReplayDb::view(std::size_t index) const
+  {
+    const auto& loc = m_location[index];
+    GameRecordView view;
+    std::size_t consumed = 0;
+    // Already verified while indexing.
+    parseGameRecord(m_segments[loc.segment].data() + loc.offset, loc.size, view, consumed, false);
+    return view;
+  }
+
+  bool ReplayDb::matches(std::size_t i, const ReplayQuery& query) const noexcept
+  {
+    if (m_shotCount[i] < query.minShots || m_shotCount[i] > query.maxShots)
+    {
+      return false;
+    }
+    if (m_finishedAt[i] < query.finishedFromMs || m_finishedAt[i] > query.finishedToMs)
+    {
+      return false;
+    }
+    if (query.winner && m_winner[i] != *query.winner)
+    {
+      return false;
+    }
+    if (query.playerHash && m_players[i][0] != *query.playerHash && m_players[i][1] != *query.playerHash)
+    {
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<std::size_t> ReplayDb::select(const ReplayQuery& query) const
+  {
+    std::vector<std::size_t> out;
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+      if (matches(i, query))
+      {
+        out.push_back(i);
+      }
+    }
+    return out;
+  }
+
+  void ReplayDb::scan(const ReplayQuery& query, const std::function<void(unsigned, const GameRecordView&)>& fn) const
+  {
+    parallelFor(m_threads, size(), [&](unsigned worker, std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        if (matches(i, query))
+        {
+          fn(worker, view(i));
+        }
+      }
+    });
+  }
+
+  ShotHeatmap ReplayDb::shotHeatmap(const ReplayQuery& query) const
+  {
+    std::vector<ShotHeatmap> partial(m_threads);
+    scan(query, [&partial](unsigned worker, const GameRecordView& game) {
+      auto& map = partial[worker];
+      ++map.games;
+      for (const std::uint8_t shot : game.shots)
+      {
+        const std::size_t cell = shot & GameRecord::CELL_MASK;
+        if (cell < map.shots.size())
+        {
+          ++map.shots[cell];
+          map.hits[cell] += (shot & GameRecord::HIT_BIT) != 0 ? 1U : 0U;
+        }
+      }
+    });
+
+    ShotHeatmap total;
+    for (const auto& map : partial)
+    {
+      total.games += map.games;
+      for (std::size_t c = 0; c < total.shots.size(); ++c)
+      {
+        total.shots[c] += map.shots[c];
+        total.hits[c] += map.hits[c];
+      }
+    }
+    return total;
+  }
+
+}  // namespace server
@@ -0,0 +1,140 @@
+#include "server/request_trace.hpp"
+
+#include <charconv>
+
+#include "server/metrics.hpp"
+
+namespace server
+{
+  namespace
+  {
+    void appendNumber(std::string& out, std::uint64_t value)
+    {
+      char buf[24];
+      const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+      out.append(buf, res.ptr);
+    }
+
+    // Trace-event timestamps are microseconds; keep nanosecond precision as three decimals.
+    void appendMicros(std::string& out, std::uint64_t ns)
+    {
+      appendNumber(out, ns / 1000);
+      out.push_back('.');
+      const auto frac = ns % 1000;
+      out.push_back(static_cast<char>('0' + frac / 100));
+      out.push_back(static_cast<char>('0' + frac / 10 % 10));
+      out.push_back(static_cast<char>('0' + frac % 10));
+    }
+
+    void appendEvent(std::string& out,
+                     bool& first,
+                     std::string_view name,
+                     std::string_view category,
+                     std::uint64_t tid,
+                     std::uint64_t tsNs,
+                     std::uint64_t durNs,
+                     unsigned status)
+    {
+      out.append(first ? "" : ",");
+      first = false;
+      out.append("{\"name\":\"").append(name).append("\",\"cat\":\"").append(category);
+      out.append("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+      appendNumber(out, tid);
+      out.append(",\"ts\":");
+      appendMicros(out, tsNs);
+      out.append(",\"dur\":");
+      appendMicros(out, durNs);
+      if (status != 0)
+      {
+        out.append(",\"args\":{\"status\":");
+        appendNumber(out, status);
+        out.push_back('}');
+      }
+      out.push_back('}');
+    }
+  }  // namespace
+
+  const char* to_cstr(TraceStage stage) noexcept
+  {
+    switch (stage)
+    {
+      case TraceStage::Read: return "read";
+      case TraceStage::Route: return "route";
+      case TraceStage::Auth: return "auth";
+      case TraceStage::Parse: return "parse";
+      case TraceStage::Store: return "store";
+      case TraceStage::Serialize: return "serialize";
+      case TraceStage::Write: return "write";
+    }
+    return "unknown";
+  }
+
+  RequestTracer::RequestTracer()
+      : m_slowThresholdNs(static_cast<std::uint64_t>(std::chrono::nanoseconds{ DEFAULT_SLOW_THRESHOLD }.count())),
+        m_origin(RequestTrace::Clock::now()),
+        m_ring(CAPACITY)
+  {
+  }
+
+  void RequestTracer::setSlowThreshold(std::chrono::nanoseconds threshold) noexcept
+  {
+    m_slowThresholdNs.store(static_cast<std::uint64_t>(threshold.count() > 0 ? threshold.count() : 0),
+                            std::memory_order_relaxed);
+  }
+
+  void RequestTracer::finish(const RequestTrace& trace)
+  {
+    metrics().recordStages(trace);
+    if (trace.totalNs() < m_slowThresholdNs.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lk(m_mu);
+    auto& slot = m_ring[m_next];
+    slot = trace;
+    slot.id = ++m_recorded;
+    m_next = (m_next + 1) % m_ring.size();
+  }
+
+  std::vector<RequestTrace> RequestTracer::recent() const
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    const std::size_t held = m_recorded < m_ring.size() ? static_cast<std::size_t>(m_recorded) : m_ring.size();
+    std::vector<RequestTrace> out;
+    out.reserve(held);
+    for (std::size_t i = 0; i < held; ++i)
+    {
+      out.push_back(m_ring[(m_next + m_ring.size() - held + i) % m_ring.size()]);
+    }
+    return out;
+  }
+
+  void RequestTracer::writeChromeTrace(std::string& out) const
+  {
+    out.append("{\"traceEvents\":[");
+    bool first = true;
+    for (const auto& trace : recent())
+    {
+      const auto sinceOrigin = std::chrono::duration_cast<std::chrono::nanoseconds>(trace.start - m_origin).count();
+      std::uint64_t ts = sinceOrigin > 0 ? static_cast<std::uint64_t>(sinceOrigin) : 0;
+      appendEvent(out, first, to_cstr(trace.route), "request", trace.id, ts, trace.totalNs(), trace.status);
+      for (std::size_t i = 0; i < TRACE_STAGE_COUNT; ++i)
+      {
+        if (trace.stageNs[i] != 0)
+        {
+          appendEvent(out, first, to_cstr(static_cast<TraceStage>(i)), "stage", trace.id, ts, trace.stageNs[i], 0);
+          ts += trace.stageNs[i];
+        }
+      }
+    }
+    out.append("],\"displayTimeUnit\":\"ns\"}\n");
+  }
+
+  RequestTracer& tracer()
+  {
+    static RequestTracer instance;
+    return instance;
+  }
+
+}  // namespace server
@@ -0,0 +1,276 @@
+#include "server/route_table.hpp"
+
+#include <cstdint>
+
+namespace server
+{
+  namespace
+  {
+    struct RouteSpec
+    {
+      http::verb method;
+      std::string_view pattern;  // "{id}" marks the captured game id (the ticket under /matchmaking)
+      RouteId id;
+      bool requiresAuth;
+    };
+
+    constexpr std::string_view ID_PARAM = "{id}";
+
+    constexpr std::array ROUTES{
+      RouteSpec{ http::verb::post, "/games", RouteId::CreateGame, false },
+      RouteSpec{ http::verb::get, "/games", RouteId::ListGames, false },
+      RouteSpec{ http::verb::post, "/games/{id}/join", RouteId::JoinGame, false },
+      RouteSpec{ http::verb::get, "/games/{id}", RouteId::GetGame, true },
+      RouteSpec{ http::verb::post, "/games/{id}/place", RouteId::PlaceShip, true },
+      RouteSpec{ http::verb::post, "/games/{id}/fleet", RouteId::PlaceFleet, true },
+      RouteSpec{ http::verb::post, "/games/{id}/fleet/random", RouteId::PlaceRandomFleet, true },
+      RouteSpec{ http::verb::post, "/games/{id}/ready", RouteId::ReadyUp, true },
+      RouteSpec{ http::verb::post, "/games/{id}/shoot", RouteId::Shoot, true },
+      RouteSpec{ http::verb::get, "/games/{id}/history", RouteId::GetHistory, true },
+      RouteSpec{ http::verb::get, "/games/{id}/spectate", RouteId::Spectate, false },
+      RouteSpec{ http::verb::post, "/matchmaking", RouteId::Matchmake, false },
+      RouteSpec{ http::verb::get, "/matchmaking/{id}", RouteId::GetMatch, false },
+      RouteSpec{ http::verb::get, "/metrics", RouteId::Metrics, false },
+      RouteSpec{ http::verb::get, "/debug/traces", RouteId::DebugTraces, false },
+    };
+
+    constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+    constexpr std::uint64_t fnv(std::uint64_t h, std::string_view bytes) noexcept
+    {
+      for (const char ch : bytes)
+      {
+        h ^= static_cast<unsigned char>(ch);
+        h *= FNV_PRIME;
+      }
+      return h;
+    }
+
+    constexpr std::uint64_t fnv(std::uint64_t h, std::uint8_t byte) noexcept
+    {
+      h ^= byte;
+      return h * FNV_PRIME;
+    }
+
+    using ParamMask = std::uint32_t;  // bit i set => segment i is the {id} capture
+
+    // Hash of method, segment count and every literal segment; captured segments contribute only a marker.
+    std::uint64_t shape_hash(http::verb method, const PathSegments& path, ParamMask mask) noexcept
+    {
+      std::uint64_t h = fnv(FNV_OFFSET, static_cast<std::uint8_t>(method));
+      h = fnv(h, static_cast<std::uint8_t>(path.count));
+      for (std::size_t i = 0; i < path.count; ++i)
+      {
+        h = (mask & (1U << i)) != 0 ? fnv(h, std::uint8_t{ 0xFF }) : fnv(fnv(h, path.parts[i]), std::uint8_t{ '/' });
+      }
+      return h;
+    }
+
+    struct CompiledRoute
+    {
+      const RouteSpec* spec{ nullptr };
+      PathSegments pattern;
+      ParamMask mask{ 0 };
+      std::size_t idIndex{ 0 };
+    };
+
+    struct Slot
+    {
+      std::uint64_t hash{ 0 };
+      const CompiledRoute* route{ nullptr };
+    };
+
+    constexpr std::size_t TABLE_SIZE = 64;  // power of two, comfortably above 2x the route count
+    static_assert(ROUTES.size() * 2 <= TABLE_SIZE);
+
+    class RouteTable
+    {
+    public:
+      RouteTable() noexcept
+      {
+        for (std::size_t r = 0; r < ROUTES.size(); ++r)
+        {
+          CompiledRoute& compiled = m_routes[r];
+          compiled.spec = &ROUTES[r];
+          compiled.pattern = split_path(ROUTES[r].pattern);
+          for (std::size_t i = 0; i < compiled.pattern.count; ++i)
+          {
+            if (compiled.pattern.parts[i] == ID_PARAM)
+            {
+              compiled.mask |= 1U << i;
+              compiled.idIndex = i;
+            }
+          }
+
+          addMask(compiled.mask);
+          insert(shape_hash(compiled.spec->method, compiled.pattern, compiled.mask), compiled);
+        }
+      }
+
+      RouteMatch match(http::verb method, const PathSegments& path) const noexcept
+      {
+        if (path.overflow)
+        {
+          return {};
+        }
+
+        for (std::size_t m = 0; m < m_maskCount; ++m)
+        {
+          const ParamMask mask = m_masks[m];
+          const std::uint64_t h = shape_hash(method, path, mask);
+
+          for (std::size_t probe = 0; probe < TABLE_SIZE; ++probe)
+          {
+            const Slot& slot = m_slots[(h + probe) & (TABLE_SIZE - 1)];
+            if (slot.route == nullptr)
+            {
+              break;
+            }
+            if (slot.hash == h && matches(*slot.route, method, path))
+            {
+              const CompiledRoute& r = *slot.route;
+              return RouteMatch{ .id = r.spec->id,
+                                 .requiresAuth = r.spec->requiresAuth,
+                                 .gameId = r.mask != 0 ? path.parts[r.idIndex] : std::string_view{} };
+            }
+          }
+        }
+
+        return {};
+      }
+
+    private:
+      static bool matches(const CompiledRoute& route, http::verb method, const PathSegments& path) noexcept
+      {
+        if (route.spec->method != method || route.pattern.count != path.count)
+        {
+          return false;
+        }
+        for (std::size_t i = 0; i < path.count; ++i)
+        {
+          if ((route.mask & (1U << i)) == 0 && route.pattern.parts[i] != path.parts[i])
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      void addMask(ParamMask mask) noexcept
+      {
+        for (std::size_t m = 0; m < m_maskCount; ++m)
+        {
+          if (m_masks[m] == mask)
+          {
+            return;
+          }
+        }
+        m_masks[m_maskCount++] = mask;
+      }
+
+      void insert(std::uint64_t h, const CompiledRoute& route) noexcept
+      {
+        for (std::size_t probe = 0; probe < TABLE_SIZE; ++probe)
+        {
+          Slot& slot = m_slots[(h + probe) & (TABLE_SIZE - 1)];
+          if (slot.route == nullptr)
+          {
+            slot = Slot{ h, &route };
+            return;
+          }
+        }
+      }
+
+      std::array<CompiledRoute, ROUTES.size()> m_routes{};
+      std::array<Slot, TABLE_SIZE> m_slots{};
+      std::array<ParamMask, ROUTES.size()> m_masks{};
+      std::size_t m_maskCount{ 0 };
+    };
+
+    const RouteTable& route_table() noexcept
+    {
+      static const RouteTable table;
+      return table;
+    }
+  }  // namespace
+
+  const char* to_cstr(RouteId id) noexcept
+  {
+    switch (id)
+    {
+      case RouteId::CreateGame: return "create_game";
+      case RouteId::ListGames: return "list_games";
+      case RouteId::JoinGame: return "join_game";
+      case RouteId::GetGame: return "get_game";
+      case RouteId::PlaceShip: return "place_ship";
+      case RouteId::PlaceFleet: return "place_fleet";
+      case RouteId::PlaceRandomFleet: return "place_random_fleet";
+      case RouteId::ReadyUp: return "ready_up";
+      case RouteId::Shoot: return "shoot";
+      case RouteId::GetHistory: return "get_history";
+      case RouteId::Spectate: return "spectate";
+      case RouteId::Matchmake: return "matchmake";
+      case RouteId::GetMatch: return "get_match";
+      case RouteId::Metrics: return "metrics";
+      case RouteId::DebugTraces: return "debug_traces";
+      case RouteId::NotFound: return "not_found";
+    }
+    return "unknown";
+  }
+
+  PathSegments split_path(std::string_view target) noexcept
+  {
+    if (const std::size_t query_pos = target.find('?'); query_pos != std::string_view::npos)
+    {
+      target = target.substr(0, query_pos);
+    }
+
+    PathSegments out;
+    std::size_t pos = 0;
+    while (pos < target.size())
+    {
+      const std::size_t slash = target.find('/', pos);
+      const std::size_t end = slash == std::string_view::npos ? target.size() : slash;
+      if (end > pos)
+      {
+        if (out.count == PathSegments::CAPACITY)
+        {
+          out.overflow = true;
+          return out;
+        }
+        out.parts[out.count++] = target.substr(pos, end - pos);
+      }
+      pos = end + 1;
+    }
+    return out;
+  }
+
+  RouteMatch match_route(http::verb method, std::string_view target) noexcept
+  {
+    return route_table().match(method, split_path(target));
+  }
+
+  std::optional<std::string_view> query_param(std::string_view target, std::string_view name) noexcept
+  {
+    const auto q = target.find('?');
+    if (q == std::string_view::npos)
+    {
+      return std::nullopt;
+    }
+    std::string_view query = target.substr(q + 1);
+    while (!query.empty())
+    {
+      const auto amp = query.find('&');
+      const std::string_view pair = query.substr(0, amp);
+      const auto eq = pair.find('=');
+      if (pair.substr(0, eq) == name)
+      {
+        return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+      }
+      query = amp == std::string_view::npos ? std::string_view{} : query.substr(amp + 1);
+    }
+    return std::nullopt;
+  }
+
+}  // namespace server
@@ -0,0 +1,267 @@
+#include "server/server_config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace server
+{
+  namespace
+  {
+    template<typename T>
+    bool parseNumber(std::string_view text, T& out)
+    {
+      const auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+      return !text.empty() && res.ec == std::errc{} && res.ptr == text.data() + text.size();
+    }
+
+    bool parseSwitch(std::string_view text, bool& out)
+    {
+      if (text == "1" || text == "true" || text == "yes" || text == "on")
+      {
+        out = true;
+        return true;
+      }
+      if (text == "0" || text == "false" || text == "no" || text == "off")
+      {
+        out = false;
+        return true;
+      }
+      return false;
+    }
+
+    bool parseSeconds(std::string_view text, std::chrono::seconds& out)
+    {
+      unsigned seconds = 0;
+      if (!parseNumber(text, seconds))
+      {
+        return false;
+      }
+      out = std::chrono::seconds{ seconds };
+      return true;
+    }
+
+    bool parseMilliseconds(std::string_view text, std::chrono::milliseconds& out)
+    {
+      unsigned ms = 0;
+      if (!parseNumber(text, ms))
+      {
+        return false;
+      }
+      out = std::chrono::milliseconds{ ms };
+      return true;
+    }
+
+    struct Setting
+    {
+      const char* flag;
+      const char* env;
+      const char* value;  // placeholder shown in the usage; nullptr for on/off switches, which take no argument
+      const char* help;
+      bool (*apply)(ServerConfig&, std::string_view);
+    };
+
+    constexpr std::array<Setting, 28> SETTINGS{ {
+        { "--address", "BATTLESHIP_ADDRESS", "ADDR", "address to listen on (default 0.0.0.0)",
+          [](ServerConfig& c, std::string_view v) {
+            c.address = v;
+            return !v.empty();
+          } },
+        { "--port", "BATTLESHIP_PORT", "N", "port to listen on, 0 for any (default 8080)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.port); } },
+        { "--io-threads", "BATTLESHIP_IO_THREADS", "N", "threads running the event loop (default 1)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.ioThreads) && c.ioThreads > 0; } },
+        { "--pin-threads", "BATTLESHIP_PIN_THREADS", nullptr, "pin each I/O thread to its own CPU",
+          [](ServerConfig& c, std::string_view v) { return parseSwitch(v, c.pinThreads); } },
+        { "--reuse-port", "BATTLESHIP_REUSE_PORT", nullptr, "set SO_REUSEPORT so several processes can share the port",
+          [](ServerConfig& c, std::string_view v) { return parseSwitch(v, c.reusePort); } },
+        { "--backlog", "BATTLESHIP_BACKLOG", "N", "listen backlog (default 1024)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.backlog) && c.backlog > 0; } },
+        { "--keep-alive-timeout", "BATTLESHIP_KEEP_ALIVE_TIMEOUT", "S", "seconds an idle connection is kept open (default 30)",
+          [](ServerConfig& c, std::string_view v) { return parseSeconds(v, c.keepAliveTimeout) && c.keepAliveTimeout.count() > 0; } },
+        { "--max-connections", "BATTLESHIP_MAX_CONNECTIONS", "N", "open connections at most, 0 for unlimited (default 0)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.maxConnections); } },
+        { "--drain-timeout", "BATTLESHIP_DRAIN_TIMEOUT", "S", "seconds in-flight requests get after SIGTERM (default 10)",
+          [](ServerConfig& c, std::string_view v) { return parseSeconds(v, c.drainTimeout); } },
+        { "--max-in-flight", "BATTLESHIP_MAX_IN_FLIGHT", "N", "requests in flight at most, 0 for unlimited (default 0)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.maxInFlight); } },
+        { "--max-in-flight-per-token", "BATTLESHIP_MAX_IN_FLIGHT_PER_TOKEN", "N", "requests in flight per client token, 0 for unlimited (default 0)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.maxInFlightPerToken); } },
+        { "--token-rate", "BATTLESHIP_TOKEN_RATE", "R", "requests per second per client token, 0 for unlimited (default 0)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.tokenRate.perSecond) && c.tokenRate.perSecond >= 0; } },
+        { "--token-burst", "BATTLESHIP_TOKEN_BURST", "N", "back-to-back requests per client token (default: one second's worth)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.tokenRate.burst); } },
+        { "--ip-rate", "BATTLESHIP_IP_RATE", "R", "requests per second per client address, 0 for unlimited (default 0; not with --cluster)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.clientRate.perSecond) && c.clientRate.perSecond >= 0; } },
+        { "--ip-burst", "BATTLESHIP_IP_BURST", "N", "back-to-back requests per client address (default: one second's worth)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.clientRate.burst); } },
+        { "--game-shards", "BATTLESHIP_GAME_SHARDS", "N", "GameStore shards, each under its own lock (default 1, 4 per I/O thread with --game-actors)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.gameShards); } },
+        { "--game-actors", "BATTLESHIP_GAME_ACTORS", nullptr, "run every request on the strand that owns its game's shard",
+          [](ServerConfig& c, std::string_view v) { return parseSwitch(v, c.gameActors); } },
+        { "--io-uring", "BATTLESHIP_IO_URING", nullptr, "serve with io_uring when built with it and the kernel allows",
+          [](ServerConfig& c, std::string_view v) { return parseSwitch(v, c.ioUring); } },
+        { "--match-tickets", "BATTLESHIP_MATCH_TICKETS", "N", "players queued or matched at once, 0 disables /matchmaking (default 16384)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.matchTickets); } },
+        { "--match-timeout", "BATTLESHIP_MATCH_TIMEOUT", "S", "seconds a matchmaking ticket lives without a poll (default 30)",
+          [](ServerConfig& c, std::string_view v) { return parseSeconds(v, c.matchTimeout) && c.matchTimeout.count() > 0; } },
+        { "--spectators", "BATTLESHIP_SPECTATORS", "off|hidden|revealed", "spectator streams, showing ships only once a game ends when hidden (default hidden)",
+          [](ServerConfig& c, std::string_view v) {
+            const auto policy = parseSpectatorPolicy(v);
+            c.spectators = policy.value_or(c.spectators);
+            return policy.has_value();
+          } },
+        { "--wal", "BATTLESHIP_WAL", "PATH", "event log of every game change, replayed at startup (default: none)",
+          [](ServerConfig& c, std::string_view v) {
+            c.walPath = v;
+            return !v.empty();
+          } },
+        { "--commit-interval", "BATTLESHIP_COMMIT_INTERVAL", "MS", "milliseconds logged events wait to be synced (default 5)",
+          [](ServerConfig& c, std::string_view v) {
+            return parseMilliseconds(v, c.commitInterval) && c.commitInterval.count() > 0;
+          } },
+        { "--snapshot", "BATTLESHIP_SNAPSHOT", "PATH", "snapshot restored at startup and rewritten periodically (default: none)",
+          [](ServerConfig& c, std::string_view v) {
+            c.snapshotPath = v;
+            return !v.empty();
+          } },
+        { "--snapshot-interval", "BATTLESHIP_SNAPSHOT_INTERVAL", "S", "seconds between snapshots (default 60)",
+          [](ServerConfig& c, std::string_view v) { return parseSeconds(v, c.snapshotInterval) && c.snapshotInterval.count() > 0; } },
+        { "--record-dir", "BATTLESHIP_RECORD_DIR", "DIR", "directory finished games are archived to (default: none)",
+          [](ServerConfig& c, std::string_view v) {
+            c.recordDir = v;
+            return !v.empty();
+          } },
+        { "--cluster", "BATTLESHIP_CLUSTER", "HOST:PORT,...", "every node of a multi-process deployment, in node order",
+          [](ServerConfig& c, std::string_view v) {
+            auto nodes = parseClusterNodes(v);
+            if (nodes)
+            {
+              c.clusterNodes = std::move(*nodes);
+            }
+            return nodes.has_value();
+          } },
+        { "--node-index", "BATTLESHIP_NODE_INDEX", "N", "this process's place in --cluster; its games' ids start with it (default 0)",
+          [](ServerConfig& c, std::string_view v) { return parseNumber(v, c.nodeIndex); } },
+    } };
+  }  // namespace
+
+  battleship::Expected<ServerConfig, std::string> parseServerConfig(int argc, const char* const* argv, EnvLookup env)
+  {
+    ServerConfig config;
+
+    for (const auto& setting : SETTINGS)
+    {
+      const char* value = env != nullptr ? env(setting.env) : std::getenv(setting.env);
+      if (value != nullptr && !setting.apply(config, value))
+      {
+        return battleship::unexpected(std::string{ "Invalid value for " } + setting.env + ": " + value);
+      }
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string_view flag = argv[i];
+      const Setting* match = nullptr;
+      for (const auto& setting : SETTINGS)
+      {
+        if (flag == setting.flag)
+        {
+          match = &setting;
+        }
+      }
+      if (match == nullptr)
+      {
+        return battleship::unexpected("Unknown option " + std::string{ flag });
+      }
+
+      if (match->value == nullptr)
+      {
+        (void)match->apply(config, "1");
+        continue;
+      }
+      if (i + 1 >= argc)
+      {
+        return battleship::unexpected("Missing value for " + std::string{ flag });
+      }
+      const std::string_view value = argv[++i];
+      if (!match->apply(config, value))
+      {
+        return battleship::unexpected("Invalid value for " + std::string{ flag } + ": " + std::string{ value });
+      }
+    }
+
+    if (!config.clusterNodes.empty() && config.nodeIndex >= config.clusterNodes.size())
+    {
+      return battleship::unexpected("--node-index " + std::to_string(config.nodeIndex) + " is outside the "
+                                    + std::to_string(config.clusterNodes.size()) + " nodes of --cluster");
+    }
+    // Behind the router every request arrives from the router's address, so one shared bucket would throttle all
+    // clients together; the router forwards no address a node could trust instead.
+    if (!config.clusterNodes.empty() && config.clientRate.perSecond > 0)
+    {
+      return battleship::unexpected(
+          std::string{ "--ip-rate cannot be combined with --cluster: nodes only see the router's address" });
+    }
+    return config;
+  }
+
+  std::string serverUsage(const char* argv0)
+  {
+    std::string out = "Usage: " + std::string{ argv0 } + " [options]\n";
+    for (const auto& setting : SETTINGS)
+    {
+      std::string option = std::string{ "  " } + setting.flag;
+      if (setting.value != nullptr)
+      {
+        option.append(" ").append(setting.value);
+      }
+      option.resize(std::max<std::size_t>(option.size() + 1, 28), ' ');
+      out.append(option).append(setting.help).append(" [").append(setting.env).append("]\n");
+    }
+    return out;
+  }
+
+  std::size_t gameShardCount(const ServerConfig& config) noexcept
+  {
+    if (config.gameShards != 0)
+    {
+      return config.gameShards;
+    }
+    return config.gameActors ? 4 * std::size_t{ config.ioThreads } : 1;
+  }
+
+  std::string gameIdPrefix(const ServerConfig& config)
+  {
+    return gameIdPrefix(config.nodeIndex, config.clusterNodes.size());
+  }
+
+  void pinThreadToCpu(unsigned index)
+  {
+#ifdef __linux__
+    const unsigned cpus = std::max(1U, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    if (const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+    {
+      std::cerr << "Cannot pin I/O thread " << index << " to CPU " << index % cpus << " (error " << err << ")\n";
+    }
+#else
+    (void)index;
+    std::cerr << "CPU pinning is only supported on Linux; ignoring --pin-threads\n";
+#endif
+  }
+
+}  // namespace server
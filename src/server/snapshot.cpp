@@ -0,0 +1,358 @@
+#include "server/snapshot.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+#include "server/binary_codec.hpp"
+#include "server/event_log.hpp"
+#include "server/game_store.hpp"
+#include "server/mapped_file.hpp"
+
+namespace server
+{
+  namespace
+  {
+    constexpr char MAGIC[8] = { 'B', 'S', 'S', 'N', 'A', 'P', '0', '2' };
+    constexpr std::size_t TRAILER_SIZE = 4 + 8 + 8 + sizeof(MAGIC);
+    constexpr std::size_t TABLE_ENTRY_SIZE = 8 + 4 + 4 + 4;
+
+    [[noreturn]] void throwErrno(const char* what)
+    {
+      throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // Boards are not stored; they are rebuilt from the game's history, which players alternate through
+    // starting with player 1.
+    bool rebuildBoards(GameState& game)
+    {
+      for (int p = 0; p < 2; ++p)
+      {
+        for (const auto packed : game.history.fleets[static_cast<std::size_t>(p)])
+        {
+          const auto ship = GameRecord::unpackPlacement(packed);
+          if (game.boards[p].tryPlaceStructure(battleship::Boat{ ship.type }, ship.placement) !=
+              battleship::BoardError::None)
+          {
+            return false;
+          }
+        }
+      }
+
+      for (std::size_t i = 0; i < game.history.shots.size(); ++i)
+      {
+        const auto target = GameRecord::unpackCell(game.history.shots[i]);
+        if (!game.boards[1 - i % 2].tryHandleShot(target))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool decodeGame(const char* data, codec::Reader& in, GameState& game)
+    {
+      std::uint8_t flags = 0;
+      std::uint8_t turn = 0;
+      std::uint8_t status = 0;
+      if (!in.string(game.token[0]) || !in.string(game.token[1]) || !in.u8(flags) || !in.u8(turn) ||
+          !in.u8(status) || !in.u64(game.lastSeq) || turn > 1 ||
+          status > static_cast<std::uint8_t>(GameStatus::Finished))
+      {
+        return false;
+      }
+      game.joined[0] = (flags & 0x1U) != 0;
+      game.joined[1] = (flags & 0x2U) != 0;
+      game.ready[0] = (flags & 0x4U) != 0;
+      game.ready[1] = (flags & 0x8U) != 0;
+      game.turn = turn;
+      game.status = static_cast<GameStatus>(status);
+
+      std::size_t consumed = 0;
+      auto history = decodeGameRecord(data + in.position(), in.remaining(), consumed);
+      if (!history)
+      {
+        return false;
+      }
+      in.skip(consumed);
+      game.history = std::move(*history);
+      return rebuildBoards(game);
+    }
+
+    struct Chunk
+    {
+      const char* data;
+      std::uint32_t size;
+      std::uint32_t games;
+    };
+
+    bool decodeChunk(const Chunk& chunk, std::vector<std::pair<std::string, std::shared_ptr<GameState>>>& out)
+    {
+      codec::Reader in{ chunk.data, chunk.size };
+      for (std::uint32_t i = 0; i < chunk.games; ++i)
+      {
+        auto game = std::make_shared<GameState>();
+        if (!decodeGame(chunk.data, in, *game))
+        {
+          return false;
+        }
+        out.emplace_back(game->history.gameId, std::move(game));
+      }
+      return in.done();
+    }
+  }  // namespace
+
+  SnapshotWriter::SnapshotWriter(std::string path) : m_path(std::move(path)), m_tmpPath(m_path + ".tmp")
+  {
+    m_fd = ::open(m_tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+      throwErrno("snapshot open");
+    }
+  }
+
+  SnapshotWriter::~SnapshotWriter()
+  {
+    if (m_fd >= 0)
+    {
+      ::close(m_fd);
+    }
+    if (!m_committed)
+    {
+      std::remove(m_tmpPath.c_str());
+    }
+  }
+
+  void SnapshotWriter::addGame(const GameState& game)
+  {
+    codec::putString(m_chunk, game.token[0]);
+    codec::putString(m_chunk, game.token[1]);
+    const auto flags = static_cast<std::uint8_t>((game.joined[0] ? 0x1U : 0U) | (game.joined[1] ? 0x2U : 0U) |
+                                                 (game.ready[0] ? 0x4U : 0U) | (game.ready[1] ? 0x8U : 0U));
+    codec::putU8(m_chunk, flags);
+    codec::putU8(m_chunk, static_cast<std::uint8_t>(game.turn));
+    codec::putU8(m_chunk, static_cast<std::uint8_t>(game.status));
+    codec::putU64(m_chunk, game.lastSeq);
+    encodeGameRecord(game.history, m_chunk);
+    ++m_chunkGames;
+  }
+
+  void SnapshotWriter::endChunk()
+  {
+    if (m_chunkGames == 0)
+    {
+      return;
+    }
+    m_table.push_back(ChunkEntry{ m_offset,
+                                  static_cast<std::uint32_t>(m_chunk.size()),
+                                  m_chunkGames,
+                                  codec::crc32(m_chunk.data(), m_chunk.size()) });
+    write(m_chunk);
+    m_chunk.clear();
+    m_chunkGames = 0;
+  }
+
+  void SnapshotWriter::commit(std::uint64_t baseSeq)
+  {
+    endChunk();
+
+    const std::uint64_t tableOffset = m_offset;
+    std::string trailer;
+    trailer.reserve(m_table.size() * TABLE_ENTRY_SIZE + TRAILER_SIZE);
+    for (const auto& entry : m_table)
+    {
+      codec::putU64(trailer, entry.offset);
+      codec::putU32(trailer, entry.size);
+      codec::putU32(trailer, entry.games);
+      codec::putU32(trailer, entry.crc);
+    }
+    codec::putU32(trailer, static_cast<std::uint32_t>(m_table.size()));
+    codec::putU64(trailer, baseSeq);
+    codec::putU64(trailer, tableOffset);
+    trailer.append(MAGIC, sizeof(MAGIC));
+    write(trailer);
+
+    if (::fsync(m_fd) != 0)
+    {
+      throwErrno("snapshot sync");
+    }
+    ::close(m_fd);
+    m_fd = -1;
+    if (::rename(m_tmpPath.c_str(), m_path.c_str()) != 0)
+    {
+      throwErrno("snapshot rename");
+    }
+    // Until the directory is synced the rename can be lost, and the log rotation after a snapshot would
+    // then drop events that no snapshot on disk covers.
+    syncParentDirectory(m_path);
+    m_committed = true;
+  }
+
+  void SnapshotWriter::write(const std::string& bytes)
+  {
+    std::size_t off = 0;
+    while (off < bytes.size())
+    {
+      const ::ssize_t n = ::write(m_fd, bytes.data() + off, bytes.size() - off);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        throwErrno("snapshot write");
+      }
+      off += static_cast<std::size_t>(n);
+    }
+    m_offset += bytes.size();
+  }
+
+  std::optional<LoadedSnapshot> readSnapshot(const std::string& path, unsigned threads)
+  {
+    const MappedFile file{ path };
+    if (file.size() < TRAILER_SIZE ||
+        std::memcmp(file.data() + file.size() - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0)
+    {
+      return std::nullopt;
+    }
+
+    LoadedSnapshot snapshot;
+    std::uint32_t chunkCount = 0;
+    std::uint64_t tableOffset = 0;
+    codec::Reader trailer{ file.data() + file.size() - TRAILER_SIZE, TRAILER_SIZE };
+    trailer.u32(chunkCount);
+    trailer.u64(snapshot.baseSeq);
+    trailer.u64(tableOffset);
+    if (tableOffset + std::uint64_t{ chunkCount } * TABLE_ENTRY_SIZE + TRAILER_SIZE != file.size())
+    {
+      return std::nullopt;
+    }
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunkCount);
+    std::size_t totalGames = 0;
+    codec::Reader table{ file.data() + tableOffset, std::size_t{ chunkCount } * TABLE_ENTRY_SIZE };
+    for (std::uint32_t i = 0; i < chunkCount; ++i)
+    {
+      std::uint64_t offset = 0;
+      std::uint32_t size = 0;
+      std::uint32_t games = 0;
+      std::uint32_t crc = 0;
+      table.u64(offset);
+      table.u32(size);
+      table.u32(games);
+      table.u32(crc);
+      if (offset + size > tableOffset || codec::crc32(file.data() + offset, size) != crc)
+      {
+        return std::nullopt;
+      }
+      chunks.push_back(Chunk{ file.data() + offset, size, games });
+      totalGames += games;
+    }
+
+    if (threads == 0)
+    {
+      threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(chunks.size(), 1)));
+
+    // Worker w decodes chunks w, w + threads, ...; results are concatenated afterwards.
+    std::vector<std::vector<std::pair<std::string, std::shared_ptr<GameState>>>> parts(threads);
+    std::vector<char> ok(threads, 1);
+    auto work = [&](unsigned w) {
+      for (std::size_t i = w; i < chunks.size(); i += threads)
+      {
+        if (!decodeChunk(chunks[i], parts[w]))
+        {
+          ok[w] = 0;
+          return;
+        }
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned w = 1; w < threads; ++w)
+    {
+      workers.emplace_back(work, w);
+    }
+    work(0);
+    for (auto& t : workers)
+    {
+      t.join();
+    }
+
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end())
+    {
+      return std::nullopt;
+    }
+
+    snapshot.games.reserve(totalGames);
+    for (auto& part : parts)
+    {
+      std::move(part.begin(), part.end(), std::back_inserter(snapshot.games));
+    }
+    return snapshot;
+  }
+
+  Snapshotter::Snapshotter(GameStore& store, std::shared_ptr<EventLog> log, SnapshotOptions options)
+      : m_store(store),
+        m_log(std::move(log)),
+        m_options(std::move(options))
+  {
+    m_thread = std::thread([this] { run(); });
+  }
+
+  Snapshotter::~Snapshotter()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mu);
+      m_stop = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable())
+    {
+      m_thread.join();
+    }
+  }
+
+  std::size_t Snapshotter::snapshotNow()
+  {
+    std::lock_guard<std::mutex> lk(m_snapshotMu);
+
+    const std::size_t games = m_store.writeSnapshot(m_options.path);
+    // The snapshot covers everything in "<log>.prev". The current file may still hold events newer than a
+    // game's captured state, so it is kept as the new ".prev" rather than dropped.
+    if (m_log)
+    {
+      m_log->rotate();
+    }
+    return games;
+  }
+
+  void Snapshotter::run()
+  {
+    std::unique_lock<std::mutex> lk(m_mu);
+    while (!m_wake.wait_for(lk, m_options.interval, [&] { return m_stop; }))
+    {
+      lk.unlock();
+      try
+      {
+        snapshotNow();
+      }
+      catch (const std::exception& e)
+      {
+        std::cerr << "snapshot: " << e.what() << std::endl;
+      }
+      lk.lock();
+    }
+  }
+
+}  // namespace server
@@ -0,0 +1,123 @@
+#include "server/spectator_hub.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "server/binary_codec.hpp"
+
+namespace server
+{
+  const char* to_cstr(SpectatorPolicy policy) noexcept
+  {
+    switch (policy)
+    {
+      case SpectatorPolicy::Off: return "off";
+      case SpectatorPolicy::Hidden: return "hidden";
+      case SpectatorPolicy::Revealed: return "revealed";
+    }
+    return "unknown";
+  }
+
+  std::optional<SpectatorPolicy> parseSpectatorPolicy(std::string_view text) noexcept
+  {
+    for (const auto policy : { SpectatorPolicy::Off, SpectatorPolicy::Hidden, SpectatorPolicy::Revealed })
+    {
+      if (text == to_cstr(policy))
+      {
+        return policy;
+      }
+    }
+    return std::nullopt;
+  }
+
+  SpectatorHub::SpectatorHub(SpectatorPolicy policy)
+      : m_policy(policy),
+        m_shards(std::make_unique<Shard[]>(SHARDS))
+  {
+  }
+
+  SpectatorHub::Shard& SpectatorHub::shardFor(std::string_view gameId) const noexcept
+  {
+    return m_shards[codec::fnv1a64(gameId) % SHARDS];
+  }
+
+  SpectatorFrame SpectatorHub::subscribe(const std::string& gameId, std::weak_ptr<SpectatorViewer> viewer)
+  {
+    Shard& shard = shardFor(gameId);
+    std::lock_guard<std::mutex> lk(shard.mu);
+    auto& channel = shard.channels[gameId];
+    channel.viewers.push_back(std::move(viewer));
+    m_viewers.fetch_add(1, std::memory_order_relaxed);
+    return channel.frame;
+  }
+
+  void SpectatorHub::unsubscribe(const std::string& gameId, const SpectatorViewer* viewer)
+  {
+    Shard& shard = shardFor(gameId);
+    std::lock_guard<std::mutex> lk(shard.mu);
+    const auto it = shard.channels.find(gameId);
+    if (it == shard.channels.end())
+    {
+      return;
+    }
+
+    auto& viewers = it->second.viewers;
+    const auto removed = std::erase_if(viewers, [viewer](const std::weak_ptr<SpectatorViewer>& weak) {
+      const auto alive = weak.lock();
+      return alive == nullptr || alive.get() == viewer;
+    });
+    m_viewers.fetch_sub(removed, std::memory_order_relaxed);
+    if (viewers.empty())
+    {
+      shard.channels.erase(it);
+    }
+  }
+
+  bool SpectatorHub::watched(const std::string& gameId) const
+  {
+    if (viewerCount() == 0)
+    {
+      return false;
+    }
+    const Shard& shard = shardFor(gameId);
+    std::lock_guard<std::mutex> lk(shard.mu);
+    return shard.channels.contains(gameId);
+  }
+
+  void SpectatorHub::publish(const std::string& gameId, std::uint64_t revision, const SpectatorFrame& frame)
+  {
+    std::vector<std::shared_ptr<SpectatorViewer>> viewers;
+    {
+      Shard& shard = shardFor(gameId);
+      std::lock_guard<std::mutex> lk(shard.mu);
+      const auto it = shard.channels.find(gameId);
+      if (it == shard.channels.end())
+      {
+        return;
+      }
+      auto& channel = it->second;
+      if (channel.frame != nullptr && revision <= channel.revision)
+      {
+        return;
+      }
+      channel.revision = revision;
+      channel.frame = frame;
+
+      viewers.reserve(channel.viewers.size());
+      for (const auto& weak : channel.viewers)
+      {
+        if (auto viewer = weak.lock())
+        {
+          viewers.push_back(std::move(viewer));
+        }
+      }
+    }
+
+    // Outside the lock: viewers only queue the frame, but subscribing must not wait on thousands of them.
+    for (const auto& viewer : viewers)
+    {
+      viewer->deliver(frame, revision);
+    }
+  }
+
+}  // namespace server
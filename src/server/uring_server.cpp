@@ -0,0 +1,919 @@
+#include "server/uring_server.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(BATTLESHIP_IO_URING) && defined(__linux__)
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "server/admission.hpp"
+#include "server/http_router.hpp"
+#include "server/metrics.hpp"
+#include "server/request_trace.hpp"
+
+#endif
+
+namespace server
+{
+#if defined(BATTLESHIP_IO_URING) && defined(__linux__)
+
+  namespace asio = boost::asio;
+  namespace beast = boost::beast;
+  namespace http = boost::beast::http;
+
+  namespace
+  {
+    using Clock = std::chrono::steady_clock;
+
+    // Connections one ring serves when ServerConfig::maxConnections leaves it open.
+    constexpr std::size_t DEFAULT_SLOTS = 1024;
+    // Per connection, one registered buffer for reads and one for writes.
+    constexpr std::size_t IO_BUFFER_SIZE = BufferPool::INITIAL_CAPACITY;
+
+    [[noreturn]] void throwErrno(int err, const char* what)
+    {
+      throw std::system_error(err, std::generic_category(), what);
+    }
+
+    // Rate-limiting key of the peer's address; 0 when it cannot be read.
+    std::uint64_t clientKey(int fd) noexcept
+    {
+      sockaddr_storage peer{};
+      socklen_t size = sizeof(peer);
+      if (getpeername(fd, reinterpret_cast<sockaddr*>(&peer), &size) != 0)
+      {
+        return 0;
+      }
+      if (peer.ss_family == AF_INET)
+      {
+        const auto& v4 = reinterpret_cast<const sockaddr_in&>(peer);
+        return RateLimiter::keyFor({ reinterpret_cast<const char*>(&v4.sin_addr), sizeof(v4.sin_addr) });
+      }
+      const auto& v6 = reinterpret_cast<const sockaddr_in6&>(peer);
+      return RateLimiter::keyFor({ reinterpret_cast<const char*>(&v6.sin6_addr), sizeof(v6.sin6_addr) });
+    }
+
+    // One io_uring instance with its submission and completion queues mapped into this process. Only the thread
+    // that owns it touches it; the kernel is the other side of both queues.
+    class Ring
+    {
+    public:
+      explicit Ring(unsigned entries)
+      {
+        io_uring_params params{};
+        m_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (m_fd < 0)
+        {
+          throwErrno(errno, "io_uring_setup");
+        }
+
+        try
+        {
+          m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+          m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+          const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+          if (singleMmap)
+          {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+          }
+          m_sqRing = map(m_sqRingSize, IORING_OFF_SQ_RING);
+          m_cqRing = singleMmap ? m_sqRing : map(m_cqRingSize, IORING_OFF_CQ_RING);
+          m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+          m_sqes = static_cast<io_uring_sqe*>(map(m_sqesSize, IORING_OFF_SQES));
+        }
+        catch (...)
+        {
+          release();
+          throw;
+        }
+
+        auto* sq = static_cast<char*>(m_sqRing);
+        m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sqEntries = params.sq_entries;
+        m_tail = m_submitted = *m_sqTail;
+
+        auto* cq = static_cast<char*>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+      }
+
+      ~Ring() { release(); }
+
+      Ring(const Ring&) = delete;
+      Ring& operator=(const Ring&) = delete;
+
+      // A zeroed submission entry. When the queue is full, what is queued so far is handed to the kernel first.
+      io_uring_sqe& sqe()
+      {
+        if (m_tail - std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire) >= m_sqEntries)
+        {
+          submit(0);
+        }
+        const unsigned index = m_tail & m_sqMask;
+        m_sqArray[index] = index;
+        ++m_tail;
+        io_uring_sqe& entry = m_sqes[index];
+        std::memset(&entry, 0, sizeof(entry));
+        return entry;
+      }
+
+      // Hands queued entries to the kernel and, with `waitFor` > 0, blocks until that many completions are in.
+      void submit(unsigned waitFor)
+      {
+        std::atomic_ref<unsigned>(*m_sqTail).store(m_tail, std::memory_order_release);
+        for (;;)
+        {
+          const unsigned pending = m_tail - m_submitted;
+          const auto res = syscall(__NR_io_uring_enter, m_fd, pending, waitFor,
+                                   waitFor > 0 ? IORING_ENTER_GETEVENTS : 0U, nullptr, 0);
+          if (res >= 0)
+          {
+            m_submitted += static_cast<unsigned>(res);
+            return;
+          }
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          // The completion queue is full: reap it before submitting more.
+          if (errno == EBUSY || errno == EAGAIN)
+          {
+            return;
+          }
+          throwErrno(errno, "io_uring_enter");
+        }
+      }
+
+      template<typename Fn>
+      void forEachCompletion(Fn&& fn)
+      {
+        unsigned head = *m_cqHead;
+        const unsigned tail = std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire);
+        for (; head != tail; ++head)
+        {
+          const io_uring_cqe cqe = m_cqes[head & m_cqMask];
+          fn(cqe);
+        }
+        std::atomic_ref<unsigned>(*m_cqHead).store(head, std::memory_order_release);
+      }
+
+      // Pins `size` bytes at `data` for IORING_OP_READ_FIXED / WRITE_FIXED with buf_index 0. Fails when the
+      // memlock limit is too low, in which case plain recv/send still work on the same memory.
+      bool registerBuffer(void* data, std::size_t size) noexcept
+      {
+        iovec iov{ data, size };
+        return syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+      }
+
+    private:
+      void* map(std::size_t size, std::uint64_t offset)
+      {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                         static_cast<off_t>(offset));
+        if (ptr == MAP_FAILED)
+        {
+          throwErrno(errno, "io_uring mmap");
+        }
+        return ptr;
+      }
+
+      void release() noexcept
+      {
+        if (m_sqes != nullptr)
+        {
+          munmap(m_sqes, m_sqesSize);
+        }
+        if (m_cqRing != nullptr && m_cqRing != m_sqRing)
+        {
+          munmap(m_cqRing, m_cqRingSize);
+        }
+        if (m_sqRing != nullptr)
+        {
+          munmap(m_sqRing, m_sqRingSize);
+        }
+        if (m_fd >= 0)
+        {
+          close(m_fd);
+        }
+      }
+
+    private:
+      int m_fd{ -1 };
+      void* m_sqRing{ nullptr };
+      void* m_cqRing{ nullptr };
+      io_uring_sqe* m_sqes{ nullptr };
+      std::size_t m_sqRingSize{ 0 };
+      std::size_t m_cqRingSize{ 0 };
+      std::size_t m_sqesSize{ 0 };
+
+      unsigned* m_sqHead{ nullptr };
+      unsigned* m_sqTail{ nullptr };
+      unsigned* m_sqArray{ nullptr };
+      unsigned m_sqMask{ 0 };
+      unsigned m_sqEntries{ 0 };
+      unsigned m_tail{ 0 };       // next entry to fill
+      unsigned m_submitted{ 0 };  // entries the kernel has consumed
+
+      unsigned* m_cqHead{ nullptr };
+      unsigned* m_cqTail{ nullptr };
+      unsigned m_cqMask{ 0 };
+      io_uring_cqe* m_cqes{ nullptr };
+    };
+
+    // What a completion belongs to, packed into user_data above the connection slot.
+    enum class Op : std::uint32_t
+    {
+      Accept,
+      Read,
+      Write,
+      Tick,
+      Wake,
+      Cancel
+    };
+
+    std::uint64_t userData(Op op, std::uint32_t slot = 0) noexcept
+    {
+      return (static_cast<std::uint64_t>(op) << 32U) | slot;
+    }
+
+    // Writes a serialized response into `out`, reusing its capacity.
+    void serialize(http::response<http::string_body>& res, std::string& out)
+    {
+      out.clear();
+      http::serializer<false, http::string_body> sr{ res };
+      beast::error_code ec;
+      do
+      {
+        sr.next(ec, [&](beast::error_code&, const auto& buffers) {
+          for (const auto buffer : beast::buffers_range_ref(buffers))
+          {
+            out.append(static_cast<const char*>(buffer.data()), buffer.size());
+          }
+          sr.consume(beast::buffer_bytes(buffers));
+        });
+      } while (!ec && !sr.is_done());
+    }
+
+    // One connection slot. A connection always has exactly one read or write queued on the ring; a parser is
+    // present while a request is partly read, so a queued read without one means the connection is idle.
+    struct Connection
+    {
+      int fd{ -1 };
+      std::uint64_t client{ 0 };
+      bool reading{ false };
+      Clock::time_point lastActive{};
+      beast::flat_buffer in;
+      std::optional<http::request_parser<http::string_body>> parser;
+      http::request<http::string_body> req;
+      http::response<http::string_body> res;
+      std::string out;
+      std::size_t sent{ 0 };
+      RequestTrace trace;
+      RequestTrace* traced{ nullptr };
+      AdmissionTicket ticket;
+    };
+
+    // One I/O thread: a ring, the connections it accepted and their buffers. Everything here runs on that thread;
+    // wake() is the only entry point for other threads.
+    class Worker
+    {
+    public:
+      Worker(GameStore& store,
+             const ServerConfig& config,
+             BufferPool& pool,
+             AdmissionControl& admission,
+             const std::atomic<bool>& draining,
+             int listenFd,
+             std::size_t slots)
+          : m_store(store),
+            m_config(config),
+            m_pool(pool),
+            m_admission(admission),
+            m_draining(draining),
+            m_listenFd(listenFd),
+            m_connections(slots),
+            m_arena(std::make_unique<char[]>(slots * 2 * IO_BUFFER_SIZE)),
+            m_wakeFd(eventfd(0, EFD_CLOEXEC)),
+            m_ring(static_cast<unsigned>(std::min<std::size_t>(slots + 8, 32768)))
+      {
+        if (m_wakeFd < 0)
+        {
+          throwErrno(errno, "eventfd");
+        }
+        m_registered = m_ring.registerBuffer(m_arena.get(), slots * 2 * IO_BUFFER_SIZE);
+        m_freeSlots.reserve(slots);
+        for (std::size_t slot = slots; slot-- > 0;)
+        {
+          m_freeSlots.push_back(static_cast<std::uint32_t>(slot));
+        }
+      }
+
+      ~Worker() { close(m_wakeFd); }
+
+      Worker(const Worker&) = delete;
+      Worker& operator=(const Worker&) = delete;
+
+      // Serves connections until a drain has closed the last of them.
+      void run()
+      {
+        armAccept();
+        armTick();
+        armWake();
+        while (!(m_drainStarted && m_open == 0 && !m_acceptQueued))
+        {
+          m_ring.submit(1);
+          m_ring.forEachCompletion([this](const io_uring_cqe& cqe) { dispatch(cqe); });
+        }
+      }
+
+      void wake() noexcept
+      {
+        const std::uint64_t one = 1;
+        (void)!write(m_wakeFd, &one, sizeof(one));
+      }
+
+    private:
+      char* readBuffer(std::uint32_t slot) noexcept { return m_arena.get() + slot * 2 * IO_BUFFER_SIZE; }
+      char* writeBuffer(std::uint32_t slot) noexcept { return readBuffer(slot) + IO_BUFFER_SIZE; }
+
+      void dispatch(const io_uring_cqe& cqe)
+      {
+        const auto slot = static_cast<std::uint32_t>(cqe.user_data);
+        switch (static_cast<Op>(cqe.user_data >> 32U))
+        {
+          case Op::Accept: onAccept(cqe.res); break;
+          case Op::Read: onRead(slot, cqe.res); break;
+          case Op::Write: onWrite(slot, cqe.res); break;
+          case Op::Tick: onTick(); break;
+          case Op::Wake: onWake(); break;
+          case Op::Cancel: break;
+        }
+      }
+
+      void armAccept()
+      {
+        io_uring_sqe& sqe = m_ring.sqe();
+        sqe.opcode = IORING_OP_ACCEPT;
+        sqe.fd = m_listenFd;
+        sqe.accept_flags = SOCK_CLOEXEC;
+        sqe.user_data = userData(Op::Accept);
+        m_acceptQueued = true;
+      }
+
+      // Once a second: keep-alive and stalled-write timeouts, and the drain deadline.
+      void armTick()
+      {
+        io_uring_sqe& sqe = m_ring.sqe();
+        sqe.opcode = IORING_OP_TIMEOUT;
+        sqe.addr = reinterpret_cast<std::uint64_t>(&m_tick);
+        sqe.len = 1;
+        sqe.user_data = userData(Op::Tick);
+      }
+
+      void armWake()
+      {
+        io_uring_sqe& sqe = m_ring.sqe();
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = m_wakeFd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(&m_wakeValue);
+        sqe.len = sizeof(m_wakeValue);
+        sqe.user_data = userData(Op::Wake);
+      }
+
+      void queueRead(std::uint32_t slot)
+      {
+        Connection& c = m_connections[slot];
+        c.reading = true;
+        io_uring_sqe& sqe = m_ring.sqe();
+        sqe.opcode = m_registered ? IORING_OP_READ_FIXED : IORING_OP_RECV;
+        sqe.fd = c.fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(readBuffer(slot));
+        sqe.len = IO_BUFFER_SIZE;
+        sqe.user_data = userData(Op::Read, slot);
+      }
+
+      // Responses that fit go out of the slot's registered buffer; larger ones are sent straight from `out`.
+      void queueWrite(std::uint32_t slot)
+      {
+        Connection& c = m_connections[slot];
+        c.reading = false;
+        const std::size_t remaining = c.out.size() - c.sent;
+        io_uring_sqe& sqe = m_ring.sqe();
+        sqe.fd = c.fd;
+        sqe.len = static_cast<std::uint32_t>(remaining);
+        sqe.user_data = userData(Op::Write, slot);
+        if (m_registered && remaining <= IO_BUFFER_SIZE)
+        {
+          std::memcpy(writeBuffer(slot), c.out.data() + c.sent, remaining);
+          sqe.opcode = IORING_OP_WRITE_FIXED;
+          sqe.addr = reinterpret_cast<std::uint64_t>(writeBuffer(slot));
+        }
+        else
+        {
+          sqe.opcode = IORING_OP_SEND;
+          sqe.addr = reinterpret_cast<std::uint64_t>(c.out.data() + c.sent);
+          sqe.msg_flags = MSG_NOSIGNAL;
+        }
+      }
+
+      void onAccept(int res)
+      {
+        m_acceptQueued = false;
+        if (res >= 0)
+        {
+          if (m_drainStarted)
+          {
+            close(res);
+            return;
+          }
+          open(res);
+        }
+        // At the slot limit, leave further connections in the listen backlog until one closes.
+        if (!m_drainStarted && !m_freeSlots.empty())
+        {
+          armAccept();
+        }
+      }
+
+      void open(int fd)
+      {
+        const std::uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        ++m_open;
+        metrics().connectionOpened();
+
+        Connection& c = m_connections[slot];
+        c.fd = fd;
+        c.client = clientKey(fd);
+        c.lastActive = Clock::now();
+        c.in.clear();
+        c.req.body() = m_pool.acquire();
+        c.res.body() = m_pool.acquire();
+        queueRead(slot);
+      }
+
+      void closeSlot(std::uint32_t slot)
+      {
+        Connection& c = m_connections[slot];
+        if (c.parser.has_value())
+        {
+          c.req = c.parser->release();
+          c.parser.reset();
+        }
+        m_pool.release(std::move(c.req.body()));
+        m_pool.release(std::move(c.res.body()));
+        c.ticket.reset();
+        close(c.fd);
+        c.fd = -1;
+        c.reading = false;
+
+        m_freeSlots.push_back(slot);
+        --m_open;
+        metrics().connectionClosed();
+        if (!m_drainStarted && !m_acceptQueued)
+        {
+          armAccept();
+        }
+      }
+
+      void onRead(std::uint32_t slot, int res)
+      {
+        Connection& c = m_connections[slot];
+        c.reading = false;
+        c.lastActive = Clock::now();
+        if (res <= 0)
+        {
+          closeSlot(slot);
+          return;
+        }
+        const auto bytes = static_cast<std::size_t>(res);
+        std::memcpy(c.in.prepare(bytes).data(), readBuffer(slot), bytes);
+        c.in.commit(bytes);
+        advance(slot);
+      }
+
+      // Feeds buffered bytes to the parser: answers the request once it is complete, reads more otherwise.
+      void advance(std::uint32_t slot)
+      {
+        Connection& c = m_connections[slot];
+        if (!c.parser.has_value())
+        {
+          // Keep-alive idle time is not part of a request: its trace starts once the first bytes are in.
+          c.req.clear();
+          c.req.body().clear();
+          c.parser.emplace(std::move(c.req));
+          c.parser->eager(true);
+          c.ticket = m_admission.enter(c.client);
+          c.traced = tracer().enabled() ? &c.trace : nullptr;
+          if (c.traced != nullptr)
+          {
+            c.traced->begin();
+          }
+        }
+
+        while (c.in.size() > 0 && !c.parser->is_done())
+        {
+          beast::error_code ec;
+          c.in.consume(c.parser->put(c.in.data(), ec));
+          if (ec == http::error::need_more)
+          {
+            break;
+          }
+          if (ec)
+          {
+            closeSlot(slot);
+            return;
+          }
+        }
+        if (!c.parser->is_done())
+        {
+          queueRead(slot);
+          return;
+        }
+
+        c.req = c.parser->release();
+        c.parser.reset();
+        if (c.traced != nullptr)
+        {
+          c.traced->mark(TraceStage::Read);
+        }
+        handle_request(m_store, c.req, c.res, c.traced, &c.ticket);
+        if (m_drainStarted)
+        {
+          c.res.keep_alive(false);
+        }
+        serialize(c.res, c.out);
+        c.sent = 0;
+        queueWrite(slot);
+      }
+
+      void onWrite(std::uint32_t slot, int res)
+      {
+        Connection& c = m_connections[slot];
+        c.lastActive = Clock::now();
+        if (res <= 0)
+        {
+          closeSlot(slot);
+          return;
+        }
+        c.sent += static_cast<std::size_t>(res);
+        if (c.sent < c.out.size())
+        {
+          queueWrite(slot);
+          return;
+        }
+
+        c.ticket.reset();
+        if (c.traced != nullptr)
+        {
+          c.traced->mark(TraceStage::Write);
+          tracer().finish(*c.traced);
+        }
+        if (!c.res.keep_alive() || m_drainStarted)
+        {
+          closeSlot(slot);
+          return;
+        }
+        // Pipelined requests may already be buffered.
+        if (c.in.size() > 0)
+        {
+          advance(slot);
+        }
+        else
+        {
+          queueRead(slot);
+        }
+      }
+
+      // Shutting a socket down completes its queued read or write with an error, which closes the slot.
+      void onTick()
+      {
+        const auto now = Clock::now();
+        const bool pastDeadline = m_drainStarted && now >= m_drainDeadline;
+        for (const Connection& c : m_connections)
+        {
+          if (c.fd >= 0 && (pastDeadline || now - c.lastActive > m_config.keepAliveTimeout))
+          {
+            shutdown(c.fd, SHUT_RDWR);
+          }
+        }
+        armTick();
+      }
+
+      void onWake()
+      {
+        if (!m_draining.load(std::memory_order_acquire))
+        {
+          armWake();
+          return;
+        }
+        beginDrain();
+      }
+
+      void beginDrain()
+      {
+        if (m_drainStarted)
+        {
+          return;
+        }
+        m_drainStarted = true;
+        m_drainDeadline = Clock::now() + m_config.drainTimeout;
+
+        if (m_acceptQueued)
+        {
+          io_uring_sqe& sqe = m_ring.sqe();
+          sqe.opcode = IORING_OP_ASYNC_CANCEL;
+          sqe.addr = userData(Op::Accept);
+          sqe.user_data = userData(Op::Cancel);
+        }
+        for (const Connection& c : m_connections)
+        {
+          if (c.fd >= 0 && c.reading && !c.parser.has_value())
+          {
+            shutdown(c.fd, SHUT_RDWR);
+          }
+        }
+      }
+
+    private:
+      GameStore& m_store;
+      const ServerConfig& m_config;
+      BufferPool& m_pool;
+      AdmissionControl& m_admission;
+      const std::atomic<bool>& m_draining;
+      const int m_listenFd;
+
+      std::vector<Connection> m_connections;
+      std::vector<std::uint32_t> m_freeSlots;
+      std::size_t m_open{ 0 };
+      std::unique_ptr<char[]> m_arena;
+      bool m_registered{ false };
+      bool m_acceptQueued{ false };
+      bool m_drainStarted{ false };
+      Clock::time_point m_drainDeadline{};
+
+      // Targets of the tick and wake operations; declared before the ring so they outlive it.
+      int m_wakeFd;
+      std::uint64_t m_wakeValue{ 0 };
+      __kernel_timespec m_tick{ 1, 0 };
+      Ring m_ring;
+    };
+
+    int listenOn(const ServerConfig& config)
+    {
+      const asio::ip::tcp::endpoint endpoint{ asio::ip::make_address(config.address), config.port };
+      const int fd = socket(endpoint.protocol().family(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (fd < 0)
+      {
+        throwErrno(errno, "socket");
+      }
+
+      const int on = 1;
+      if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+          (config.reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) ||
+          bind(fd, endpoint.data(), static_cast<socklen_t>(endpoint.size())) != 0 ||
+          listen(fd, config.backlog) != 0)
+      {
+        const int err = errno;
+        close(fd);
+        throwErrno(err, "listen");
+      }
+      return fd;
+    }
+  }  // namespace
+
+  // The listening socket shared by every worker's accept, the workers and their threads. SIGTERM and SIGINT are
+  // watched on a thread of their own, since the workers block in the kernel rather than in an event loop.
+  class UringRuntime
+  {
+  public:
+    UringRuntime(GameStore& store, const ServerConfig& serverConfig, BufferPool& pool)
+        : m_config(serverConfig),
+          m_admission(serverConfig.maxInFlight,
+                      serverConfig.maxInFlightPerToken,
+                      serverConfig.tokenRate,
+                      serverConfig.clientRate),
+          m_listenFd(listenOn(serverConfig))
+    {
+      const std::size_t slots = serverConfig.maxConnections == 0
+                                    ? DEFAULT_SLOTS
+                                    : (serverConfig.maxConnections + serverConfig.ioThreads - 1) / serverConfig.ioThreads;
+      try
+      {
+        for (unsigned i = 0; i < serverConfig.ioThreads; ++i)
+        {
+          m_workers.push_back(std::make_unique<Worker>(store, serverConfig, pool, m_admission, m_draining, m_listenFd, slots));
+        }
+      }
+      catch (...)
+      {
+        close(m_listenFd);
+        throw;
+      }
+    }
+
+    ~UringRuntime() { close(m_listenFd); }
+
+    UringRuntime(const UringRuntime&) = delete;
+    UringRuntime& operator=(const UringRuntime&) = delete;
+
+    void runThreads()
+    {
+      m_signals.async_wait([this](const boost::system::error_code& ec, int) {
+        if (!ec)
+        {
+          stop();
+        }
+      });
+      m_signalThread = std::thread{ [this] { m_signalIoc.run(); } };
+
+      for (unsigned i = 0; i < m_workers.size(); ++i)
+      {
+        m_threads.emplace_back([this, i] {
+          if (m_config.pinThreads)
+          {
+            pinThreadToCpu(i);
+          }
+          m_workers[i]->run();
+        });
+      }
+    }
+
+    void join()
+    {
+      for (auto& thread : m_threads)
+      {
+        thread.join();
+      }
+      m_threads.clear();
+      stop();
+      if (m_signalThread.joinable())
+      {
+        m_signalThread.join();
+      }
+    }
+
+    void stop()
+    {
+      m_draining.store(true, std::memory_order_release);
+      for (const auto& worker : m_workers)
+      {
+        worker->wake();
+      }
+      asio::post(m_signalIoc, [this] {
+        boost::system::error_code ec;
+        m_signals.cancel(ec);
+      });
+    }
+
+    bool running() const noexcept { return !m_threads.empty(); }
+
+    std::uint16_t port() const
+    {
+      asio::ip::tcp::endpoint bound;
+      socklen_t size = static_cast<socklen_t>(bound.capacity());
+      if (getsockname(m_listenFd, bound.data(), &size) != 0)
+      {
+        throwErrno(errno, "getsockname");
+      }
+      bound.resize(size);
+      return bound.port();
+    }
+
+  private:
+    const ServerConfig& m_config;
+    AdmissionControl m_admission;
+    std::atomic<bool> m_draining{ false };
+    const int m_listenFd;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    asio::io_context m_signalIoc{ 1 };
+    asio::signal_set m_signals{ m_signalIoc, SIGTERM, SIGINT };
+    std::thread m_signalThread;
+  };
+
+  bool UringServer::supported() noexcept
+  {
+    try
+    {
+      Ring probe{ 4 };
+      return true;
+    }
+    catch (const std::exception&)
+    {
+      return false;
+    }
+  }
+
+  void UringServer::start()
+  {
+    // WRITE_FIXED has no MSG_NOSIGNAL; a peer that reset the connection must not kill the process.
+    std::signal(SIGPIPE, SIG_IGN);
+    m_runtime = std::make_unique<UringRuntime>(m_store, m_config, m_buffers);
+    m_port.store(m_runtime->port(), std::memory_order_release);
+    m_runtime->runThreads();
+  }
+
+  void UringServer::wait()
+  {
+    if (m_runtime != nullptr)
+    {
+      m_runtime->join();
+    }
+  }
+
+  void UringServer::stop()
+  {
+    if (m_runtime != nullptr)
+    {
+      m_runtime->stop();
+    }
+  }
+
+  UringServer::~UringServer()
+  {
+    if (m_runtime != nullptr && m_runtime->running())
+    {
+      stop();
+      wait();
+    }
+  }
+
+#else
+
+  class UringRuntime
+  {
+  };
+
+  bool UringServer::supported() noexcept
+  {
+    return false;
+  }
+
+  void UringServer::start()
+  {
+    throw std::runtime_error("built without io_uring support (BattleShip_ENABLE_IO_URING)");
+  }
+
+  void UringServer::wait()
+  {
+  }
+
+  void UringServer::stop()
+  {
+  }
+
+  UringServer::~UringServer() = default;
+
+#endif
+
+  UringServer::UringServer(GameStore& store, ServerConfig config)
+      : m_store(store),
+        m_config(std::move(config))
+  {
+  }
+
+  void UringServer::run()
+  {
+    start();
+    std::cout << "Listening on http://" << m_config.address << ":" << port() << " with " << m_config.ioThreads
+              << " io_uring thread" << (m_config.ioThreads == 1 ? "" : "s") << "\n";
+    wait();
+  }
+
+}  // namespace server
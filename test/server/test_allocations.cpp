@@ -0,0 +1,142 @@
+#include <boost/beast/http.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "server/game_store.hpp"
+#include "server/http_router.hpp"
+
+// Counts every global heap allocation made by this test binary. Only the deltas around the code under test
+// are asserted on, so allocations from GTest itself do not matter.
+namespace
+{
+  std::atomic<std::size_t> g_allocations{ 0 };
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size))
+  {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace server::tests
+{
+  namespace http = boost::beast::http;
+
+  namespace
+  {
+    http::request<http::string_body> buildRequest(http::verb method,
+                                                   const std::string& target,
+                                                   const std::string& token,
+                                                   const std::string& body = "")
+    {
+      http::request<http::string_body> req{ method, target, 11 };
+      req.set(http::field::host, "localhost");
+      req.set(http::field::authorization, "Bearer " + token);
+      req.keep_alive(true);
+      req.body() = body;
+      req.prepare_payload();
+      return req;
+    }
+
+    template<typename Fn>
+    std::size_t allocationsDuring(Fn&& fn)
+    {
+      const std::size_t before = g_allocations.load(std::memory_order_relaxed);
+      fn();
+      return g_allocations.load(std::memory_order_relaxed) - before;
+    }
+  }  // namespace
+
+  class AllocationTest : public ::testing::Test
+  {
+   protected:
+    void SetUp() override
+    {
+      created = store.createGame();
+      joined = store.joinGame(created.gameId);
+      (void)store.placeRandomFleet(created.gameId, 0);
+      (void)store.placeRandomFleet(created.gameId, 1);
+      (void)store.readyUp(created.gameId, 0);
+      (void)store.readyUp(created.gameId, 1);
+    }
+
+    GameStore store;
+    CreateGameResult created;
+    JoinGameResult joined;
+  };
+
+  TEST_F(AllocationTest, SteadyStatePollOnReusedResponseDoesNotAllocate)
+  {
+    const auto req = buildRequest(http::verb::get, "/games/" + created.gameId, created.playerToken);
+    http::response<http::string_body> res;
+
+    // Warm up: the first responses size the body and create the header fields.
+    for (int i = 0; i < 3; ++i)
+    {
+      handle_request(store, req, res);
+      ASSERT_EQ(res.result(), http::status::ok);
+    }
+
+    constexpr int ROUNDS = 100;
+    const std::size_t allocations = allocationsDuring(
+        [&]()
+        {
+          for (int i = 0; i < ROUNDS; ++i)
+          {
+            handle_request(store, req, res);
+          }
+        });
+
+    EXPECT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(allocations, 0U) << "GET /games/{id} allocated " << allocations << " times over " << ROUNDS << " requests";
+  }
+
+  TEST_F(AllocationTest, ReusedResponseAllocatesLessThanFreshResponses)
+  {
+    const auto req = buildRequest(http::verb::post, "/games/" + created.gameId + "/ready", created.playerToken);
+
+    http::response<http::string_body> reused;
+    handle_request(store, req, reused);
+
+    constexpr int ROUNDS = 50;
+    const std::size_t withReuse = allocationsDuring(
+        [&]()
+        {
+          for (int i = 0; i < ROUNDS; ++i)
+          {
+            handle_request(store, req, reused);
+          }
+        });
+    const std::size_t withoutReuse = allocationsDuring(
+        [&]()
+        {
+          for (int i = 0; i < ROUNDS; ++i)
+          {
+            auto res = handle_request(store, req);
+            ASSERT_EQ(res.result(), http::status::ok);
+          }
+        });
+
+    EXPECT_EQ(reused.result(), http::status::ok);
+    EXPECT_LT(withReuse, withoutReuse);
+  }
+
+}  // namespace server::tests
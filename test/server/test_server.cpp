@@ -1,16 +1,52 @@
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <gtest/gtest.h>
 
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <optional>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "project/core/fleetGenerator.hpp"
+#include "project/exceptions/exceptions.hpp"
+#include "server/admission.hpp"
+#include "server/game_recorder.hpp"
 #include "server/game_store.hpp"
+#include "server/buffer_pool.hpp"
+#include "server/cluster.hpp"
+#include "server/cluster_proxy.hpp"
+#include "server/http_server.hpp"
+#include "server/event_log.hpp"
 #include "server/http_router.hpp"
+#include "server/json_writer.hpp"
+#include "server/matchmaker.hpp"
+#include "server/metrics.hpp"
+#include "server/mpmc_queue.hpp"
+#include "server/rate_limiter.hpp"
+#include "server/replay_db.hpp"
+#include "server/request_trace.hpp"
+#include "server/route_table.hpp"
+#include "server/server_config.hpp"
+#include "server/uring_server.hpp"
+#include "server/snapshot.hpp"
+#include "server/spectator_hub.hpp"
 
 namespace server::tests
 {
@@ -211,6 +247,215 @@ namespace server::tests
     EXPECT_EQ(view->turn, 0);
   }
 
+  TEST_F(GameStoreTest, PlaceFleetIsAllOrNothing)
+  {
+    const auto created = store.createGame();
+    (void)store.joinGame(created.gameId);
+
+    const std::vector<battleship::FleetPlacement> colliding{
+      { battleship::BoatType::CARRIER, { battleship::Coordinate{ 0, 0 }, battleship::Orientation::EAST } },
+      { battleship::BoatType::DESTROYER, { battleship::Coordinate{ 1, 0 }, battleship::Orientation::EAST } },
+    };
+    EXPECT_THROW(store.placeFleet(created.gameId, 0, colliding), battleship::Collision);
+
+    auto view = store.getGameView(created.gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->boards[0].cells[0][0], battleship::CellState::EMPTY);
+
+    const std::vector<battleship::FleetPlacement> valid{
+      { battleship::BoatType::CARRIER, { battleship::Coordinate{ 0, 0 }, battleship::Orientation::EAST } },
+      { battleship::BoatType::DESTROYER, { battleship::Coordinate{ 2, 0 }, battleship::Orientation::EAST } },
+    };
+    store.placeFleet(created.gameId, 0, valid);
+
+    view = store.getGameView(created.gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->boards[0].cells[0][4], battleship::CellState::OCCUPIED);
+    EXPECT_EQ(view->boards[0].cells[2][1], battleship::CellState::OCCUPIED);
+  }
+
+  TEST_F(GameStoreTest, TryShootReportsOrdinaryRejectionsAsErrors)
+  {
+    const auto created = store.createGame();
+    (void)store.joinGame(created.gameId);
+
+    auto out = store.tryShoot(created.gameId, 0, battleship::Coordinate{ 0, 0 });
+    ASSERT_FALSE(out.has_value());
+    EXPECT_EQ(out.error(), StoreError::NotInProgress);
+
+    store.placeShip(created.gameId, 1, battleship::BoatType::DESTROYER, { 9, 9 }, battleship::Orientation::WEST);
+    (void)store.readyUp(created.gameId, 0);
+    (void)store.readyUp(created.gameId, 1);
+
+    out = store.tryShoot(created.gameId, 1, battleship::Coordinate{ 0, 0 });
+    ASSERT_FALSE(out.has_value());
+    EXPECT_EQ(out.error(), StoreError::NotYourTurn);
+
+    out = store.tryShoot(created.gameId, 0, battleship::Coordinate{ 0, 0 });
+    ASSERT_TRUE(out.has_value());
+    EXPECT_EQ(out->nextTurnPlayerId, 2);
+
+    EXPECT_FALSE(store.tryShoot("missing-game-id", 0, battleship::Coordinate{ 0, 0 }).has_value());
+    EXPECT_EQ(store.tryPlaceShip(created.gameId, 0, battleship::BoatType::CARRIER, { 9, 8 }, battleship::Orientation::EAST),
+              StoreError::OutOfBounds);
+  }
+
+  TEST(GameStoreListingTest, PagesThroughEachStatusInTheOrderGamesEnteredIt)
+  {
+    GameStore store{ 4 };
+    std::vector<std::string> ids;
+    for (int i = 0; i < 7; ++i)
+    {
+      ids.push_back(store.createGame().gameId);
+    }
+    (void)store.joinGame(ids[4]);
+    (void)store.joinGame(ids[1]);
+
+    std::vector<std::string> waiting;
+    std::uint64_t cursor = 0;
+    std::size_t pages = 0;
+    do
+    {
+      const auto page = store.listGames(GameStatus::WaitingForPlayers, 2, cursor);
+      EXPECT_LE(page.gameIds.size(), 2U);
+      waiting.insert(waiting.end(), page.gameIds.begin(), page.gameIds.end());
+      cursor = page.nextCursor;
+      ++pages;
+    } while (cursor != 0);
+    EXPECT_EQ(pages, 3U);
+    EXPECT_EQ(waiting, (std::vector<std::string>{ ids[0], ids[2], ids[3], ids[5], ids[6] }));
+
+    EXPECT_EQ(store.listGames(GameStatus::Placing, 10).gameIds, (std::vector<std::string>{ ids[4], ids[1] }));
+    EXPECT_TRUE(store.listGames(GameStatus::InProgress, 10).gameIds.empty());
+    EXPECT_EQ(store.stats().gamesByStatus[static_cast<std::size_t>(GameStatus::Placing)], 2U);
+
+    // A game joined after the first page was read shows up in neither status twice.
+    const auto first = store.listGames(GameStatus::WaitingForPlayers, 2);
+    (void)store.joinGame(ids[3]);
+    const auto rest = store.listGames(GameStatus::WaitingForPlayers, 10, first.nextCursor);
+    EXPECT_EQ(rest.gameIds, (std::vector<std::string>{ ids[5], ids[6] }));
+    EXPECT_EQ(rest.nextCursor, 0U);
+  }
+
+  TEST(RouteTableTest, SplitPathDropsQueryAndEmptySegments)
+  {
+    const auto path = split_path("//games/abc//shoot?x=1/2");
+    ASSERT_EQ(path.count, 3U);
+    EXPECT_EQ(path.parts[0], "games");
+    EXPECT_EQ(path.parts[1], "abc");
+    EXPECT_EQ(path.parts[2], "shoot");
+    EXPECT_FALSE(path.overflow);
+
+    EXPECT_TRUE(split_path("/a/b/c/d/e/f/g/h/i").overflow);
+  }
+
+  TEST(RouteTableTest, MatchesEveryRouteAndCapturesGameId)
+  {
+    struct Case
+    {
+      http::verb method;
+      std::string_view target;
+      RouteId expected;
+    };
+    const Case cases[] = {
+      { http::verb::post, "/games", RouteId::CreateGame },
+      { http::verb::get, "/games?status=placing", RouteId::ListGames },
+      { http::verb::post, "/games/g1/join", RouteId::JoinGame },
+      { http::verb::get, "/games/g1?poll=1", RouteId::GetGame },
+      { http::verb::post, "/games/g1/place", RouteId::PlaceShip },
+      { http::verb::post, "/games/g1/fleet", RouteId::PlaceFleet },
+      { http::verb::post, "/games/g1/fleet/random", RouteId::PlaceRandomFleet },
+      { http::verb::post, "/games/g1/ready", RouteId::ReadyUp },
+      { http::verb::post, "/games/g1/shoot", RouteId::Shoot },
+      { http::verb::get, "/games/g1/history?move=3", RouteId::GetHistory },
+      { http::verb::get, "/games/g1/spectate", RouteId::Spectate },
+      { http::verb::post, "/matchmaking", RouteId::Matchmake },
+      { http::verb::get, "/matchmaking/g1", RouteId::GetMatch },
+      { http::verb::get, "/metrics", RouteId::Metrics },
+      { http::verb::get, "/debug/traces", RouteId::DebugTraces },
+    };
+
+    for (const auto& c : cases)
+    {
+      const auto match = match_route(c.method, c.target);
+      EXPECT_EQ(match.id, c.expected) << c.target;
+      if (c.target.starts_with("/games/") || c.target.starts_with("/matchmaking/"))
+      {
+        EXPECT_EQ(match.gameId, "g1") << c.target;
+      }
+    }
+  }
+
+  TEST(RouteTableTest, RejectsWrongMethodAndUnknownPaths)
+  {
+    EXPECT_EQ(match_route(http::verb::get, "/games/g1/shoot").id, RouteId::NotFound);
+    EXPECT_EQ(match_route(http::verb::delete_, "/games/g1").id, RouteId::NotFound);
+    EXPECT_EQ(match_route(http::verb::post, "/games/g1/unknown").id, RouteId::NotFound);
+    EXPECT_EQ(match_route(http::verb::post, "/lobby/g1/join").id, RouteId::NotFound);
+    EXPECT_EQ(match_route(http::verb::get, "/").id, RouteId::NotFound);
+    EXPECT_TRUE(match_route(http::verb::post, "/games").gameId.empty());
+    EXPECT_FALSE(match_route(http::verb::post, "/games").requiresAuth);
+    EXPECT_TRUE(match_route(http::verb::post, "/games/g1/shoot").requiresAuth);
+  }
+
+  TEST(JsonWriterTest, MatchesPropertyTreeOutputByteForByte)
+  {
+    pt::ptree tree;
+    tree.put("gameId", "ab12");
+    tree.put("turnPlayerId", 2);
+    tree.put("you.playerId", 1);
+    tree.put("you.ready", false);
+    tree.put("odd", "a/b\"c\\d\n\x01");
+    pt::ptree cells;
+    for (const char* value : { "empty", "hit" })
+    {
+      pt::ptree cell;
+      cell.put("", value);
+      cells.push_back({ "", cell });
+    }
+    tree.add_child("cells", cells);
+    std::ostringstream expected;
+    pt::write_json(expected, tree, false);
+
+    std::string out;
+    JsonWriter json{ out };
+    json.beginObject();
+    json.field("gameId", "ab12");
+    json.field("turnPlayerId", 2);
+    json.beginObject("you");
+    json.field("playerId", 1);
+    json.field("ready", false);
+    json.endObject();
+    json.field("odd", "a/b\"c\\d\n\x01");
+    json.beginArray("cells");
+    json.element("empty");
+    json.element("hit");
+    json.endArray();
+    json.endObject();
+    json.finish();
+
+    EXPECT_EQ(out, expected.str());
+  }
+
+  TEST(BufferPoolTest, RecyclesBuffersAndDropsOversizedOnes)
+  {
+    BufferPool pool{ 1, 2 * BufferPool::INITIAL_CAPACITY };
+
+    std::string first = pool.acquire();
+    first.assign(100, 'x');
+    const auto* storage = first.data();
+    pool.release(std::move(first));
+    EXPECT_EQ(pool.size(), 1U);
+
+    const std::string again = pool.acquire();
+    EXPECT_TRUE(again.empty());
+    EXPECT_EQ(again.data(), storage);
+
+    std::string big(4 * BufferPool::INITIAL_CAPACITY, 'y');
+    pool.release(std::move(big));
+    EXPECT_EQ(pool.size(), 0U);
+  }
+
   class HttpRouterTest : public ::testing::Test
   {
    protected:
@@ -237,6 +482,37 @@ namespace server::tests
     EXPECT_FALSE(json.get<std::string>("playerToken").empty());
   }
 
+  TEST_F(HttpRouterTest, ListGamesReturnsTheLobbyPageByPage)
+  {
+    std::vector<std::string> ids;
+    for (int i = 0; i < 3; ++i)
+    {
+      ids.push_back(parseJson(send(http::verb::post, "/games").body()).get<std::string>("gameId"));
+    }
+    ASSERT_EQ(send(http::verb::post, "/games/" + ids[0] + "/join").result(), http::status::ok);
+
+    const auto first = send(http::verb::get, "/games?limit=1");
+    ASSERT_EQ(first.result(), http::status::ok);
+    const auto page = parseJson(first.body());
+    EXPECT_EQ(page.get<std::string>("status"), "waiting_for_players");
+    EXPECT_EQ(page.get_child("gameIds").front().second.data(), ids[1]);
+
+    const auto second = send(http::verb::get, "/games?status=waiting_for_players&limit=5&cursor=" + page.get<std::string>("nextCursor"));
+    ASSERT_EQ(second.result(), http::status::ok);
+    const auto last = parseJson(second.body());
+    ASSERT_EQ(last.get_child("gameIds").size(), 1U);
+    EXPECT_EQ(last.get_child("gameIds").front().second.data(), ids[2]);
+    EXPECT_FALSE(last.get_optional<std::string>("nextCursor").has_value());
+
+    const auto placing = parseJson(send(http::verb::get, "/games?status=placing").body());
+    EXPECT_EQ(placing.get_child("gameIds").front().second.data(), ids[0]);
+
+    EXPECT_EQ(send(http::verb::get, "/games?status=lobby").result(), http::status::bad_request);
+    EXPECT_EQ(send(http::verb::get, "/games?limit=0").result(), http::status::bad_request);
+    EXPECT_EQ(send(http::verb::get, "/games?limit=1000").result(), http::status::bad_request);
+    EXPECT_EQ(send(http::verb::get, "/games?cursor=x").result(), http::status::bad_request);
+  }
+
   TEST_F(HttpRouterTest, JoinEndpointSucceedsThenConflictsOnSecondJoin)
   {
     const auto createRes = send(http::verb::post, "/games");
@@ -356,6 +632,85 @@ namespace server::tests
     EXPECT_EQ(res.body(), "Invalid row character");
   }
 
+  TEST_F(HttpRouterTest, FleetEndpointPlacesAllShips)
+  {
+    const auto created = store.createGame();
+    (void)store.joinGame(created.gameId);
+
+    const auto res = send(http::verb::post,
+                          "/games/" + created.gameId + "/fleet",
+                          R"({"ships":[)"
+                          R"({"type":"CARRIER","start":"A1","orientation":"E"},)"
+                          R"({"type":"BATTLESHIP","start":"C1","orientation":"E"},)"
+                          R"({"type":"CRUISER","start":"E1","orientation":"E"},)"
+                          R"({"type":"SUBMARINE","start":"G1","orientation":"E"},)"
+                          R"({"type":"DESTROYER","start":"I1","orientation":"E"}]})",
+                          bearer(created.playerToken));
+    ASSERT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(parseJson(res.body()).get<int>("placed"), 5);
+
+    const auto view = store.getGameView(created.gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->boards[0].cells[8][1], battleship::CellState::OCCUPIED);
+  }
+
+  TEST_F(HttpRouterTest, FleetEndpointCollisionPlacesNothing)
+  {
+    const auto created = store.createGame();
+    (void)store.joinGame(created.gameId);
+
+    const auto res = send(http::verb::post,
+                          "/games/" + created.gameId + "/fleet",
+                          R"({"ships":[)"
+                          R"({"type":"CARRIER","start":"A1","orientation":"E"},)"
+                          R"({"type":"DESTROYER","start":"B2","orientation":"E"}]})",
+                          bearer(created.playerToken));
+    EXPECT_EQ(res.result(), http::status::bad_request);
+    EXPECT_EQ(res.body(), "Structure placement collides with existing structures.");
+
+    const auto view = store.getGameView(created.gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->boards[0].cells[0][0], battleship::CellState::EMPTY);
+  }
+
+  TEST_F(HttpRouterTest, FleetEndpointWithoutShipsReturnsBadRequest)
+  {
+    const auto created = store.createGame();
+    (void)store.joinGame(created.gameId);
+
+    const auto res = send(http::verb::post, "/games/" + created.gameId + "/fleet", "{}", bearer(created.playerToken));
+    EXPECT_EQ(res.result(), http::status::bad_request);
+    EXPECT_EQ(res.body(), "Missing field: ships");
+  }
+
+  TEST_F(HttpRouterTest, RandomFleetEndpointPlacesStandardFleetOnce)
+  {
+    const auto created = store.createGame();
+    (void)store.joinGame(created.gameId);
+
+    const auto res = send(http::verb::post, "/games/" + created.gameId + "/fleet/random", "", bearer(created.playerToken));
+    ASSERT_EQ(res.result(), http::status::ok);
+
+    const auto json = parseJson(res.body());
+    ASSERT_EQ(json.get_child("ships").size(), 5U);
+
+    const auto view = store.getGameView(created.gameId);
+    ASSERT_TRUE(view.has_value());
+    int occupied = 0;
+    for (const auto& row : view->boards[0].cells)
+    {
+      for (const auto cell : row)
+      {
+        occupied += cell == battleship::CellState::OCCUPIED ? 1 : 0;
+      }
+    }
+    EXPECT_EQ(occupied, 17);
+
+    const auto again = send(http::verb::post, "/games/" + created.gameId + "/fleet/random", "", bearer(created.playerToken));
+    EXPECT_EQ(again.result(), http::status::conflict);
+    EXPECT_EQ(again.body(), "Fleet already placed.");
+  }
+
   TEST_F(HttpRouterTest, ReadyEndpointReportsExpectedTransitions)
   {
     const auto createRes = send(http::verb::post, "/games");
@@ -553,4 +908,1557 @@ namespace server::tests
     EXPECT_EQ(cells[99], "empty");
   }
 
+  TEST_F(HttpRouterTest, HistoryEndpointStepsThroughMoves)
+  {
+    const auto created = parseJson(send(http::verb::post, "/games").body());
+    const std::string gameId = created.get<std::string>("gameId");
+    const std::string p1Token = created.get<std::string>("playerToken");
+    const auto joinRes = send(http::verb::post, "/games/" + gameId + "/join");
+    ASSERT_EQ(joinRes.result(), http::status::ok);
+    const std::string p2Token = parseJson(joinRes.body()).get<std::string>("playerToken");
+
+    for (const auto& token : { p1Token, p2Token })
+    {
+      ASSERT_EQ(send(http::verb::post,
+                     "/games/" + gameId + "/place",
+                     R"({"type":"DESTROYER","start":"A1","orientation":"E"})",
+                     bearer(token))
+                    .result(),
+                http::status::ok);
+      ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/ready", "", bearer(token)).result(), http::status::ok);
+    }
+    ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/shoot", R"({"target":"A1"})", bearer(p1Token)).result(),
+              http::status::ok);
+    ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/shoot", R"({"target":"E5"})", bearer(p2Token)).result(),
+              http::status::ok);
+
+    const auto latest = parseJson(send(http::verb::get, "/games/" + gameId + "/history", "", bearer(p1Token)).body());
+    EXPECT_EQ(latest.get<std::string>("status"), "in_progress");
+    EXPECT_EQ(latest.get<int>("moveCount"), 2);
+    std::vector<std::string> results;
+    for (const auto& move : latest.get_child("moves"))
+    {
+      results.push_back(move.second.get<std::string>("target") + ":" + move.second.get<std::string>("result"));
+    }
+    EXPECT_EQ(results, (std::vector<std::string>{ "A1:hit", "E5:miss" }));
+    EXPECT_EQ(latest.get<int>("position.move"), 2);
+    EXPECT_EQ(latest.get<int>("position.turnPlayerId"), 1);
+
+    const auto first = parseJson(send(http::verb::get, "/games/" + gameId + "/history?move=1", "", bearer(p2Token)).body());
+    EXPECT_EQ(first.get<int>("position.move"), 1);
+    EXPECT_EQ(first.get<int>("position.turnPlayerId"), 2);
+    std::vector<std::string> yours;
+    for (const auto& node : first.get_child("position.yourBoard.cells"))
+    {
+      yours.push_back(node.second.get_value<std::string>());
+    }
+    ASSERT_EQ(yours.size(), 100U);
+    EXPECT_EQ(yours[0], "hit");
+    EXPECT_EQ(yours[1], "occupied");
+    EXPECT_EQ(yours[44], "empty");
+
+    EXPECT_EQ(send(http::verb::get, "/games/" + gameId + "/history?move=3", "", bearer(p1Token)).result(),
+              http::status::bad_request);
+    EXPECT_EQ(send(http::verb::get, "/games/" + gameId + "/history?move=x", "", bearer(p1Token)).result(),
+              http::status::bad_request);
+  }
+
+  TEST(MetricsTest, LatencyBucketsAreLogLinear)
+  {
+    EXPECT_EQ(LatencyBuckets::bucketFor(0), 0U);
+    EXPECT_EQ(LatencyBuckets::bucketFor(1), 1U);
+    for (std::size_t b = 0; b + 1 < LatencyBuckets::COUNT; ++b)
+    {
+      const auto bound = LatencyBuckets::upperBoundMicros(b);
+      EXPECT_EQ(LatencyBuckets::bucketFor(bound - 1), b) << bound;
+      EXPECT_EQ(LatencyBuckets::bucketFor(bound), b + 1) << bound;
+    }
+    EXPECT_EQ(LatencyBuckets::upperBoundMicros(6), 12U);
+    EXPECT_EQ(LatencyBuckets::bucketFor(std::uint64_t{ 1 } << 40), LatencyBuckets::COUNT - 1);
+  }
+
+  TEST_F(HttpRouterTest, MetricsEndpointReportsRoutesStatusesAndGames)
+  {
+    const auto createdBefore = metrics().requestCount(RouteId::CreateGame);
+    const auto notFoundBefore = metrics().statusCount(404);
+
+    const std::string gameId = parseJson(send(http::verb::post, "/games").body()).get<std::string>("gameId");
+    ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/join").result(), http::status::ok);
+    ASSERT_EQ(send(http::verb::post, "/games").result(), http::status::ok);
+    ASSERT_EQ(send(http::verb::get, "/nowhere").result(), http::status::not_found);
+
+    EXPECT_EQ(metrics().requestCount(RouteId::CreateGame), createdBefore + 2);
+    EXPECT_EQ(metrics().statusCount(404), notFoundBefore + 1);
+
+    const auto res = send(http::verb::get, "/metrics");
+    ASSERT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(res[http::field::content_type], "text/plain; version=0.0.4");
+    const std::string& body = res.body();
+    EXPECT_NE(body.find("# TYPE battleship_http_request_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(body.find("battleship_http_request_duration_seconds_bucket{route=\"create_game\",le=\"+Inf\"} "),
+              std::string::npos);
+    EXPECT_NE(body.find("battleship_games{status=\"waiting_for_players\"} 1\n"), std::string::npos);
+    EXPECT_NE(body.find("battleship_games{status=\"placing\"} 1\n"), std::string::npos);
+    EXPECT_NE(body.find("battleship_store_lock_acquisitions_total "), std::string::npos);
+
+    const StoreStats stats = store.stats();
+    EXPECT_EQ(stats.gamesByStatus[static_cast<std::size_t>(GameStatus::Placing)], 1U);
+    EXPECT_GT(stats.lockAcquisitions, 0U);
+  }
+
+  TEST_F(GameStoreTest, LockProfileAttributesAcquisitionsToOperations)
+  {
+    const auto created = store.createGame();
+    (void)store.getGameView(created.gameId);
+    (void)store.getGameView(created.gameId);
+
+    const StoreStats stats = store.stats();
+    EXPECT_GE(stats.lockAcquisitions, 3U);
+
+    const LockProfile profile = store.lockProfile();
+    const auto& views = profile.ops[static_cast<std::size_t>(StoreOp::GetGameView)];
+    if constexpr (LOCK_PROFILING_ENABLED)
+    {
+      EXPECT_EQ(views.acquisitions, 2U);
+      EXPECT_EQ(profile.ops[static_cast<std::size_t>(StoreOp::CreateGame)].acquisitions, 1U);
+      EXPECT_GE(views.maxHoldNs * 2, views.holdNs);
+
+      std::ostringstream dump;
+      writeLockProfile(dump, profile);
+      EXPECT_NE(dump.str().find("\nget_game_view 2 "), std::string::npos);
+    }
+    else
+    {
+      EXPECT_EQ(views.acquisitions, 0U);
+    }
+  }
+
+  TEST(RequestTraceTest, MarksChargeElapsedTimeToTheStageThatEnded)
+  {
+    RequestTrace trace;
+    trace.begin();
+    trace.stageNs[static_cast<std::size_t>(TraceStage::Write)] = 99;  // cleared by begin() on reuse
+    trace.begin();
+    trace.mark(TraceStage::Read);
+    trace.mark(TraceStage::Store);
+    trace.mark(TraceStage::Store);
+
+    std::uint64_t total = 0;
+    for (const auto ns : trace.stageNs)
+    {
+      total += ns;
+    }
+    EXPECT_EQ(total, trace.totalNs());
+    EXPECT_EQ(trace.stageNs[static_cast<std::size_t>(TraceStage::Write)], 0U);
+  }
+
+  TEST_F(HttpRouterTest, TracedRequestIsKeptWhenSlowAndExportedAsChromeTrace)
+  {
+    const auto created = parseJson(send(http::verb::post, "/games").body());
+    const std::string gameId = created.get<std::string>("gameId");
+    const std::string p1Token = created.get<std::string>("playerToken");
+    ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/join").result(), http::status::ok);
+
+    tracer().setSlowThreshold(std::chrono::nanoseconds{ 0 });
+    RequestTrace trace;
+    trace.begin();
+    http::response<http::string_body> res;
+    handle_request(store,
+                   buildRequest(http::verb::post,
+                                "/games/" + gameId + "/place",
+                                R"({"type":"DESTROYER","start":"A1","orientation":"E"})",
+                                bearer(p1Token)),
+                   res,
+                   &trace);
+    trace.mark(TraceStage::Write);
+    tracer().finish(trace);
+    tracer().setSlowThreshold(RequestTracer::DEFAULT_SLOW_THRESHOLD);
+
+    ASSERT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(trace.route, RouteId::PlaceShip);
+    EXPECT_EQ(trace.status, 200U);
+    EXPECT_GT(trace.stageNs[static_cast<std::size_t>(TraceStage::Parse)], 0U);
+    EXPECT_GT(trace.stageNs[static_cast<std::size_t>(TraceStage::Store)], 0U);
+
+    const auto recent = tracer().recent();
+    ASSERT_FALSE(recent.empty());
+    EXPECT_EQ(recent.back().route, RouteId::PlaceShip);
+
+    const auto exported = send(http::verb::get, "/debug/traces");
+    ASSERT_EQ(exported.result(), http::status::ok);
+    const auto json = parseJson(exported.body());
+    std::vector<std::string> names;
+    for (const auto& event : json.get_child("traceEvents"))
+    {
+      if (event.second.get<std::uint64_t>("tid") == recent.back().id)
+      {
+        names.push_back(event.second.get<std::string>("name"));
+        EXPECT_EQ(event.second.get<std::string>("ph"), "X");
+      }
+    }
+    ASSERT_FALSE(names.empty());
+    EXPECT_EQ(names.front(), "place_ship");
+    EXPECT_NE(std::find(names.begin(), names.end(), "parse"), names.end());
+  }
+
+  // Lowers the process's file size limit so writes past `bytes` fail (EFBIG) or come up short, as a full disk
+  // would make them.
+  class FileSizeLimit
+  {
+  public:
+    explicit FileSizeLimit(std::uintmax_t bytes)
+    {
+      ::getrlimit(RLIMIT_FSIZE, &m_saved);
+      m_handler = std::signal(SIGXFSZ, SIG_IGN);
+      ::rlimit limit = m_saved;
+      limit.rlim_cur = static_cast<::rlim_t>(bytes);
+      ::setrlimit(RLIMIT_FSIZE, &limit);
+    }
+
+    ~FileSizeLimit()
+    {
+      ::setrlimit(RLIMIT_FSIZE, &m_saved);
+      std::signal(SIGXFSZ, m_handler);
+    }
+
+    FileSizeLimit(const FileSizeLimit&) = delete;
+    FileSizeLimit& operator=(const FileSizeLimit&) = delete;
+
+  private:
+    ::rlimit m_saved{};
+    void (*m_handler)(int){ SIG_DFL };
+  };
+
+  class PersistenceTest : public ::testing::Test
+  {
+   protected:
+    void SetUp() override
+    {
+      const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+      path = (std::filesystem::temp_directory_path() / (std::string("battleship_") + info->name() + ".wal")).string();
+      snapshotPath = path + ".snap";
+      TearDown();
+    }
+
+    void TearDown() override
+    {
+      std::filesystem::remove(path);
+      std::filesystem::remove(path + ".prev");
+      std::filesystem::remove(snapshotPath);
+    }
+
+    std::shared_ptr<EventLog> openLog() { return std::make_shared<EventLog>(EventLogOptions{ .path=path }); }
+
+    std::string path;
+    std::string snapshotPath;
+  };
+
+  TEST_F(PersistenceTest, AppendedEventsReadBackInOrder)
+  {
+    {
+      EventLog log{ EventLogOptions{ .path=path } };
+      GameEvent create{ .type=GameEventType::CreateGame, .gameId="g1" };
+      create.tokens = { "t0", "t1" };
+      EXPECT_EQ(log.append(create), 1U);
+
+      GameEvent shot{ .type=GameEventType::Shoot, .gameId="g1", .player=1 };
+      shot.coordinate = battleship::Coordinate{ 9, 3 };
+      EXPECT_EQ(log.append(shot), 2U);
+      log.flush();
+    }
+
+    const auto events = EventLog::readAll(path);
+    ASSERT_EQ(events.size(), 2U);
+    EXPECT_EQ(events[0].type, GameEventType::CreateGame);
+    EXPECT_EQ(events[0].tokens[1], "t1");
+    EXPECT_EQ(events[1].seq, 2U);
+    EXPECT_EQ(events[1].player, 1);
+    EXPECT_EQ(events[1].coordinate.row, 9);
+    EXPECT_EQ(events[1].coordinate.col, 3);
+  }
+
+  TEST_F(PersistenceTest, TornTailIsDroppedAndSequenceContinues)
+  {
+    {
+      EventLog log{ EventLogOptions{ .path=path } };
+      log.append(GameEvent{ .type=GameEventType::JoinGame, .gameId="g1" });
+    }
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::app);
+      const char torn[] = "\x20\x00\x00\x00garbage";
+      out.write(torn, sizeof(torn) - 1);
+    }
+    {
+      EventLog log{ EventLogOptions{ .path=path } };
+      ASSERT_EQ(log.recovered().size(), 1U);
+      EXPECT_EQ(log.append(GameEvent{ .type=GameEventType::ReadyUp, .gameId="g1" }), 2U);
+    }
+
+    const auto events = EventLog::readAll(path);
+    ASSERT_EQ(events.size(), 2U);
+    EXPECT_EQ(events[1].type, GameEventType::ReadyUp);
+  }
+
+  TEST_F(PersistenceTest, FailedCommitIsCutOffAndRetried)
+  {
+    // Commits only on flush(), so each one below is a single attempt.
+    auto log = std::make_shared<EventLog>(EventLogOptions{ .path=path, .commitInterval=std::chrono::hours{ 1 } });
+    GameStore store;
+    store.attachEventLog(log);
+    const auto first = store.createGame();
+    log->flush();
+    const auto committed = std::filesystem::file_size(path);
+
+    {
+      const FileSizeLimit limit{ committed + 10 };
+      (void)store.joinGame(first.gameId);
+      EXPECT_THROW(log->flush(), std::system_error);
+      EXPECT_EQ(log->error(), std::errc::file_too_large);
+      EXPECT_EQ(std::filesystem::file_size(path), committed);  // the torn part of the batch is gone
+
+      EXPECT_EQ(store.tryCreateGame().error(), StoreError::LogUnavailable);
+      EXPECT_EQ(store.tryReadyUp(first.gameId, 0).error(), StoreError::LogUnavailable);
+      EXPECT_THROW(log->flush(), std::system_error);
+    }
+
+    log->flush();
+    EXPECT_FALSE(log->error());
+    (void)store.createGame();
+    log->flush();
+
+    const auto events = EventLog::readAll(path);
+    ASSERT_EQ(events.size(), 3U);
+    EXPECT_EQ(events[1].type, GameEventType::JoinGame);
+    EXPECT_EQ(events[1].seq, 2U);
+    EXPECT_EQ(events[2].type, GameEventType::CreateGame);
+    EXPECT_EQ(events[2].seq, 3U);
+  }
+
+  TEST_F(PersistenceTest, GameStoreRecoversGamesFromLog)
+  {
+    std::string gameId;
+    std::string p2Token;
+    {
+      GameStore live;
+      EXPECT_EQ(live.attachEventLog(openLog()), 0U);
+
+      const auto created = live.createGame();
+      gameId = created.gameId;
+      p2Token = live.joinGame(gameId).playerToken;
+      live.placeShip(gameId, 0, battleship::BoatType::DESTROYER, battleship::Coordinate{ 0, 0 }, battleship::Orientation::EAST);
+      (void)live.placeRandomFleet(gameId, 1);
+      EXPECT_EQ(live.tryPlaceShip(gameId, 0, battleship::BoatType::CRUISER, battleship::Coordinate{ 0, 0 },
+                                  battleship::Orientation::SOUTH),
+                StoreError::Collision);
+      (void)live.readyUp(gameId, 0);
+      (void)live.readyUp(gameId, 1);
+      (void)live.shoot(gameId, 0, battleship::Coordinate{ 4, 4 });
+    }
+
+    GameStore recovered;
+    // create, join, 1 + 5 placements, 2 readies, 1 shot; the rejected placement was never logged.
+    EXPECT_EQ(recovered.attachEventLog(openLog()), 11U);
+
+    const auto view = recovered.getGameView(gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->status, GameStatus::InProgress);
+    EXPECT_EQ(view->turn, 1);
+    EXPECT_NE(view->boards[1].cells[4][4], battleship::CellState::EMPTY);
+    EXPECT_EQ(recovered.authorizedPlayer(gameId, "Bearer " + p2Token), 1);
+    EXPECT_EQ(view->boards[0].cells[0][1], battleship::CellState::OCCUPIED);
+  }
+
+  TEST_F(PersistenceTest, SnapshotPlusLogTailRestoresGames)
+  {
+    std::string gameId;
+    std::string lateGameId;
+    {
+      GameStore live;
+      auto log = openLog();
+      live.attachEventLog(log);
+      Snapshotter snapshotter{ live, log, SnapshotOptions{ .path=snapshotPath, .interval=std::chrono::hours{ 1 } } };
+
+      gameId = live.createGame().gameId;
+      (void)live.joinGame(gameId);
+      (void)live.placeRandomFleet(gameId, 0);
+      (void)live.placeRandomFleet(gameId, 1);
+      (void)live.readyUp(gameId, 0);
+      (void)live.readyUp(gameId, 1);
+      (void)live.shoot(gameId, 0, battleship::Coordinate{ 0, 0 });
+
+      EXPECT_EQ(snapshotter.snapshotNow(), 1U);
+
+      // Only these land in the log tail.
+      (void)live.shoot(gameId, 1, battleship::Coordinate{ 9, 9 });
+      lateGameId = live.createGame().gameId;
+    }
+
+    const auto snapshot = readSnapshot(snapshotPath, 2);
+    ASSERT_TRUE(snapshot.has_value());
+    ASSERT_EQ(snapshot->games.size(), 1U);
+    EXPECT_EQ(snapshot->baseSeq, 15U);
+
+    GameStore recovered;
+    ASSERT_TRUE(recovered.loadSnapshot(snapshotPath));
+    EXPECT_EQ(recovered.attachEventLog(openLog()), 2U);
+
+    const auto view = recovered.getGameView(gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->status, GameStatus::InProgress);
+    EXPECT_EQ(view->turn, 0);
+    EXPECT_NE(view->boards[1].cells[0][0], battleship::CellState::EMPTY);
+    EXPECT_NE(view->boards[1].cells[0][0], battleship::CellState::OCCUPIED);
+    EXPECT_NE(view->boards[0].cells[9][9], battleship::CellState::OCCUPIED);
+    EXPECT_NE(view->boards[0].cells[9][9], battleship::CellState::EMPTY);
+    EXPECT_TRUE(recovered.getGameView(lateGameId).has_value());
+  }
+
+  TEST_F(PersistenceTest, EventsAfterACrashAreNumberedPastTheSnapshot)
+  {
+    std::string gameId;
+    {
+      GameStore live;
+      auto log = openLog();
+      live.attachEventLog(log);
+      Snapshotter snapshotter{ live, log, SnapshotOptions{ .path=snapshotPath, .interval=std::chrono::hours{ 1 } } };
+      gameId = live.createGame().gameId;
+      (void)live.joinGame(gameId);
+      EXPECT_EQ(snapshotter.snapshotNow(), 1U);
+    }
+    // The process died before either event reached the log; only the snapshot has them.
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".prev");
+
+    {
+      GameStore restarted;
+      ASSERT_TRUE(restarted.loadSnapshot(snapshotPath));
+      EXPECT_EQ(restarted.attachEventLog(openLog()), 0U);
+      (void)restarted.placeRandomFleet(gameId, 0);
+    }
+
+    GameStore recovered;
+    ASSERT_TRUE(recovered.loadSnapshot(snapshotPath));
+    EXPECT_EQ(recovered.attachEventLog(openLog()), battleship::STANDARD_FLEET.size());
+    const auto view = recovered.getGameView(gameId);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->revision, 1U + battleship::STANDARD_FLEET.size());
+  }
+
+  TEST_F(PersistenceTest, DamagedSnapshotIsRejected)
+  {
+    GameStore store;
+    (void)store.createGame();
+    ASSERT_EQ(store.writeSnapshot(snapshotPath), 1U);
+
+    {
+      std::fstream f(snapshotPath, std::ios::binary | std::ios::in | std::ios::out);
+      f.seekp(2);
+      f.put('\x7f');
+    }
+
+    GameStore recovered;
+    EXPECT_FALSE(recovered.loadSnapshot(snapshotPath));
+    EXPECT_FALSE(recovered.loadSnapshot(snapshotPath + ".missing"));
+  }
+
+  TEST_F(PersistenceTest, SnapshotMovesBetweenShardCounts)
+  {
+    GameStore store{ 8 };
+    std::vector<std::string> ids;
+    for (int i = 0; i < 20; ++i)
+    {
+      ids.push_back(store.createGame().gameId);
+      if (i % 2 == 0)
+      {
+        (void)store.joinGame(ids.back());
+      }
+    }
+    ASSERT_EQ(store.writeSnapshot(snapshotPath), ids.size());
+
+    GameStore resharded{ 3 };
+    ASSERT_TRUE(resharded.loadSnapshot(snapshotPath));
+    EXPECT_EQ(resharded.stats().gamesByStatus, store.stats().gamesByStatus);
+    for (const auto& id : ids)
+    {
+      EXPECT_TRUE(resharded.getGameView(id).has_value());
+      EXPECT_EQ(resharded.authorizedPlayer(id, "Bearer nobody"), -1);
+    }
+  }
+
+  TEST(GameRecordTest, PackedPlacementRoundTrips)
+  {
+    const battleship::FleetPlacement ship{ battleship::BoatType::SUBMARINE,
+                                           battleship::Placement{ battleship::Coordinate{ 7, 2 },
+                                                                  battleship::Orientation::NORTH } };
+    const auto unpacked = GameRecord::unpackPlacement(GameRecord::packPlacement(ship));
+    EXPECT_EQ(unpacked.type, battleship::BoatType::SUBMARINE);
+    EXPECT_EQ(unpacked.placement.coordinate.row, 7);
+    EXPECT_EQ(unpacked.placement.coordinate.col, 2);
+    EXPECT_EQ(unpacked.placement.orientation, battleship::Orientation::NORTH);
+  }
+
+  TEST_F(PersistenceTest, RecorderWritesFinishedGames)
+  {
+    const std::string directory = path + ".records";
+    std::filesystem::remove_all(directory);
+    {
+      auto recorder = std::make_shared<GameRecorder>(RecorderOptions{ .directory=directory });
+      GameStore live;
+      live.attachRecorder(recorder);
+
+      const auto created = live.createGame();
+      const auto& id = created.gameId;
+      (void)live.joinGame(id);
+      live.placeShip(id, 0, battleship::BoatType::DESTROYER, battleship::Coordinate{ 0, 0 }, battleship::Orientation::EAST);
+      live.placeShip(id, 1, battleship::BoatType::DESTROYER, battleship::Coordinate{ 5, 5 }, battleship::Orientation::SOUTH);
+      (void)live.readyUp(id, 0);
+      (void)live.readyUp(id, 1);
+      (void)live.shoot(id, 0, battleship::Coordinate{ 5, 5 });
+      (void)live.shoot(id, 1, battleship::Coordinate{ 9, 9 });
+      EXPECT_EQ(live.shoot(id, 0, battleship::Coordinate{ 6, 5 }).status, GameStatus::Finished);
+      (void)live.createGame();  // still running, so not recorded
+
+      recorder->flush();
+      EXPECT_EQ(recorder->recordsWritten(), 1U);
+    }
+
+    const auto segments = GameRecorder::listSegments(directory);
+    ASSERT_EQ(segments.size(), 1U);
+    std::ifstream in(segments[0], std::ios::binary);
+    const std::string bytes{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+    std::size_t consumed = 0;
+    const auto record = decodeGameRecord(bytes.data(), bytes.size(), consumed);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(consumed, bytes.size());
+    EXPECT_EQ(record->winner, 1);
+    EXPECT_GE(record->finishedAtMs, record->startedAtMs);
+    ASSERT_EQ(record->fleets[1].size(), 1U);
+    EXPECT_EQ(GameRecord::unpackPlacement(record->fleets[1][0]).placement.coordinate.row, 5);
+    ASSERT_EQ(record->shots.size(), 3U);
+    EXPECT_EQ(record->shots[0], GameRecord::packCell(battleship::Coordinate{ 5, 5 }) | GameRecord::HIT_BIT);
+    EXPECT_EQ(record->shots[1], GameRecord::packCell(battleship::Coordinate{ 9, 9 }));
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST_F(PersistenceTest, RecorderCutsOffFailedBatches)
+  {
+    const std::string directory = path + ".records";
+    std::filesystem::remove_all(directory);
+    const auto makeRecord = [](const std::string& id) {
+      auto r = std::make_unique<GameRecord>();
+      r->gameId = id;
+      r->shots.assign(100, GameRecord::HIT_BIT);
+      return r;
+    };
+    {
+      GameRecorder recorder{ RecorderOptions{ .directory=directory } };
+      recorder.submit(makeRecord("g0"));
+      recorder.flush();
+      const auto segment = GameRecorder::listSegments(directory).at(0);
+      const auto written = std::filesystem::file_size(segment);
+      {
+        // The batch only partly fits under the limit.
+        const FileSizeLimit limit{ written + 10 };
+        recorder.submit(makeRecord("g1"));
+        recorder.flush();
+      }
+      EXPECT_EQ(recorder.recordsWritten(), 1U);
+      EXPECT_EQ(recorder.recordsFailed(), 1U);
+      EXPECT_EQ(std::filesystem::file_size(segment), written);
+
+      recorder.submit(makeRecord("g2"));
+      recorder.flush();
+      EXPECT_EQ(recorder.recordsWritten(), 2U);
+    }
+
+    const auto segments = GameRecorder::listSegments(directory);
+    ASSERT_EQ(segments.size(), 1U);
+    std::ifstream in(segments[0], std::ios::binary);
+    const std::string bytes{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    std::vector<std::string> ids;
+    for (std::size_t offset = 0, consumed = 0; offset < bytes.size(); offset += consumed)
+    {
+      const auto record = decodeGameRecord(bytes.data() + offset, bytes.size() - offset, consumed);
+      ASSERT_TRUE(record.has_value());
+      ids.push_back(record->gameId);
+    }
+    EXPECT_EQ(ids, (std::vector<std::string>{ "g0", "g2" }));
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST_F(PersistenceTest, ReplayDbIndexesAndScansSegments)
+  {
+    const std::string directory = path + ".records";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // Game i is won by player 1 + i % 2 in 10 * (i + 1) shots, all at A1 (hits) for even games.
+    const auto makeRecord = [](int i) {
+      GameRecord r;
+      r.gameId = "g" + std::to_string(i);
+      r.playerHash = { static_cast<std::uint64_t>(100 + i), 7 };
+      r.finishedAtMs = 1000 * i;
+      r.winner = static_cast<std::uint8_t>(1 + i % 2);
+      r.shots.assign(static_cast<std::size_t>(10 * (i + 1)),
+                     static_cast<std::uint8_t>(i % 2 == 0 ? GameRecord::HIT_BIT : 99));
+      return r;
+    };
+    for (int segment = 0; segment < 2; ++segment)
+    {
+      std::string bytes;
+      for (int i = 3 * segment; i < 3 * segment + 3; ++i)
+      {
+        encodeGameRecord(makeRecord(i), bytes);
+      }
+      if (segment == 1)
+      {
+        bytes += "torn";
+      }
+      std::ofstream(directory + "/segment-00000" + std::to_string(segment) + ".bsr", std::ios::binary) << bytes;
+    }
+
+    const ReplayDb db{ directory, 3 };
+    ASSERT_EQ(db.segmentCount(), 2U);
+    ASSERT_EQ(db.size(), 6U);
+    EXPECT_EQ(db.view(4).gameId, "g4");
+
+    EXPECT_EQ(db.select(ReplayQuery{ .winner=1 }), (std::vector<std::size_t>{ 0, 2, 4 }));
+    EXPECT_EQ(db.select(ReplayQuery{ .winner=1, .maxShots=49 }), (std::vector<std::size_t>{ 0, 2 }));
+    EXPECT_EQ(db.select(ReplayQuery{ .playerHash=105 }), (std::vector<std::size_t>{ 5 }));
+    EXPECT_EQ(db.select(ReplayQuery{ .playerHash=7, .finishedFromMs=2000, .finishedToMs=3000 }).size(), 2U);
+
+    const auto heatmap = db.shotHeatmap(ReplayQuery{ .winner=1, .maxShots=49 });
+    EXPECT_EQ(heatmap.games, 2U);
+    EXPECT_EQ(heatmap.shots[0], 10U + 30U);
+    EXPECT_EQ(heatmap.hits[0], heatmap.shots[0]);
+    EXPECT_EQ(heatmap.shots[99], 0U);
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST(ServerConfigTest, FlagsOverrideEnvironmentOverDefaults)
+  {
+    const auto env = [](const char* name) -> const char* {
+      const std::string_view var{ name };
+      if (var == "BATTLESHIP_PORT")
+      {
+        return "9000";
+      }
+      if (var == "BATTLESHIP_IO_THREADS")
+      {
+        return "3";
+      }
+      if (var == "BATTLESHIP_REUSE_PORT")
+      {
+        return "yes";
+      }
+      return nullptr;
+    };
+    const char* argv[] = { "server", "--port", "9100", "--pin-threads", "--keep-alive-timeout", "5", "--max-connections", "64" };
+
+    const auto config = parseServerConfig(static_cast<int>(std::size(argv)), argv, env);
+    ASSERT_TRUE(config.has_value()) << config.error();
+    EXPECT_EQ(config->port, 9100);
+    EXPECT_EQ(config->ioThreads, 3U);
+    EXPECT_TRUE(config->reusePort);
+    EXPECT_TRUE(config->pinThreads);
+    EXPECT_EQ(config->keepAliveTimeout, std::chrono::seconds{ 5 });
+    EXPECT_EQ(config->maxConnections, 64U);
+    EXPECT_EQ(config->backlog, ServerConfig::DEFAULT_BACKLOG);
+    EXPECT_EQ(config->address, "0.0.0.0");
+  }
+
+  TEST(ServerConfigTest, RejectsUnknownFlagsAndInvalidValues)
+  {
+    const auto noEnv = [](const char*) -> const char* { return nullptr; };
+    const auto parse = [&](std::vector<const char*> argv) {
+      argv.insert(argv.begin(), "server");
+      return parseServerConfig(static_cast<int>(argv.size()), argv.data(), noEnv);
+    };
+
+    EXPECT_EQ(parse({ "--verbose" }).error(), "Unknown option --verbose");
+    EXPECT_EQ(parse({ "--port" }).error(), "Missing value for --port");
+    EXPECT_EQ(parse({ "--port", "70000" }).error(), "Invalid value for --port: 70000");
+    EXPECT_EQ(parse({ "--io-threads", "0" }).error(), "Invalid value for --io-threads: 0");
+    EXPECT_EQ(parse({ "--backlog", "12x" }).error(), "Invalid value for --backlog: 12x");
+
+    const auto badEnv = [](const char* name) -> const char* {
+      return std::string_view{ name } == "BATTLESHIP_PIN_THREADS" ? "maybe" : nullptr;
+    };
+    const char* argv[] = { "server" };
+    EXPECT_EQ(parseServerConfig(1, argv, badEnv).error(), "Invalid value for BATTLESHIP_PIN_THREADS: maybe");
+  }
+
+  TEST(ServerConfigTest, ParsesPersistenceOptions)
+  {
+    const auto env = [](const char* name) -> const char* {
+      return std::string_view{ name } == "BATTLESHIP_WAL" ? "/var/lib/battleship/events.wal" : nullptr;
+    };
+    const char* argv[] = { "server", "--commit-interval", "20", "--snapshot", "games.snap", "--snapshot-interval", "300",
+                           "--record-dir", "archive" };
+
+    const auto config = parseServerConfig(static_cast<int>(std::size(argv)), argv, env);
+    ASSERT_TRUE(config.has_value()) << config.error();
+    EXPECT_EQ(config->walPath, "/var/lib/battleship/events.wal");
+    EXPECT_EQ(config->commitInterval, std::chrono::milliseconds{ 20 });
+    EXPECT_EQ(config->snapshotPath, "games.snap");
+    EXPECT_EQ(config->snapshotInterval, std::chrono::seconds{ 300 });
+    EXPECT_EQ(config->recordDir, "archive");
+
+    const auto noEnv = [](const char*) -> const char* { return nullptr; };
+    const char* zero[] = { "server", "--commit-interval", "0" };
+    EXPECT_EQ(parseServerConfig(static_cast<int>(std::size(zero)), zero, noEnv).error(),
+              "Invalid value for --commit-interval: 0");
+  }
+
+  TEST(AdmissionTest, ShedsPollsBeforeMovesAndLimitsEachToken)
+  {
+    AdmissionControl control{ 4, 1 };
+    EXPECT_EQ(control.limitFor(RequestPriority::Poll), 2U);
+    EXPECT_EQ(control.limitFor(RequestPriority::Setup), 3U);
+    EXPECT_EQ(control.limitFor(RequestPriority::Move), 4U);
+    EXPECT_EQ(priorityOf(RouteId::GetGame), RequestPriority::Poll);
+    EXPECT_EQ(priorityOf(RouteId::Shoot), RequestPriority::Move);
+
+    auto first = control.enter();
+    auto second = control.enter();
+    auto third = control.enter();
+    EXPECT_EQ(third.admit(RequestPriority::Poll, ""), Admission::Overloaded);
+    EXPECT_EQ(second.admit(RequestPriority::Move, "Bearer a"), Admission::Admitted);
+    EXPECT_EQ(first.admit(RequestPriority::Move, "Bearer a"), Admission::TooManyForToken);
+    EXPECT_EQ(first.admit(RequestPriority::Move, "Bearer b"), Admission::Admitted);
+
+    // Finished requests give back both their process-wide and their per-token place.
+    second.reset();
+    third.reset();
+    auto poll = control.enter();
+    EXPECT_EQ(control.inFlight(), 2U);
+    EXPECT_EQ(poll.admit(RequestPriority::Poll, "Bearer a"), Admission::Admitted);
+  }
+
+  TEST(AdmissionTest, RouterRejectsBeforeTouchingTheStore)
+  {
+    GameStore store;
+    AdmissionControl control{ 2 };
+    auto queued = control.enter();
+    auto ticket = control.enter();
+
+    http::response<http::string_body> res;
+    handle_request(store, buildRequest(http::verb::get, "/games/missing", "", bearer("t")), res, nullptr, &ticket);
+    EXPECT_EQ(res.result(), http::status::service_unavailable);
+    EXPECT_EQ(res[http::field::retry_after], "1");
+
+    // A move is still admitted at the same load and reaches the handlers, which reject the unknown game.
+    ticket.reset();
+    ticket = control.enter();
+    handle_request(store, buildRequest(http::verb::post, "/games/missing/shoot", "{}", bearer("t")), res, nullptr, &ticket);
+    EXPECT_EQ(res.result(), http::status::unauthorized);
+    EXPECT_EQ(res.find(http::field::retry_after), res.end());
+  }
+
+  TEST(RateLimiterTest, RefillsEachKeyAtItsRate)
+  {
+    RateLimiter limiter{ RateLimit{ .perSecond = 10, .burst = 2 } };
+    const auto t0 = RateLimiter::Clock::now();
+    const auto alice = RateLimiter::keyFor("Bearer alice");
+    const auto bob = RateLimiter::keyFor("Bearer bob");
+
+    EXPECT_TRUE(limiter.tryAcquire(alice, t0));
+    EXPECT_TRUE(limiter.tryAcquire(alice, t0));
+    EXPECT_FALSE(limiter.tryAcquire(alice, t0));
+    EXPECT_TRUE(limiter.tryAcquire(bob, t0));
+
+    // One token comes back every 100 ms, and an idle bucket never holds more than the burst.
+    EXPECT_TRUE(limiter.tryAcquire(alice, t0 + std::chrono::milliseconds{ 100 }));
+    EXPECT_FALSE(limiter.tryAcquire(alice, t0 + std::chrono::milliseconds{ 100 }));
+    const auto later = t0 + std::chrono::seconds{ 10 };
+    EXPECT_TRUE(limiter.tryAcquire(alice, later));
+    EXPECT_TRUE(limiter.tryAcquire(alice, later));
+    EXPECT_FALSE(limiter.tryAcquire(alice, later));
+
+    RateLimiter unlimited;
+    EXPECT_FALSE(unlimited.enabled());
+    EXPECT_TRUE(unlimited.tryAcquire(alice, t0));
+  }
+
+  TEST(RateLimiterTest, AdmissionRejectsClientsOverTheirRate)
+  {
+    AdmissionControl control{ 0, 0, RateLimit{ .perSecond = 1, .burst = 1 }, RateLimit{ .perSecond = 1, .burst = 2 } };
+    const auto client = RateLimiter::keyFor("10.0.0.1");
+
+    auto first = control.enter(client);
+    EXPECT_EQ(first.admit(RequestPriority::Poll, "Bearer a"), Admission::Admitted);
+    auto second = control.enter(client);
+    EXPECT_EQ(second.admit(RequestPriority::Poll, "Bearer a"), Admission::RateLimited);
+    auto third = control.enter(client);
+    EXPECT_EQ(third.admit(RequestPriority::Poll, ""), Admission::RateLimited);
+
+    GameStore store;
+    auto ticket = control.enter(RateLimiter::keyFor("10.0.0.2"));
+    http::response<http::string_body> res;
+    handle_request(store, buildRequest(http::verb::get, "/games/missing", "", bearer("a")), res, nullptr, &ticket);
+    EXPECT_EQ(res.result(), http::status::too_many_requests);
+  }
+
+  TEST(MpmcQueueTest, EveryPushedValueIsPoppedOnceAcrossThreads)
+  {
+    constexpr std::uint32_t PER_PRODUCER = 5000;
+    MpmcQueue<std::uint32_t> queue{ 64 };
+    std::atomic<std::uint64_t> sum{ 0 };
+    std::atomic<std::uint32_t> popped{ 0 };
+
+    std::vector<std::thread> threads;
+    for (std::uint32_t p = 0; p < 2; ++p)
+    {
+      threads.emplace_back([&queue, p] {
+        for (std::uint32_t i = 0; i < PER_PRODUCER; ++i)
+        {
+          while (!queue.tryPush(p * PER_PRODUCER + i))
+          {
+            std::this_thread::yield();
+          }
+        }
+      });
+      threads.emplace_back([&] {
+        std::uint32_t value = 0;
+        while (popped.load() < 2 * PER_PRODUCER)
+        {
+          if (queue.tryPop(value))
+          {
+            sum.fetch_add(value);
+            popped.fetch_add(1);
+          }
+          else
+          {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    constexpr std::uint64_t N = 2 * PER_PRODUCER;
+    EXPECT_EQ(sum.load(), N * (N - 1) / 2);
+    std::uint32_t value = 0;
+    EXPECT_FALSE(queue.tryPop(value));
+  }
+
+  TEST(MatchmakerTest, PairsPlayersOfTheSameBucketAndHandsEachSeatOut)
+  {
+    GameStore store;
+    Matchmaker matchmaker{ store, 8 };
+    const auto waitForMatch = [&](const std::string& ticket) {
+      for (int i = 0; i < 2000; ++i)
+      {
+        auto status = matchmaker.poll(ticket);
+        if (!status.has_value() || status->matched)
+        {
+          return status;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+      }
+      return std::optional<MatchStatus>{};
+    };
+
+    const auto first = matchmaker.enqueue(0);
+    const auto other = matchmaker.enqueue(1);
+    const auto second = matchmaker.enqueue(0);
+    ASSERT_TRUE(first && other && second);
+
+    const auto host = waitForMatch(*first);
+    const auto guest = waitForMatch(*second);
+    ASSERT_TRUE(host.has_value() && guest.has_value());
+    EXPECT_EQ(host->seat.gameId, guest->seat.gameId);
+    EXPECT_EQ(host->seat.playerId, 1);
+    EXPECT_EQ(guest->seat.playerId, 2);
+    EXPECT_EQ(store.authorizedPlayer(host->seat.gameId, bearer(guest->seat.playerToken)), 1);
+
+    // Collected seats are gone; the lone player of bucket 1 keeps waiting; forged tickets are unknown.
+    EXPECT_FALSE(matchmaker.poll(*first).has_value());
+    const auto waiting = matchmaker.poll(*other);
+    ASSERT_TRUE(waiting.has_value());
+    EXPECT_FALSE(waiting->matched);
+    EXPECT_FALSE(matchmaker.poll(other->substr(0, other->size() - 1) + "0").has_value());
+    EXPECT_FALSE(matchmaker.poll("m99.1").has_value());
+    EXPECT_FALSE(matchmaker.enqueue(Matchmaker::BUCKETS).has_value());
+
+    // Capacity counts every ticket that is queued or holds an uncollected seat.
+    std::vector<std::string> tickets;
+    while (auto ticket = matchmaker.enqueue(2))
+    {
+      tickets.push_back(*ticket);
+    }
+    EXPECT_EQ(tickets.size(), 7U);
+  }
+
+  TEST_F(HttpRouterTest, MatchmakingEndpointsPairTwoPlayers)
+  {
+    EXPECT_EQ(send(http::verb::post, "/matchmaking").result(), http::status::not_found);
+    store.attachMatchmaker(std::make_shared<Matchmaker>(store));
+
+    EXPECT_EQ(send(http::verb::post, "/matchmaking", R"({"bucket": 99})").result(), http::status::bad_request);
+    std::vector<std::string> tickets;
+    for (int i = 0; i < 2; ++i)
+    {
+      const auto res = send(http::verb::post, "/matchmaking", R"({"bucket": 3})");
+      ASSERT_EQ(res.result(), http::status::accepted);
+      EXPECT_EQ(parseJson(res.body()).get<std::string>("status"), "waiting");
+      tickets.push_back(parseJson(res.body()).get<std::string>("ticket"));
+    }
+
+    std::vector<pt::ptree> seats;
+    for (const auto& ticket : tickets)
+    {
+      for (int i = 0; i < 2000; ++i)
+      {
+        const auto res = send(http::verb::get, "/matchmaking/" + ticket);
+        if (res.result() != http::status::accepted)
+        {
+          ASSERT_EQ(res.result(), http::status::ok) << res.body();
+          seats.push_back(parseJson(res.body()));
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+      }
+    }
+    ASSERT_EQ(seats.size(), 2U);
+    const auto gameId = seats[0].get<std::string>("gameId");
+    EXPECT_EQ(seats[1].get<std::string>("gameId"), gameId);
+    EXPECT_EQ(seats[0].get<std::string>("gameStatus"), "placing");
+
+    const auto game = send(http::verb::get, "/games/" + gameId, "", bearer(seats[1].get<std::string>("playerToken")));
+    ASSERT_EQ(game.result(), http::status::ok);
+    EXPECT_EQ(send(http::verb::get, "/matchmaking/" + tickets[0]).result(), http::status::not_found);
+  }
+
+  TEST(SpectatorHubTest, FansEachFrameOutOnceAndDropsStaleRevisions)
+  {
+    struct Viewer : SpectatorViewer
+    {
+      std::vector<SpectatorFrame> frames;
+      void deliver(const SpectatorFrame& frame, std::uint64_t) override { frames.push_back(frame); }
+    };
+
+    SpectatorHub hub{ SpectatorPolicy::Revealed };
+    const auto frame = [](std::string text) { return std::make_shared<const std::string>(std::move(text)); };
+    hub.publish("g1", 1, frame("unwatched"));
+    EXPECT_FALSE(hub.watched("g1"));
+
+    auto first = std::make_shared<Viewer>();
+    auto second = std::make_shared<Viewer>();
+    EXPECT_EQ(hub.subscribe("g1", first), nullptr);
+    EXPECT_EQ(hub.subscribe("g1", second), nullptr);
+    EXPECT_TRUE(hub.watched("g1"));
+    EXPECT_FALSE(hub.watched("g2"));
+    EXPECT_EQ(hub.viewerCount(), 2U);
+
+    // Every viewer gets the same buffer; a revision already sent, or an older one, goes nowhere.
+    const auto update = frame("r2");
+    hub.publish("g1", 2, update);
+    hub.publish("g1", 2, frame("r2 again"));
+    hub.publish("g1", 1, frame("r1"));
+    ASSERT_EQ(first->frames.size(), 1U);
+    ASSERT_EQ(second->frames.size(), 1U);
+    EXPECT_EQ(first->frames[0].get(), update.get());
+    EXPECT_EQ(second->frames[0].get(), update.get());
+
+    // A late viewer starts from the last frame; viewers that left, or were destroyed, get nothing more.
+    auto late = std::make_shared<Viewer>();
+    EXPECT_EQ(hub.subscribe("g1", late), update);
+    hub.unsubscribe("g1", first.get());
+    second.reset();
+    hub.publish("g1", 3, frame("r3"));
+    EXPECT_EQ(first->frames.size(), 1U);
+    ASSERT_EQ(late->frames.size(), 1U);
+    EXPECT_EQ(*late->frames[0], "r3");
+
+    hub.unsubscribe("g1", late.get());
+    EXPECT_FALSE(hub.watched("g1"));
+    EXPECT_EQ(hub.viewerCount(), 0U);
+  }
+
+  TEST_F(HttpRouterTest, SpectateShowsShipsOnlyAsThePolicyAllows)
+  {
+    const auto created = parseJson(send(http::verb::post, "/games").body());
+    const auto gameId = created.get<std::string>("gameId");
+    const auto host = bearer(created.get<std::string>("playerToken"));
+    EXPECT_EQ(send(http::verb::get, "/games/" + gameId + "/spectate").result(), http::status::not_found);
+
+    store.attachSpectators(std::make_shared<SpectatorHub>(SpectatorPolicy::Hidden));
+    ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/join").result(), http::status::ok);
+    ASSERT_EQ(send(http::verb::post, "/games/" + gameId + "/fleet/random", "", host).result(), http::status::ok);
+    EXPECT_EQ(send(http::verb::get, "/games/missing/spectate").result(), http::status::not_found);
+
+    const auto res = send(http::verb::get, "/games/" + gameId + "/spectate");
+    ASSERT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(res[http::field::content_type], "text/event-stream");
+    ASSERT_TRUE(res.body().starts_with("data: ") && res.body().ends_with("}\n\n")) << res.body();
+    const auto frame = parseJson(res.body().substr(6));
+    EXPECT_EQ(frame.get<std::string>("gameId"), gameId);
+    EXPECT_EQ(frame.get<std::string>("status"), "placing");
+    EXPECT_EQ(frame.get<std::uint64_t>("revision"), 1U + battleship::STANDARD_FLEET.size());
+    EXPECT_EQ(res.body().find("occupied"), std::string::npos);
+
+    // A connection that streams the frames itself gets the verdict without one.
+    const auto streamed = buildRequest(http::verb::get, "/games/" + gameId + "/spectate");
+    http::response<http::string_body> head;
+    head.body() = "left over from the last response";
+    const auto target = streamed.target();
+    const auto route = match_route(streamed.method(), std::string_view{ target.data(), target.size() });
+    handle_request(store, route, streamed, head, nullptr, nullptr, true);
+    EXPECT_EQ(head.result(), http::status::ok);
+    EXPECT_EQ(head[http::field::content_type], "text/event-stream");
+    EXPECT_TRUE(head.body().empty()) << head.body();
+
+    SpectatorHub revealed{ SpectatorPolicy::Revealed };
+    struct Viewer : SpectatorViewer
+    {
+      SpectatorFrame last;
+      void deliver(const SpectatorFrame& frame, std::uint64_t) override { last = frame; }
+    };
+    auto viewer = std::make_shared<Viewer>();
+    (void)revealed.subscribe(gameId, viewer);
+    ASSERT_TRUE(publish_spectator_frame(store, revealed, gameId));
+    ASSERT_NE(viewer->last, nullptr);
+    EXPECT_NE(viewer->last->find("occupied"), std::string::npos);
+  }
+
+  TEST(HttpServerTest, ServesKeepAliveRequestsAndDrainsOnStop)
+  {
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    GameStore store;
+    ServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = 0;
+    config.ioThreads = 2;
+    HttpServer httpServer{ store, config };
+    httpServer.start();
+    ASSERT_NE(httpServer.port(), 0);
+
+    asio::io_context ioc;
+    tcp::socket socket{ ioc };
+    socket.connect({ asio::ip::make_address("127.0.0.1"), httpServer.port() });
+    boost::beast::flat_buffer buffer;
+    const auto exchange = [&](const http::request<http::string_body>& req) {
+      http::write(socket, req);
+      http::response<http::string_body> res;
+      http::read(socket, buffer, res);
+      return res;
+    };
+
+    auto create = buildRequest(http::verb::post, "/games");
+    create.keep_alive(true);
+    const auto created = exchange(create);
+    ASSERT_EQ(created.result(), http::status::ok);
+    EXPECT_TRUE(created.keep_alive());
+    const auto gameId = parseJson(created.body()).get<std::string>("gameId");
+    const auto token = parseJson(created.body()).get<std::string>("playerToken");
+
+    auto poll = buildRequest(http::verb::get, "/games/" + gameId, "", bearer(token));
+    poll.keep_alive(true);
+    EXPECT_EQ(exchange(poll).result(), http::status::ok);
+
+    // The idle keep-alive connection is closed by the drain, and wait() returns once it is gone.
+    httpServer.stop();
+    httpServer.wait();
+    http::response<http::string_body> res;
+    boost::beast::error_code ec;
+    http::read(socket, buffer, res, ec);
+    EXPECT_EQ(ec, http::error::end_of_stream);
+  }
+
+  TEST(HttpServerTest, GameActorsPlayAGameOnTheShardStrands)
+  {
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    GameStore store{ 4 };
+    ServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = 0;
+    config.ioThreads = 2;
+    config.gameActors = true;
+    HttpServer httpServer{ store, config };
+    httpServer.start();
+
+    asio::io_context ioc;
+    tcp::socket socket{ ioc };
+    socket.connect({ asio::ip::make_address("127.0.0.1"), httpServer.port() });
+    boost::beast::flat_buffer buffer;
+    const auto exchange = [&](http::verb method, const std::string& target, const std::optional<std::string>& auth) {
+      auto req = buildRequest(method, target, "", auth);
+      req.keep_alive(true);
+      http::write(socket, req);
+      http::response<http::string_body> res;
+      http::read(socket, buffer, res);
+      return res;
+    };
+
+    const auto created = exchange(http::verb::post, "/games", std::nullopt);
+    ASSERT_EQ(created.result(), http::status::ok);
+    const auto gameId = parseJson(created.body()).get<std::string>("gameId");
+    const auto first = bearer(parseJson(created.body()).get<std::string>("playerToken"));
+    const auto joined = exchange(http::verb::post, "/games/" + gameId + "/join", std::nullopt);
+    ASSERT_EQ(joined.result(), http::status::ok);
+    const auto second = bearer(parseJson(joined.body()).get<std::string>("playerToken"));
+
+    for (const auto& token : { first, second })
+    {
+      EXPECT_EQ(exchange(http::verb::post, "/games/" + gameId + "/fleet/random", token).result(), http::status::ok);
+      EXPECT_EQ(exchange(http::verb::post, "/games/" + gameId + "/ready", token).result(), http::status::ok);
+    }
+    const auto game = exchange(http::verb::get, "/games/" + gameId, first);
+    ASSERT_EQ(game.result(), http::status::ok);
+    EXPECT_EQ(parseJson(game.body()).get<std::string>("status"), "in_progress");
+
+    httpServer.stop();
+    httpServer.wait();
+  }
+
+  TEST(HttpServerTest, SpectatorStreamPushesEveryMove)
+  {
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    GameStore store;
+    store.attachSpectators(std::make_shared<SpectatorHub>(SpectatorPolicy::Hidden));
+    ServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = 0;
+    config.ioThreads = 2;
+    HttpServer httpServer{ store, config };
+    httpServer.start();
+
+    const auto created = parseJson(handle_request(store, buildRequest(http::verb::post, "/games")).body());
+    const auto gameId = created.get<std::string>("gameId");
+    const auto host = bearer(created.get<std::string>("playerToken"));
+
+    asio::io_context ioc;
+    tcp::socket spectator{ ioc };
+    spectator.connect({ asio::ip::make_address("127.0.0.1"), httpServer.port() });
+    http::write(spectator, buildRequest(http::verb::get, "/games/" + gameId + "/spectate"));
+    std::string received;
+    const auto next = [&](std::string_view delimiter) {
+      const auto n = asio::read_until(spectator, asio::dynamic_buffer(received), delimiter);
+      std::string part = received.substr(0, n);
+      received.erase(0, n);
+      return part;
+    };
+    const auto nextFrame = [&] {
+      const auto part = next("\n\n");
+      EXPECT_TRUE(part.starts_with("data: ")) << part;
+      return parseJson(part.substr(6));
+    };
+
+    const auto headers = next("\r\n\r\n");
+    EXPECT_TRUE(headers.starts_with("HTTP/1.1 200 OK\r\n")) << headers;
+    EXPECT_NE(headers.find("Content-Type: text/event-stream"), std::string::npos);
+    EXPECT_EQ(nextFrame().get<std::uint64_t>("revision"), 0U);
+
+    // Moves made through the server reach the open stream without it asking again.
+    asio::io_context playerIoc;
+    tcp::socket player{ playerIoc };
+    player.connect({ asio::ip::make_address("127.0.0.1"), httpServer.port() });
+    boost::beast::flat_buffer buffer;
+    const auto exchange = [&](const std::string& target, const std::optional<std::string>& auth) {
+      auto req = buildRequest(http::verb::post, target, "", auth);
+      req.keep_alive(true);
+      http::write(player, req);
+      http::response<http::string_body> res;
+      http::read(player, buffer, res);
+      return res;
+    };
+    ASSERT_EQ(exchange("/games/" + gameId + "/join", std::nullopt).result(), http::status::ok);
+    const auto joined = nextFrame();
+    EXPECT_EQ(joined.get<std::uint64_t>("revision"), 1U);
+    EXPECT_EQ(joined.get<std::string>("status"), "placing");
+
+    ASSERT_EQ(exchange("/games/" + gameId + "/fleet/random", host).result(), http::status::ok);
+    const auto placed = next("\n\n");
+    EXPECT_NE(placed.find("\"revision\":\"" + std::to_string(1 + battleship::STANDARD_FLEET.size()) + '"'), std::string::npos) << placed;
+    EXPECT_EQ(placed.find("occupied"), std::string::npos);
+
+    // Draining closes open streams.
+    httpServer.stop();
+    httpServer.wait();
+    boost::system::error_code ec;
+    while (!ec)
+    {
+      asio::read_until(spectator, asio::dynamic_buffer(received), "\n\n", ec);
+      received.clear();
+    }
+    EXPECT_EQ(ec, asio::error::eof);
+    EXPECT_EQ(store.spectators()->viewerCount(), 0U);
+  }
+
+  TEST(ClusterTest, GameIdsNameTheirOwningNode)
+  {
+    EXPECT_EQ(gameIdPrefix(0, 1), "");
+    EXPECT_EQ(gameIdPrefix(3, 4), "3-");
+    EXPECT_EQ(gameOwner("3-abcdefgh", 4), 3U);
+    EXPECT_EQ(gameOwner("abcdefgh", 4), 0U);
+    EXPECT_EQ(gameOwner("7-abcdefgh", 4), 0U);
+    EXPECT_EQ(gameOwner("12", 4), 0U);
+
+    GameStore store{ 1, gameIdPrefix(2, 3) };
+    EXPECT_EQ(gameOwner(store.createGame().gameId, 3), 2U);
+
+    EXPECT_EQ(joinLobbyCursor(splitLobbyCursor(0, 3), 3), 0U);
+    EXPECT_EQ(splitLobbyCursor(joinLobbyCursor({ .node = 2, .cursor = 17 }, 3), 3).node, 2U);
+    EXPECT_EQ(splitLobbyCursor(joinLobbyCursor({ .node = 2, .cursor = 17 }, 3), 3).cursor, 17U);
+    EXPECT_EQ(joinLobbyCursor({ .node = 0, .cursor = 17 }, 1), 17U);
+
+    const auto nodes = parseClusterNodes("127.0.0.1:9001,localhost:9002");
+    ASSERT_TRUE(nodes.has_value()) << nodes.error();
+    ASSERT_EQ(nodes->size(), 2U);
+    EXPECT_EQ((*nodes)[1].host, "localhost");
+    EXPECT_EQ((*nodes)[1].port, 9002);
+    EXPECT_FALSE(parseClusterNodes("127.0.0.1").has_value());
+    EXPECT_FALSE(parseClusterNodes("127.0.0.1:0").has_value());
+
+    const auto noEnv = [](const char*) -> const char* { return nullptr; };
+    const char* argv[] = { "server", "--cluster", "a:1,b:2", "--node-index", "2" };
+    EXPECT_EQ(parseServerConfig(static_cast<int>(std::size(argv)), argv, noEnv).error(),
+              "--node-index 2 is outside the 2 nodes of --cluster");
+    const char* ipRate[] = { "server", "--cluster", "a:1,b:2", "--ip-rate", "10" };
+    EXPECT_EQ(parseServerConfig(static_cast<int>(std::size(ipRate)), ipRate, noEnv).error(),
+              "--ip-rate cannot be combined with --cluster: nodes only see the router's address");
+  }
+
+  TEST(ClusterTest, ProxyRoutesEachGameToItsNode)
+  {
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    ServerConfig nodeConfig;
+    nodeConfig.address = "127.0.0.1";
+    nodeConfig.port = 0;
+    std::vector<std::unique_ptr<GameStore>> stores;
+    std::vector<std::unique_ptr<HttpServer>> nodes;
+    ServerConfig proxyConfig = nodeConfig;
+    proxyConfig.ioThreads = 2;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+      stores.push_back(std::make_unique<GameStore>(1, gameIdPrefix(i, 2)));
+      stores.back()->attachSpectators(std::make_shared<SpectatorHub>(SpectatorPolicy::Revealed));
+      stores.back()->attachMatchmaker(std::make_shared<Matchmaker>(*stores.back()));
+      nodes.push_back(std::make_unique<HttpServer>(*stores.back(), nodeConfig));
+      nodes.back()->start();
+      proxyConfig.clusterNodes.push_back({ "127.0.0.1", nodes.back()->port() });
+    }
+    ClusterProxy proxy{ proxyConfig };
+    proxy.start();
+
+    asio::io_context ioc;
+    tcp::socket socket{ ioc };
+    socket.connect({ asio::ip::make_address("127.0.0.1"), proxy.port() });
+    boost::beast::flat_buffer buffer;
+    const auto exchange = [&](http::verb method, const std::string& target, const std::optional<std::string>& auth) {
+      auto req = buildRequest(method, target, "", auth);
+      req.keep_alive(true);
+      http::write(socket, req);
+      http::response<http::string_body> res;
+      http::read(socket, buffer, res);
+      return res;
+    };
+
+    // New games alternate between the nodes; every later request on a game reaches the node that created it.
+    std::vector<std::pair<std::string, std::string>> games;
+    for (int i = 0; i < 4; ++i)
+    {
+      const auto created = exchange(http::verb::post, "/games", std::nullopt);
+      ASSERT_EQ(created.result(), http::status::ok);
+      const auto body = parseJson(created.body());
+      games.emplace_back(body.get<std::string>("gameId"), bearer(body.get<std::string>("playerToken")));
+    }
+    for (const auto& [gameId, token] : games)
+    {
+      const auto owner = gameOwner(gameId, 2);
+      EXPECT_TRUE(stores[owner]->getGameView(gameId).has_value()) << gameId;
+      EXPECT_FALSE(stores[1 - owner]->getGameView(gameId).has_value()) << gameId;
+
+      EXPECT_EQ(exchange(http::verb::post, "/games/" + gameId + "/join", std::nullopt).result(), http::status::ok);
+      EXPECT_EQ(exchange(http::verb::post, "/games/" + gameId + "/fleet/random", token).result(), http::status::ok);
+      const auto game = exchange(http::verb::get, "/games/" + gameId, token);
+      ASSERT_EQ(game.result(), http::status::ok);
+      EXPECT_TRUE(game.keep_alive());
+      EXPECT_EQ(parseJson(game.body()).get<std::string>("gameId"), gameId);
+    }
+    EXPECT_EQ(stores[0]->stats().gamesByStatus[static_cast<std::size_t>(GameStatus::Placing)], 2U);
+    EXPECT_EQ(stores[1]->stats().gamesByStatus[static_cast<std::size_t>(GameStatus::Placing)], 2U);
+
+    // Players joining the matchmaking queue one after the other still meet: they all queue on node 0.
+    std::vector<std::string> tickets;
+    for (int i = 0; i < 2; ++i)
+    {
+      const auto queued = exchange(http::verb::post, "/matchmaking", std::nullopt);
+      ASSERT_EQ(queued.result(), http::status::accepted) << queued.body();
+      tickets.push_back(parseJson(queued.body()).get<std::string>("ticket"));
+    }
+    std::vector<std::string> matched;
+    for (const auto& ticket : tickets)
+    {
+      for (int i = 0; i < 2000; ++i)
+      {
+        const auto res = exchange(http::verb::get, "/matchmaking/" + ticket, std::nullopt);
+        if (res.result() == http::status::ok)
+        {
+          matched.push_back(parseJson(res.body()).get<std::string>("gameId"));
+          break;
+        }
+        ASSERT_EQ(res.result(), http::status::accepted) << res.body();
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+      }
+    }
+    ASSERT_EQ(matched.size(), 2U);
+    EXPECT_EQ(matched[0], matched[1]);
+    EXPECT_EQ(gameOwner(matched[0], 2), 0U);
+
+    // Spectator streams are relayed from the owning node as they arrive; other answers come back as usual.
+    EXPECT_EQ(exchange(http::verb::get, "/games/1-missing/spectate", std::nullopt).result(), http::status::not_found);
+    const auto watched = std::find_if(games.begin(), games.end(), [](const auto& game) { return gameOwner(game.first, 2) == 1; });
+    ASSERT_NE(watched, games.end());
+    tcp::socket spectator{ ioc };
+    spectator.connect({ asio::ip::make_address("127.0.0.1"), proxy.port() });
+    http::write(spectator, buildRequest(http::verb::get, "/games/" + watched->first + "/spectate"));
+    std::string stream;
+    const auto next = [&](std::string_view delimiter) {
+      const auto n = asio::read_until(spectator, asio::dynamic_buffer(stream), delimiter);
+      std::string part = stream.substr(0, n);
+      stream.erase(0, n);
+      return part;
+    };
+    EXPECT_TRUE(next("\r\n\r\n").starts_with("HTTP/1.1 200 OK\r\n"));
+    EXPECT_NE(next("\n\n").find("\"player1Ready\":\"false\""), std::string::npos);
+    EXPECT_EQ(exchange(http::verb::post, "/games/" + watched->first + "/ready", watched->second).result(), http::status::ok);
+    EXPECT_NE(next("\n\n").find("\"player1Ready\":\"true\""), std::string::npos);
+
+    // A stopped node's games answer 502 while the other node's keep working; its streams end.
+    nodes[1]->stop();
+    nodes[1]->wait();
+    boost::system::error_code streamEc;
+    asio::read_until(spectator, asio::dynamic_buffer(stream), "never", streamEc);
+    EXPECT_EQ(streamEc, asio::error::eof);
+    for (const auto& [gameId, token] : games)
+    {
+      const auto expected = gameOwner(gameId, 2) == 1 ? http::status::bad_gateway : http::status::ok;
+      EXPECT_EQ(exchange(http::verb::get, "/games/" + gameId, token).result(), expected) << gameId;
+    }
+
+    proxy.stop();
+    proxy.wait();
+  }
+
+  TEST(ClusterTest, ProxyPagesTheLobbyAcrossNodes)
+  {
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    ServerConfig nodeConfig;
+    nodeConfig.address = "127.0.0.1";
+    nodeConfig.port = 0;
+    std::vector<std::unique_ptr<GameStore>> stores;
+    std::vector<std::unique_ptr<HttpServer>> nodes;
+    ServerConfig proxyConfig = nodeConfig;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+      stores.push_back(std::make_unique<GameStore>(2, gameIdPrefix(i, 2)));
+      nodes.push_back(std::make_unique<HttpServer>(*stores.back(), nodeConfig));
+      nodes.back()->start();
+      proxyConfig.clusterNodes.push_back({ "127.0.0.1", nodes.back()->port() });
+    }
+    std::set<std::string> created;
+    for (int i = 0; i < 3; ++i)
+    {
+      created.insert(stores[0]->createGame().gameId);
+    }
+    created.insert(stores[1]->createGame().gameId);
+    ClusterProxy proxy{ proxyConfig };
+    proxy.start();
+
+    asio::io_context ioc;
+    tcp::socket socket{ ioc };
+    socket.connect({ asio::ip::make_address("127.0.0.1"), proxy.port() });
+    boost::beast::flat_buffer buffer;
+    const auto list = [&](const std::string& target) {
+      auto req = buildRequest(http::verb::get, target);
+      req.keep_alive(true);
+      http::write(socket, req);
+      http::response<http::string_body> res;
+      http::read(socket, buffer, res);
+      return res;
+    };
+
+    // Pages of two walk node 0's three games and then node 1's one, whichever node the request would otherwise
+    // have gone to.
+    std::vector<std::string> listed;
+    std::vector<std::size_t> pageSizes;
+    std::string target = "/games?limit=2";
+    for (int page = 0; page < 10; ++page)
+    {
+      const auto res = list(target);
+      ASSERT_EQ(res.result(), http::status::ok) << res.body();
+      const auto body = parseJson(res.body());
+      pageSizes.push_back(body.get_child("gameIds").size());
+      for (const auto& [key, id] : body.get_child("gameIds"))
+      {
+        listed.push_back(id.get_value<std::string>());
+      }
+      const auto next = body.get_optional<std::string>("nextCursor");
+      if (!next.has_value())
+      {
+        break;
+      }
+      target = "/games?cursor=" + *next + "&limit=2";
+    }
+    EXPECT_EQ(pageSizes, (std::vector<std::size_t>{ 2, 1, 1 }));
+    ASSERT_EQ(listed.size(), 4U);
+    EXPECT_EQ(std::set<std::string>(listed.begin(), listed.end()), created);
+    EXPECT_EQ(gameOwner(listed[2], 2), 0U);
+    EXPECT_EQ(gameOwner(listed[3], 2), 1U);
+
+    EXPECT_EQ(list("/games?cursor=x").result(), http::status::bad_request);
+
+    proxy.stop();
+    proxy.wait();
+  }
+
+  TEST(ClusterTest, ProxyRepeatsOnlySafeRequestsAfterAReset)
+  {
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    // A node that answers the first request on each connection and resets the connection after reading the
+    // second, as one dying halfway through a request would.
+    asio::io_context nodeIoc;
+    tcp::acceptor acceptor{ nodeIoc, { asio::ip::make_address("127.0.0.1"), 0 } };
+    std::atomic<int> received{ 0 };
+    std::thread node{ [&] {
+      for (int connection = 0; connection < 3; ++connection)
+      {
+        boost::system::error_code ec;
+        tcp::socket peer = acceptor.accept(ec);
+        boost::beast::flat_buffer peerBuffer;
+        for (int i = 0; !ec && i < 2; ++i)
+        {
+          http::request<http::string_body> req;
+          http::read(peer, peerBuffer, req, ec);
+          if (ec)
+          {
+            break;
+          }
+          received.fetch_add(1);
+          if (i == 1)
+          {
+            peer.set_option(asio::socket_base::linger(true, 0));
+            peer.close(ec);
+            break;
+          }
+          http::response<http::string_body> res{ http::status::ok, req.version() };
+          res.keep_alive(true);
+          res.body() = "{}";
+          res.prepare_payload();
+          http::write(peer, res, ec);
+        }
+      }
+    } };
+
+    ServerConfig proxyConfig;
+    proxyConfig.address = "127.0.0.1";
+    proxyConfig.port = 0;
+    proxyConfig.clusterNodes.push_back({ "127.0.0.1", acceptor.local_endpoint().port() });
+    ClusterProxy proxy{ proxyConfig };
+    proxy.start();
+
+    asio::io_context ioc;
+    tcp::socket socket{ ioc };
+    socket.connect({ asio::ip::make_address("127.0.0.1"), proxy.port() });
+    boost::beast::flat_buffer buffer;
+    const auto exchange = [&](http::verb method, const std::string& target) {
+      auto req = buildRequest(method, target);
+      req.keep_alive(true);
+      http::write(socket, req);
+      http::response<http::string_body> res;
+      http::read(socket, buffer, res);
+      return res;
+    };
+
+    // The reset POST may have been applied, so it is answered 502 rather than sent again.
+    EXPECT_EQ(exchange(http::verb::get, "/games/0-abc").result(), http::status::ok);
+    EXPECT_EQ(exchange(http::verb::post, "/games/0-abc/join").result(), http::status::bad_gateway);
+    EXPECT_EQ(received.load(), 2);
+
+    // A reset GET is repeated on a fresh connection.
+    EXPECT_EQ(exchange(http::verb::get, "/games/0-abc").result(), http::status::ok);
+    EXPECT_EQ(exchange(http::verb::get, "/games/0-abc").result(), http::status::ok);
+    EXPECT_EQ(received.load(), 5);
+
+    socket.close();
+    proxy.stop();
+    proxy.wait();
+    node.join();
+  }
+
+  TEST(UringServerTest, ServesPipelinedRequestsAndDrainsOnStop)
+  {
+    if (!UringServer::supported())
+    {
+      GTEST_SKIP() << "built without io_uring or the kernel does not allow it";
+    }
+    namespace asio = boost::asio;
+    using tcp = asio::ip::tcp;
+
+    GameStore store;
+    ServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = 0;
+    config.ioThreads = 2;
+    UringServer uringServer{ store, config };
+    uringServer.start();
+    ASSERT_NE(uringServer.port(), 0);
+
+    asio::io_context ioc;
+    tcp::socket socket{ ioc };
+    socket.connect({ asio::ip::make_address("127.0.0.1"), uringServer.port() });
+    boost::beast::flat_buffer buffer;
+
+    auto create = buildRequest(http::verb::post, "/games");
+    create.keep_alive(true);
+    http::write(socket, create);
+    http::response<http::string_body> created;
+    http::read(socket, buffer, created);
+    ASSERT_EQ(created.result(), http::status::ok);
+    const auto gameId = parseJson(created.body()).get<std::string>("gameId");
+    const auto token = parseJson(created.body()).get<std::string>("playerToken");
+
+    // Both polls reach the server in one segment and are answered in order.
+    auto poll = buildRequest(http::verb::get, "/games/" + gameId, "", bearer(token));
+    poll.keep_alive(true);
+    std::ostringstream pipelined;
+    pipelined << poll << poll;
+    asio::write(socket, asio::buffer(pipelined.str()));
+    for (int i = 0; i < 2; ++i)
+    {
+      http::response<http::string_body> res;
+      http::read(socket, buffer, res);
+      EXPECT_EQ(res.result(), http::status::ok);
+      EXPECT_TRUE(res.keep_alive());
+    }
+
+    uringServer.stop();
+    uringServer.wait();
+    http::response<http::string_body> res;
+    boost::beast::error_code ec;
+    http::read(socket, buffer, res, ec);
+    EXPECT_EQ(ec, http::error::end_of_stream);
+  }
+
 }  // namespace server::tests
@@ -3,16 +3,20 @@
 #include <gtest/gtest.h>
 
 #include "project/core/boat.hpp"
+#include "project/core/fleetGenerator.hpp"
+#include "project/core/replay.hpp"
 #include "project/exceptions/exceptions.hpp"
 
 namespace battleship::tests
 {
   using battleship::Board;
   using battleship::Boat;
+  using battleship::BoardError;
   using battleship::BoatType;
   using battleship::Cell;
   using battleship::CellState;
   using battleship::Coordinate;
+  using battleship::FleetPlacement;
   using battleship::Orientation;
   using battleship::Placement;
 
@@ -125,6 +129,52 @@ namespace battleship::tests
     EXPECT_THROW(Place(BoatType::DESTROYER, start, orientation), Collision);
   }
 
+  TEST_F(BoardFixture, PlaceBoat_NorthPastFirstRow_Throws)
+  {
+    // GIVEN
+    const Coordinate start{ 0, 4 };
+    const Orientation orientation{ Orientation::NORTH };
+
+    // WHEN & THEN
+    EXPECT_THROW(Place(BoatType::DESTROYER, start, orientation), OutOfBounds);
+    ExpectAllCells(CellState::EMPTY);
+  }
+
+  TEST_F(BoardFixture, PlaceFleet_AllBoatsOccupied)
+  {
+    // GIVEN
+    const std::vector<FleetPlacement> fleet{
+      { BoatType::CRUISER, Placement{ C(0, 0), Orientation::EAST } },
+      { BoatType::DESTROYER, Placement{ C(5, 5), Orientation::SOUTH } },
+    };
+
+    // WHEN
+    board.placeFleet(fleet);
+
+    // THEN
+    ExpectCells({ { 0, 0 }, { 0, 1 }, { 0, 2 }, { 5, 5 }, { 6, 5 } }, CellState::OCCUPIED);
+  }
+
+  TEST_F(BoardFixture, PlaceFleet_CollisionRollsBackWholeFleet)
+  {
+    // GIVEN
+    Place(BoatType::DESTROYER, C(9, 9), Orientation::WEST);
+    const std::vector<FleetPlacement> fleet{
+      { BoatType::CRUISER, Placement{ C(0, 0), Orientation::EAST } },
+      { BoatType::SUBMARINE, Placement{ C(1, 1), Orientation::SOUTH } },
+    };
+
+    // WHEN & THEN
+    EXPECT_THROW(board.placeFleet(fleet), Collision);
+    ExpectCells({ { 0, 0 }, { 0, 1 }, { 0, 2 }, { 1, 1 } }, CellState::EMPTY);
+    ExpectCells({ { 9, 9 }, { 9, 8 } }, CellState::OCCUPIED);
+
+    // Rolled-back boats must not linger as structures either.
+    Shot(C(9, 9));
+    Shot(C(9, 8));
+    EXPECT_TRUE(board.allBoatsDestroyed());
+  }
+
   TEST_F(BoardFixture, ShotMiss_UpdatesCellState)
   {
     // GIVEN
@@ -206,4 +256,174 @@ namespace battleship::tests
     EXPECT_THROW(Place(BoatType::CRUISER, start, bad_orientation), std::invalid_argument);
   }
 
-}  // namespace battleship::tests
\ No newline at end of file
+
+  TEST_F(BoardFixture, RandomFleet_IsLegalOnEmptyBoard)
+  {
+    // GIVEN
+    std::mt19937 rng{ 42 };
+
+    for (int round = 0; round < 200; ++round)
+    {
+      Board fresh{};
+
+      // WHEN
+      const auto fleet = generateRandomFleet(fresh, rng);
+
+      // THEN
+      ASSERT_EQ(fleet.size(), STANDARD_FLEET.size());
+      EXPECT_NO_THROW(fresh.placeFleet(fleet)) << "Generated fleet must satisfy placeStructure rules.";
+      EXPECT_EQ(fresh.structureCount(), STANDARD_FLEET.size());
+    }
+  }
+
+  TEST_F(BoardFixture, RandomFleet_RespectsExistingStructures)
+  {
+    // GIVEN
+    Place(BoatType::CARRIER, C(4, 0), Orientation::EAST);
+    std::mt19937 rng{ 7 };
+
+    // WHEN
+    const auto fleet = generateRandomFleet(board, std::vector<BoatType>{ BoatType::DESTROYER, BoatType::CRUISER }, rng);
+
+    // THEN
+    EXPECT_NO_THROW(board.placeFleet(fleet));
+    EXPECT_EQ(board.structureCount(), 3U);
+  }
+
+  TEST_F(BoardFixture, RandomFleet_ThrowsWhenFleetCannotFit)
+  {
+    // GIVEN
+    std::mt19937 rng{ 1 };
+    const std::vector<BoatType> crowded(30, BoatType::CARRIER);
+
+    // WHEN & THEN
+    EXPECT_THROW((void)generateRandomFleet(board, crowded, rng), std::runtime_error);
+  }
+
+  TEST_F(BoardFixture, TryPlaceStructure_ReportsErrorsWithoutChangingBoard)
+  {
+    // GIVEN
+    Place(BoatType::CRUISER, C(1, 1), Orientation::EAST);
+
+    // WHEN & THEN
+    EXPECT_EQ(board.tryPlaceStructure(Boat{ BoatType::DESTROYER }, Placement{ C(1, 0), Orientation::SOUTH }),
+              BoardError::Collision);
+    EXPECT_EQ(board.tryPlaceStructure(Boat{ BoatType::CRUISER }, Placement{ C(9, 8), Orientation::EAST }),
+              BoardError::OutOfBounds);
+    EXPECT_EQ(board.tryPlaceStructure(Boat{ BoatType::CRUISER }, Placement{ C(5, 5), static_cast<Orientation>(99) }),
+              BoardError::InvalidOrientation);
+    EXPECT_EQ(board.structureCount(), 1U);
+    ExpectCells({ { 9, 8 }, { 9, 9 }, { 2, 0 } }, CellState::EMPTY);
+
+    EXPECT_EQ(board.tryPlaceStructure(Boat{ BoatType::DESTROYER }, Placement{ C(5, 5), Orientation::SOUTH }),
+              BoardError::None);
+    EXPECT_EQ(board.structureCount(), 2U);
+  }
+
+  TEST_F(BoardFixture, PlacedBoats_ReturnsPlacementsInOrder)
+  {
+    // GIVEN
+    Place(BoatType::CRUISER, C(1, 1), Orientation::EAST);
+    Place(BoatType::DESTROYER, C(5, 5), Orientation::SOUTH);
+
+    // WHEN
+    const auto boats = board.placedBoats();
+
+    // THEN
+    ASSERT_EQ(boats.size(), 2U);
+    EXPECT_EQ(boats[0].type, BoatType::CRUISER);
+    EXPECT_EQ(boats[0].placement.coordinate.col, 1);
+    EXPECT_EQ(boats[1].type, BoatType::DESTROYER);
+    EXPECT_EQ(boats[1].placement.orientation, Orientation::SOUTH);
+  }
+
+  TEST_F(BoardFixture, TryHandleShot_ReturnsCellStateOrError)
+  {
+    // GIVEN
+    Place(BoatType::DESTROYER, C(5, 5), Orientation::EAST);
+
+    // WHEN
+    const auto hit = board.tryHandleShot(C(5, 5));
+    const auto miss = board.tryHandleShot(C(0, 0));
+    const auto again = board.tryHandleShot(C(0, 0));
+    const auto outside = board.tryHandleShot(C(10, 0));
+
+    // THEN
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(*hit, CellState::HIT);
+    ASSERT_TRUE(miss.has_value());
+    EXPECT_EQ(*miss, CellState::MISS);
+    ASSERT_FALSE(again.has_value());
+    EXPECT_EQ(again.error(), BoardError::AlreadyShot);
+    ASSERT_FALSE(outside.has_value());
+    EXPECT_EQ(outside.error(), BoardError::CoordinateOutOfBounds);
+  }
+
+  TEST(CoordinateTest, TryParseMatchesParseFromString)
+  {
+    const auto ok = Coordinate::tryParse(" j10 ");
+    ASSERT_TRUE(ok.has_value());
+    EXPECT_EQ(ok->row, 9);
+    EXPECT_EQ(ok->col, 9);
+    EXPECT_EQ(ok->toString(), "J10");
+
+    const auto bad = Coordinate::tryParse("Z1");
+    ASSERT_FALSE(bad.has_value());
+    EXPECT_STREQ(bad.error(), "Invalid row character");
+    EXPECT_THROW((void)Coordinate::parseFromString("A11"), std::invalid_argument);
+  }
+
+  class ReplayFixture : public ::testing::Test
+  {
+   protected:
+    // A destroyer at A1-A2 for each player; player 1 sinks it in two hits while player 2 misses once.
+    static std::array<std::vector<FleetPlacement>, 2> fleets()
+    {
+      const FleetPlacement destroyer{ BoatType::DESTROYER, Placement{ Coordinate{ 0, 0 }, Orientation::EAST } };
+      return { std::vector<FleetPlacement>{ destroyer }, std::vector<FleetPlacement>{ destroyer } };
+    }
+
+    static std::vector<ReplayMove> moves()
+    {
+      return { ReplayMove{ 0, Coordinate{ 0, 0 } }, ReplayMove{ 1, Coordinate{ 5, 5 } }, ReplayMove{ 0, Coordinate{ 0, 1 } } };
+    }
+  };
+
+  TEST_F(ReplayFixture, PositionAt_AppliesMovesUpToTheRequestedOne)
+  {
+    Replay replay{ fleets(), moves(), 2 };
+    ASSERT_EQ(replay.moveCount(), 3U);
+
+    const auto initial = replay.positionAt(0);
+    EXPECT_EQ(initial.boards[1][0][0], CellState::OCCUPIED);
+    EXPECT_EQ(initial.winner, -1);
+
+    const auto second = replay.positionAt(2);
+    EXPECT_EQ(second.move, 2U);
+    EXPECT_EQ(second.boards[1][0][0], CellState::HIT);
+    EXPECT_EQ(second.boards[1][0][1], CellState::OCCUPIED);
+    EXPECT_EQ(second.boards[0][5][5], CellState::MISS);
+    EXPECT_EQ(second.winner, -1);
+
+    const auto last = replay.positionAt(3);
+    EXPECT_EQ(last.boards[1][0][1], CellState::HIT);
+    EXPECT_EQ(last.winner, 0);
+
+    // Seeking backwards starts again from a checkpoint rather than the current position.
+    EXPECT_EQ(replay.positionAt(1).boards[0][5][5], CellState::EMPTY);
+    EXPECT_THROW((void)replay.positionAt(4), std::out_of_range);
+  }
+
+  TEST_F(ReplayFixture, Checkpoints_AreOnlyBuiltUpToTheFurthestRequest)
+  {
+    Replay replay{ fleets(), moves(), 2 };
+    EXPECT_EQ(replay.checkpointCount(), 1U);
+
+    EXPECT_EQ(replay.resultOf(0), CellState::HIT);
+    EXPECT_EQ(replay.checkpointCount(), 1U);
+    EXPECT_EQ(replay.resultOf(1), CellState::MISS);
+    EXPECT_EQ(replay.checkpointCount(), 2U);
+    EXPECT_EQ(replay.resultOf(2), CellState::HIT);
+    EXPECT_THROW((void)replay.resultOf(3), std::out_of_range);
+  }
+}  // namespace battleship::tests
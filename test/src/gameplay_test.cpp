@@ -82,6 +82,22 @@ namespace battleship::tests
     EXPECT_THROW((void)game.shoot(2, Coordinate{ 0, 0 }), std::logic_error);
   }
 
+  TEST(GamePlayTest, RandomFleetIsPlacedOnPlayerBoard)
+  {
+    GamePlay game{};
+    std::mt19937 rng{ 3 };
+
+    const auto fleet = game.placeRandomFleet(2, rng);
+
+    EXPECT_EQ(fleet.size(), 5U);
+    EXPECT_EQ(game.playerById(2).board().structureCount(), 5U);
+    EXPECT_EQ(game.playerById(1).board().structureCount(), 0U);
+    for (const auto& entry : fleet)
+    {
+      EXPECT_EQ(game.playerById(2).board().getCellView(entry.placement.coordinate).cell_state, CellState::OCCUPIED);
+    }
+  }
+
   TEST(GamePlayTest, UnknownPlayerIdThrows)
   {
     GamePlay game{};
@@ -0,0 +1,564 @@
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "project/core/board.hpp"
+#include "project/core/coordinate.hpp"
+#include "server/game_store.hpp"
+#include "server/http_server.hpp"
+#include "server/route_table.hpp"
+
+// Closed-loop load generator: every simulated pair of players plays whole games over two keep-alive connections,
+// sending its next request only once the previous response is in, so offered load follows server latency.
+namespace server::loadgen
+{
+  namespace
+  {
+    namespace asio = boost::asio;
+    namespace beast = boost::beast;
+    namespace pt = boost::property_tree;
+    using tcp = asio::ip::tcp;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t CELL_COUNT = static_cast<std::size_t>(battleship::BOARD_SIZE) * battleship::BOARD_SIZE;
+
+    struct Options
+    {
+      std::string host{ "127.0.0.1" };
+      std::uint16_t port{ 8080 };
+      unsigned pairs{ 8 };
+      std::chrono::seconds duration{ 10 };
+      unsigned games{ 0 };  // per pair; 0 plays until the duration is up
+      std::chrono::milliseconds think{ 0 };
+      bool embedded{ false };
+    };
+
+    void printUsage(const char* argv0)
+    {
+      std::cerr << "Usage: " << argv0 << " [options]\n"
+                << "  --host ADDR      server address (default 127.0.0.1)\n"
+                << "  --port N         server port (default 8080)\n"
+                << "  --pairs M        simulated player pairs, one thread each (default 8)\n"
+                << "  --duration S     seconds to run (default 10)\n"
+                << "  --games N        stop each pair after N games (default 0: until the duration is up)\n"
+                << "  --think MS       pause before every request, in milliseconds (default 0)\n"
+                << "  --embedded       start an in-process HttpServer on --port and load it\n";
+    }
+
+    template<typename T>
+    bool parseNumber(std::string_view text, T& out)
+    {
+      const auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+      return res.ec == std::errc{} && res.ptr == text.data() + text.size();
+    }
+
+    std::optional<Options> parseOptions(int argc, char** argv)
+    {
+      Options options;
+      for (int i = 1; i < argc; ++i)
+      {
+        const std::string_view flag = argv[i];
+        if (flag == "--embedded")
+        {
+          options.embedded = true;
+          continue;
+        }
+        if (i + 1 >= argc)
+        {
+          std::cerr << "Missing value for " << flag << "\n";
+          return std::nullopt;
+        }
+
+        const std::string_view value = argv[++i];
+        bool ok = true;
+        if (flag == "--host")
+        {
+          options.host = value;
+        }
+        else if (flag == "--port")
+        {
+          ok = parseNumber(value, options.port);
+        }
+        else if (flag == "--pairs")
+        {
+          ok = parseNumber(value, options.pairs) && options.pairs > 0;
+        }
+        else if (flag == "--duration")
+        {
+          unsigned seconds = 0;
+          ok = parseNumber(value, seconds) && seconds > 0;
+          options.duration = std::chrono::seconds{ seconds };
+        }
+        else if (flag == "--games")
+        {
+          ok = parseNumber(value, options.games);
+        }
+        else if (flag == "--think")
+        {
+          unsigned ms = 0;
+          ok = parseNumber(value, ms);
+          options.think = std::chrono::milliseconds{ ms };
+        }
+        else
+        {
+          std::cerr << "Unknown option " << flag << "\n";
+          return std::nullopt;
+        }
+
+        if (!ok)
+        {
+          std::cerr << "Invalid value for " << flag << ": " << value << "\n";
+          return std::nullopt;
+        }
+      }
+      return options;
+    }
+
+    // What one pair observed. Each pair owns its own, so recording never synchronises; they are merged at the end.
+    struct RouteStats
+    {
+      std::vector<std::uint64_t> latencyNs;  // of every answered request
+      std::uint64_t errors{ 0 };             // non-2xx responses
+      std::uint64_t transportErrors{ 0 };    // requests that got no response
+    };
+
+    struct PairStats
+    {
+      std::array<RouteStats, ROUTE_COUNT> routes;
+      std::uint64_t gamesCompleted{ 0 };
+      std::uint64_t gamesAbandoned{ 0 };
+    };
+
+    // One simulated player's keep-alive connection. A transport error drops the connection; the next request
+    // opens a new one.
+    class Client
+    {
+    public:
+      Client(asio::io_context& ioc, const tcp::resolver::results_type& endpoints, PairStats& stats)
+          : m_socket(ioc),
+            m_endpoints(endpoints),
+            m_stats(stats)
+      {
+      }
+
+      void setToken(const std::string& token) { m_authorization = "Bearer " + token; }
+
+      // Sends one request and reads its response. True only for a 2xx response.
+      bool send(http::verb method, const std::string& target, const std::string& body = {})
+      {
+        auto& route = m_stats.routes[static_cast<std::size_t>(match_route(method, target).id)];
+        const auto start = Clock::now();
+
+        beast::error_code ec;
+        if (!m_socket.is_open())
+        {
+          asio::connect(m_socket, m_endpoints, ec);
+          if (ec)
+          {
+            beast::error_code ignored;
+            m_socket.close(ignored);
+            ++route.transportErrors;
+            return false;
+          }
+        }
+
+        http::request<http::string_body> req{ method, target, 11 };
+        req.set(http::field::host, "localhost");
+        if (!m_authorization.empty())
+        {
+          req.set(http::field::authorization, m_authorization);
+        }
+        if (!body.empty())
+        {
+          req.set(http::field::content_type, "application/json");
+        }
+        req.keep_alive(true);
+        req.body() = body;
+        req.prepare_payload();
+
+        m_res = {};
+        http::write(m_socket, req, ec);
+        if (!ec)
+        {
+          http::read(m_socket, m_buffer, m_res, ec);
+        }
+        if (ec)
+        {
+          beast::error_code ignored;
+          m_socket.close(ignored);
+          m_buffer.clear();
+          ++route.transportErrors;
+          return false;
+        }
+
+        route.latencyNs.push_back(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+        if (!m_res.keep_alive())
+        {
+          m_socket.close(ec);
+        }
+        if (http::to_status_class(m_res.result()) != http::status_class::successful)
+        {
+          ++route.errors;
+          return false;
+        }
+        return true;
+      }
+
+      const std::string& body() const noexcept { return m_res.body(); }
+
+    private:
+      tcp::socket m_socket;
+      const tcp::resolver::results_type& m_endpoints;
+      PairStats& m_stats;
+      beast::flat_buffer m_buffer;
+      http::response<http::string_body> m_res;
+      std::string m_authorization;
+    };
+
+    std::optional<pt::ptree> parseJson(const std::string& body)
+    {
+      try
+      {
+        std::istringstream in{ body };
+        pt::ptree tree;
+        pt::read_json(in, tree);
+        return tree;
+      }
+      catch (const pt::json_parser_error&)
+      {
+        return std::nullopt;
+      }
+    }
+
+    class Pair
+    {
+    public:
+      Pair(const Options& options, const tcp::resolver::results_type& endpoints, unsigned seed)
+          : m_options(options),
+            m_players{ Client{ m_ioc, endpoints, m_stats }, Client{ m_ioc, endpoints, m_stats } },
+            m_rng(seed)
+      {
+      }
+
+      void run(Clock::time_point deadline)
+      {
+        while (Clock::now() < deadline && (m_options.games == 0 || m_stats.gamesCompleted < m_options.games))
+        {
+          if (playGame(deadline))
+          {
+            ++m_stats.gamesCompleted;
+          }
+          else
+          {
+            ++m_stats.gamesAbandoned;
+            // Back off so that a refusing or failing server is not spun against.
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+          }
+        }
+      }
+
+      const PairStats& stats() const noexcept { return m_stats; }
+
+    private:
+      void think() const
+      {
+        if (m_options.think.count() > 0)
+        {
+          std::this_thread::sleep_for(m_options.think);
+        }
+      }
+
+      bool send(int player, http::verb method, const std::string& target, const std::string& body = {})
+      {
+        think();
+        return m_players[static_cast<std::size_t>(player)].send(method, target, body);
+      }
+
+      // Create, join, random fleets, ready, then alternate shots (each answered by a poll from the other
+      // player) until someone wins. False if anything failed or the deadline passed first.
+      bool playGame(Clock::time_point deadline)
+      {
+        if (!send(0, http::verb::post, "/games"))
+        {
+          return false;
+        }
+        const auto created = parseJson(m_players[0].body());
+        if (!created.has_value())
+        {
+          return false;
+        }
+        const std::string gameId = created->get<std::string>("gameId", "");
+        m_players[0].setToken(created->get<std::string>("playerToken", ""));
+        const std::string path = "/games/" + gameId;
+
+        if (!send(1, http::verb::post, path + "/join"))
+        {
+          return false;
+        }
+        const auto joined = parseJson(m_players[1].body());
+        if (!joined.has_value())
+        {
+          return false;
+        }
+        m_players[1].setToken(joined->get<std::string>("playerToken", ""));
+
+        for (int p = 0; p < 2; ++p)
+        {
+          if (!send(p, http::verb::post, path + "/fleet/random") || !send(p, http::verb::post, path + "/ready"))
+          {
+            return false;
+          }
+        }
+
+        std::array<std::vector<std::size_t>, 2> targets;
+        for (auto& order : targets)
+        {
+          order.resize(CELL_COUNT);
+          std::iota(order.begin(), order.end(), std::size_t{ 0 });
+          std::shuffle(order.begin(), order.end(), m_rng);
+        }
+
+        for (std::size_t shot = 0; shot < 2 * CELL_COUNT; ++shot)
+        {
+          if (Clock::now() >= deadline)
+          {
+            return false;
+          }
+
+          const int shooter = static_cast<int>(shot % 2);
+          const auto cell = static_cast<int>(targets[static_cast<std::size_t>(shooter)][shot / 2]);
+          const auto target = battleship::Coordinate{ cell / battleship::BOARD_SIZE, cell % battleship::BOARD_SIZE };
+          if (!send(shooter, http::verb::post, path + "/shoot", R"({"target":")" + target.toString() + R"("})"))
+          {
+            return false;
+          }
+          if (m_players[static_cast<std::size_t>(shooter)].body().find("\"finished\"") != std::string::npos)
+          {
+            return true;
+          }
+          if (!send(1 - shooter, http::verb::get, path))
+          {
+            return false;
+          }
+        }
+        return false;
+      }
+
+    private:
+      const Options& m_options;
+      asio::io_context m_ioc;
+      PairStats m_stats;
+      std::array<Client, 2> m_players;
+      std::mt19937 m_rng;
+    };
+
+    double micros(std::uint64_t ns)
+    {
+      return static_cast<double>(ns) / 1000.0;
+    }
+
+    // Nearest-rank percentile of sorted samples.
+    std::uint64_t percentile(const std::vector<std::uint64_t>& sorted, double q)
+    {
+      if (sorted.empty())
+      {
+        return 0;
+      }
+      const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+      return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    void printReport(const std::vector<PairStats>& pairs, std::chrono::nanoseconds elapsed)
+    {
+      const double seconds = std::chrono::duration<double>(elapsed).count();
+      std::uint64_t completed = 0;
+      std::uint64_t abandoned = 0;
+      std::uint64_t requests = 0;
+      std::uint64_t errors = 0;
+
+      std::printf("%-20s %10s %10s %8s %10s %10s %10s %10s\n",
+                  "route", "requests", "req/s", "err%", "p50 us", "p99 us", "p99.9 us", "max us");
+      for (std::size_t r = 0; r < ROUTE_COUNT; ++r)
+      {
+        std::vector<std::uint64_t> latencies;
+        std::uint64_t routeErrors = 0;
+        std::uint64_t unanswered = 0;
+        for (const auto& pair : pairs)
+        {
+          const auto& route = pair.routes[r];
+          latencies.insert(latencies.end(), route.latencyNs.begin(), route.latencyNs.end());
+          routeErrors += route.errors;
+          unanswered += route.transportErrors;
+        }
+        if (latencies.empty() && unanswered == 0)
+        {
+          continue;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        // Latencies cover answered requests only; one that got no response still counts as sent and failed.
+        const std::uint64_t attempts = latencies.size() + unanswered;
+        routeErrors += unanswered;
+        requests += attempts;
+        errors += routeErrors;
+        std::printf("%-20s %10llu %10.0f %7.2f%% %10.1f %10.1f %10.1f %10.1f\n",
+                    to_cstr(static_cast<RouteId>(r)),
+                    static_cast<unsigned long long>(attempts),
+                    static_cast<double>(attempts) / seconds,
+                    100.0 * static_cast<double>(routeErrors) / static_cast<double>(attempts),
+                    micros(percentile(latencies, 0.50)),
+                    micros(percentile(latencies, 0.99)),
+                    micros(percentile(latencies, 0.999)),
+                    micros(latencies.empty() ? 0 : latencies.back()));
+      }
+
+      for (const auto& pair : pairs)
+      {
+        completed += pair.gamesCompleted;
+        abandoned += pair.gamesAbandoned;
+      }
+      std::printf("\n%.2f s, %llu requests (%.0f req/s), %llu errors, %llu games completed (%.1f games/s), %llu abandoned\n",
+                  seconds,
+                  static_cast<unsigned long long>(requests),
+                  static_cast<double>(requests) / seconds,
+                  static_cast<unsigned long long>(errors),
+                  static_cast<unsigned long long>(completed),
+                  static_cast<double>(completed) / seconds,
+                  static_cast<unsigned long long>(abandoned));
+    }
+
+    // The --embedded server, stopped and drained on every way out of run().
+    class EmbeddedServer
+    {
+    public:
+      EmbeddedServer(GameStore& store, std::uint16_t port) : m_server(store, ServerConfig{ .port = port })
+      {
+        m_server.start();
+      }
+
+      ~EmbeddedServer()
+      {
+        m_server.stop();
+        m_server.wait();
+      }
+
+      EmbeddedServer(const EmbeddedServer&) = delete;
+      EmbeddedServer& operator=(const EmbeddedServer&) = delete;
+
+    private:
+      HttpServer m_server;
+    };
+  }  // namespace
+
+  int run(int argc, char** argv)
+  {
+    const auto options = parseOptions(argc, argv);
+    if (!options.has_value())
+    {
+      printUsage(argv[0]);
+      return 2;
+    }
+
+    GameStore store;
+    std::optional<EmbeddedServer> server;
+    if (options->embedded)
+    {
+      try
+      {
+        server.emplace(store, options->port);
+      }
+      catch (const std::exception& e)
+      {
+        std::cerr << "Cannot start the embedded server: " << e.what() << "\n";
+        return 1;
+      }
+    }
+
+    asio::io_context ioc;
+    tcp::resolver resolver{ ioc };
+    beast::error_code ec;
+    const auto endpoints = resolver.resolve(options->host, std::to_string(options->port), ec);
+    if (ec)
+    {
+      std::cerr << "Cannot resolve " << options->host << ": " << ec.message() << "\n";
+      return 1;
+    }
+
+    // Wait for the server to accept connections, so start-up is not reported as errors.
+    for (int attempt = 0;; ++attempt)
+    {
+      tcp::socket probe{ ioc };
+      asio::connect(probe, endpoints, ec);
+      if (!ec)
+      {
+        break;
+      }
+      if (attempt == 50)
+      {
+        std::cerr << "Cannot connect to " << options->host << ":" << options->port << ": " << ec.message() << "\n";
+        return 1;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+    }
+
+    std::vector<std::unique_ptr<Pair>> pairs;
+    for (unsigned i = 0; i < options->pairs; ++i)
+    {
+      pairs.push_back(std::make_unique<Pair>(*options, endpoints, i + 1));
+    }
+
+    const auto start = Clock::now();
+    const auto deadline = start + options->duration;
+    std::vector<std::thread> threads;
+    for (auto& pair : pairs)
+    {
+      threads.emplace_back([&pair, deadline] { pair->run(deadline); });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    const auto elapsed = Clock::now() - start;
+
+    std::vector<PairStats> stats;
+    for (const auto& pair : pairs)
+    {
+      stats.push_back(pair->stats());
+    }
+    printReport(stats, elapsed);
+
+    const bool anyCompleted =
+        std::any_of(stats.begin(), stats.end(), [](const PairStats& s) { return s.gamesCompleted > 0; });
+    return anyCompleted ? 0 : 1;
+  }
+
+}  // namespace server::loadgen
+
+int main(int argc, char** argv)
+{
+  return server::loadgen::run(argc, argv);
+}
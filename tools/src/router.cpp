@@ -0,0 +1,47 @@
+#include <exception>
+#include <iostream>
+#include <string_view>
+
+#include "server/cluster_proxy.hpp"
+#include "server/server_config.hpp"
+
+// Front router of a multi-process deployment: forwards each request to the battleship_server node that owns its
+// game until SIGTERM or SIGINT, then drains open requests and exits. Takes battleship_server's options; the
+// listening, drain and --cluster ones apply.
+int main(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::string_view{ argv[i] } == "--help" || std::string_view{ argv[i] } == "-h")
+    {
+      std::cout << server::serverUsage(argv[0]);
+      return 0;
+    }
+  }
+
+  const auto config = server::parseServerConfig(argc, argv);
+  if (!config)
+  {
+    std::cerr << config.error() << "\n" << server::serverUsage(argv[0]);
+    return 2;
+  }
+  if (config->clusterNodes.empty())
+  {
+    std::cerr << "--cluster is required\n" << server::serverUsage(argv[0]);
+    return 2;
+  }
+
+  try
+  {
+    server::ClusterProxy proxy{ *config };
+    proxy.run();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "battleship_router: " << e.what() << "\n";
+    return 1;
+  }
+
+  std::cout << "Drained, exiting\n";
+  return 0;
+}
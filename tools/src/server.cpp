@@ -0,0 +1,103 @@
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include "server/event_log.hpp"
+#include "server/game_recorder.hpp"
+#include "server/game_store.hpp"
+#include "server/http_server.hpp"
+#include "server/matchmaker.hpp"
+#include "server/server_config.hpp"
+#include "server/snapshot.hpp"
+#include "server/spectator_hub.hpp"
+#include "server/uring_server.hpp"
+
+// Runs the game server until SIGTERM or SIGINT, then drains open requests and exits.
+int main(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::string_view{ argv[i] } == "--help" || std::string_view{ argv[i] } == "-h")
+    {
+      std::cout << server::serverUsage(argv[0]);
+      return 0;
+    }
+  }
+
+  const auto config = server::parseServerConfig(argc, argv);
+  if (!config)
+  {
+    std::cerr << config.error() << "\n" << server::serverUsage(argv[0]);
+    return 2;
+  }
+
+  try
+  {
+    server::GameStore store{ server::gameShardCount(*config), server::gameIdPrefix(*config) };
+    if (!config->recordDir.empty())
+    {
+      store.attachRecorder(
+          std::make_shared<server::GameRecorder>(server::RecorderOptions{ .directory = config->recordDir }));
+    }
+
+    // Restore before anything can change a game: the snapshot first, then the events logged after it, and only
+    // then the periodic snapshots that rotate the log.
+    if (!config->snapshotPath.empty() && store.loadSnapshot(config->snapshotPath))
+    {
+      std::cout << "Restored the games in " << config->snapshotPath << "\n";
+    }
+    std::shared_ptr<server::EventLog> log;
+    if (!config->walPath.empty())
+    {
+      log = std::make_shared<server::EventLog>(
+          server::EventLogOptions{ .path = config->walPath, .commitInterval = config->commitInterval });
+      std::cout << "Replayed " << store.attachEventLog(log) << " events from " << config->walPath << "\n";
+    }
+    std::unique_ptr<server::Snapshotter> snapshotter;
+    if (!config->snapshotPath.empty())
+    {
+      snapshotter = std::make_unique<server::Snapshotter>(
+          store, log, server::SnapshotOptions{ .path = config->snapshotPath, .interval = config->snapshotInterval });
+    }
+
+    if (config->matchTickets != 0)
+    {
+      store.attachMatchmaker(std::make_shared<server::Matchmaker>(store, config->matchTickets, config->matchTimeout));
+    }
+    if (config->spectators != server::SpectatorPolicy::Off)
+    {
+      store.attachSpectators(std::make_shared<server::SpectatorHub>(config->spectators));
+    }
+    if (config->ioUring && server::UringServer::supported())
+    {
+      if (config->gameActors)
+      {
+        std::cerr << "--game-actors applies to the Asio backend; io_uring threads serve every shard\n";
+      }
+      if (config->spectators != server::SpectatorPolicy::Off)
+      {
+        std::cerr << "spectator streams need the Asio backend; io_uring answers each spectate request with one frame\n";
+      }
+      server::UringServer uringServer{ store, *config };
+      uringServer.run();
+    }
+    else
+    {
+      if (config->ioUring)
+      {
+        std::cerr << "io_uring is not available in this build or kernel; serving with the Asio backend\n";
+      }
+      server::HttpServer httpServer{ store, *config };
+      httpServer.run();
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "battleship_server: " << e.what() << "\n";
+    return 1;
+  }
+
+  std::cout << "Drained, exiting\n";
+  return 0;
+}